@@ -0,0 +1,167 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <ArchiveProxy.h>
+
+#include "BenchmarkUtil.h"
+
+using namespace aeron::archive;
+
+namespace codecs = io::aeron::archive::codecs;
+
+namespace {
+
+const std::string CHANNEL = "aeron:udp?endpoint=localhost:40123|term-length=65536";
+const std::string RESPONSE_CHANNEL = "aeron:udp?endpoint=localhost:8020";
+const std::int32_t STREAM_ID = 1001;
+const std::int64_t CONTROL_SESSION_ID = 42;
+
+// requests are offered to a real IPC publication, drained every DRAIN_INTERVAL requests so it never back pressures
+const std::string REQUEST_CHANNEL = "aeron:ipc?term-length=16m";
+const std::int32_t REQUEST_STREAM_ID = 1002;
+const std::int32_t DRAIN_INTERVAL = 256;
+
+template <typename F>
+void runEncode(benchmark::State& state, F&& encode) {
+    const IpcStream stream = addIpcStream(*connectAeron(), REQUEST_CHANNEL, REQUEST_STREAM_ID);
+
+    ArchiveProxy proxy(stream.publication, 1000000000, 3);
+    aeron::fragment_handler_t drain = [](aeron::concurrent::AtomicBuffer& buffer, aeron::util::index_t offset,
+                                         aeron::util::index_t length, aeron::Header& header) {};
+    std::int64_t correlationId = 0;
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(encode(proxy, ++correlationId));
+
+        if (correlationId % DRAIN_INTERVAL == 0) {
+            stream.subscription->poll(drain, DRAIN_INTERVAL);
+        }
+    }
+    allocations.report(state);
+}
+
+void connect(benchmark::State& state) {
+    runEncode(state, [](ArchiveProxy& proxy, std::int64_t correlationId) {
+        return proxy.connect(RESPONSE_CHANNEL, STREAM_ID, correlationId);
+    });
+}
+
+void closeSession(benchmark::State& state) {
+    runEncode(state, [](ArchiveProxy& proxy, std::int64_t correlationId) {
+        return proxy.closeSession(CONTROL_SESSION_ID);
+    });
+}
+
+void startRecording(benchmark::State& state) {
+    runEncode(state, [](ArchiveProxy& proxy, std::int64_t correlationId) {
+        return proxy.startRecording(CHANNEL, STREAM_ID, codecs::SourceLocation::LOCAL, correlationId,
+                                    CONTROL_SESSION_ID);
+    });
+}
+
+void stopRecording(benchmark::State& state) {
+    runEncode(state, [](ArchiveProxy& proxy, std::int64_t correlationId) {
+        return proxy.stopRecording(CHANNEL, STREAM_ID, correlationId, CONTROL_SESSION_ID);
+    });
+}
+
+void stopRecordingSubscription(benchmark::State& state) {
+    runEncode(state, [](ArchiveProxy& proxy, std::int64_t correlationId) {
+        return proxy.stopRecording(7, correlationId, CONTROL_SESSION_ID);
+    });
+}
+
+void replay(benchmark::State& state) {
+    runEncode(state, [](ArchiveProxy& proxy, std::int64_t correlationId) {
+        return proxy.replay(7, 0, 1 << 20, CHANNEL, STREAM_ID, correlationId, CONTROL_SESSION_ID);
+    });
+}
+
+void stopReplay(benchmark::State& state) {
+    runEncode(state, [](ArchiveProxy& proxy, std::int64_t correlationId) {
+        return proxy.stopReplay(7, correlationId, CONTROL_SESSION_ID);
+    });
+}
+
+void listRecordings(benchmark::State& state) {
+    runEncode(state, [](ArchiveProxy& proxy, std::int64_t correlationId) {
+        return proxy.listRecordings(0, 100, correlationId, CONTROL_SESSION_ID);
+    });
+}
+
+void listRecordingsForUri(benchmark::State& state) {
+    runEncode(state, [](ArchiveProxy& proxy, std::int64_t correlationId) {
+        return proxy.listRecordingsForUri(0, 100, "localhost:40123", STREAM_ID, correlationId, CONTROL_SESSION_ID);
+    });
+}
+
+void listRecording(benchmark::State& state) {
+    runEncode(state, [](ArchiveProxy& proxy, std::int64_t correlationId) {
+        return proxy.listRecording(7, correlationId, CONTROL_SESSION_ID);
+    });
+}
+
+void extendRecording(benchmark::State& state) {
+    runEncode(state, [](ArchiveProxy& proxy, std::int64_t correlationId) {
+        return proxy.extendRecording(CHANNEL, STREAM_ID, codecs::SourceLocation::LOCAL, 7, correlationId,
+                                     CONTROL_SESSION_ID);
+    });
+}
+
+void getRecordingPosition(benchmark::State& state) {
+    runEncode(state, [](ArchiveProxy& proxy, std::int64_t correlationId) {
+        return proxy.getRecordingPosition(7, correlationId, CONTROL_SESSION_ID);
+    });
+}
+
+void truncateRecording(benchmark::State& state) {
+    runEncode(state, [](ArchiveProxy& proxy, std::int64_t correlationId) {
+        return proxy.truncateRecording(7, 1024, correlationId, CONTROL_SESSION_ID);
+    });
+}
+
+void getStopPosition(benchmark::State& state) {
+    runEncode(state, [](ArchiveProxy& proxy, std::int64_t correlationId) {
+        return proxy.getStopPosition(7, correlationId, CONTROL_SESSION_ID);
+    });
+}
+
+void findLastMatchingRecording(benchmark::State& state) {
+    runEncode(state, [](ArchiveProxy& proxy, std::int64_t correlationId) {
+        return proxy.findLastMatchingRecording(0, "localhost:40123", STREAM_ID, 5, correlationId, CONTROL_SESSION_ID);
+    });
+}
+
+}  // namespace
+
+BENCHMARK(connect);
+BENCHMARK(closeSession);
+BENCHMARK(startRecording);
+BENCHMARK(stopRecording);
+BENCHMARK(stopRecordingSubscription);
+BENCHMARK(replay);
+BENCHMARK(stopReplay);
+BENCHMARK(listRecordings);
+BENCHMARK(listRecordingsForUri);
+BENCHMARK(listRecording);
+BENCHMARK(extendRecording);
+BENCHMARK(getRecordingPosition);
+BENCHMARK(truncateRecording);
+BENCHMARK(getStopPosition);
+BENCHMARK(findLastMatchingRecording);
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+#include "BenchmarkUtil.h"
+
+namespace {
+
+std::atomic<std::int64_t> allocations{0};
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t size) noexcept { std::free(ptr); }
+
+namespace aeron {
+namespace archive {
+
+std::int64_t allocationCount() { return allocations.load(std::memory_order_relaxed); }
+
+AllocationCounter::AllocationCounter() : start_(allocationCount()) {}
+
+void AllocationCounter::report(benchmark::State& state) const {
+    state.counters["allocs/op"] =
+        benchmark::Counter(static_cast<double>(allocationCount() - start_), benchmark::Counter::kAvgIterations);
+}
+
+std::shared_ptr<aeron::Aeron> connectAeron() {
+    static aeron::Context context;
+    static std::shared_ptr<aeron::Aeron> aeron = aeron::Aeron::connect(context);
+    return aeron;
+}
+
+IpcStream addIpcStream(aeron::Aeron& aeron, const std::string& channel, std::int32_t streamId) {
+    IpcStream stream;
+
+    std::int64_t subId = aeron.addSubscription(channel, streamId);
+    while (!(stream.subscription = aeron.findSubscription(subId))) {
+        std::this_thread::yield();
+    }
+
+    std::int64_t pubId = aeron.addExclusivePublication(channel, streamId);
+    while (!(stream.publication = aeron.findExclusivePublication(pubId))) {
+        std::this_thread::yield();
+    }
+
+    while (!stream.publication->isConnected()) {
+        std::this_thread::yield();
+    }
+
+    return stream;
+}
+
+}  // namespace archive
+}  // namespace aeron
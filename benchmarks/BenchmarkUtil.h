@@ -0,0 +1,56 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <memory>
+#include <string>
+
+#include <Aeron.h>
+#include <benchmark/benchmark.h>
+
+namespace aeron {
+namespace archive {
+
+// number of heap allocations made by this process so far, counted by the replaced global operator new
+std::int64_t allocationCount();
+
+// reports the heap allocations made inside a benchmark loop as allocs/op
+class AllocationCounter {
+public:
+    AllocationCounter();
+
+    void report(benchmark::State& state) const;
+
+private:
+    const std::int64_t start_;
+};
+
+// one Aeron client per process, the benchmarks using it need a running media driver
+std::shared_ptr<aeron::Aeron> connectAeron();
+
+// an exclusive publication and a subscription of the same IPC stream, connected to each other
+struct IpcStream {
+    std::shared_ptr<aeron::ExclusivePublication> publication;
+    std::shared_ptr<aeron::Subscription> subscription;
+};
+
+IpcStream addIpcStream(aeron::Aeron& aeron, const std::string& channel, std::int32_t streamId);
+
+}  // namespace archive
+}  // namespace aeron
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <ChannelUri.h>
+
+#include "BenchmarkUtil.h"
+
+using namespace aeron::archive;
+
+namespace {
+
+const std::string CHANNELS[] = {
+    "aeron:ipc",
+    "aeron:udp?endpoint=localhost:40123",
+    "aeron:udp?endpoint=224.0.1.1:40456|interface=192.168.1.0/24|ttl=16|term-length=65536|mtu=1408",
+    "aeron-spy:aeron:udp?control=localhost:40456|control-mode=dynamic|session-id=1234",
+};
+
+void parse(benchmark::State& state) {
+    const std::string& channel = CHANNELS[state.range(0)];
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ChannelUri::parse(channel));
+    }
+    allocations.report(state);
+}
+
+void toString(benchmark::State& state) {
+    const ChannelUri uri = ChannelUri::parse(CHANNELS[state.range(0)]);
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(uri.toString());
+    }
+    allocations.report(state);
+}
+
+void addSessionId(benchmark::State& state) {
+    const std::string& channel = CHANNELS[state.range(0)];
+    std::int32_t sessionId = 0;
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ChannelUri::addSessionId(channel, ++sessionId));
+    }
+    allocations.report(state);
+}
+
+}  // namespace
+
+BENCHMARK(parse)->ArgName("channel")->DenseRange(0, 3);
+BENCHMARK(toString)->ArgName("channel")->DenseRange(0, 3);
+BENCHMARK(addSessionId)->ArgName("channel")->Arg(1)->Arg(2);
@@ -0,0 +1,206 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <limits>
+
+#include <benchmark/benchmark.h>
+
+#include <ControlResponseDispatcher.h>
+#include <ControlResponsePoller.h>
+#include <RecordingDescriptorPoller.h>
+#include <RecordingEventsAdapter.h>
+
+#include "io_aeron_archive_codecs/ControlResponse.h"
+#include "io_aeron_archive_codecs/RecordingDescriptor.h"
+#include "io_aeron_archive_codecs/RecordingProgress.h"
+#include "io_aeron_archive_codecs/RecordingStarted.h"
+#include "io_aeron_archive_codecs/RecordingStopped.h"
+
+#include "BenchmarkUtil.h"
+#include "ControlMessageEncoder.h"
+
+using namespace aeron::archive;
+
+namespace codecs = io::aeron::archive::codecs;
+
+namespace {
+
+const std::string CHANNEL = "aeron:udp?endpoint=localhost:40123|term-length=65536";
+const std::int64_t CONTROL_SESSION_ID = 42;
+const std::int64_t CORRELATION_ID = 7;
+
+// the pollers read every message back from a real IPC stream through their public poll(), so these benchmarks
+// need a running media driver and include the offer
+const std::string IPC_CHANNEL = "aeron:ipc?term-length=64k";
+const std::int32_t IPC_STREAM_ID = 1003;
+
+void offer(aeron::ExclusivePublication& publication, ControlMessageEncoder& message) {
+    while (publication.offer(message.buffer(), 0, message.length()) < 0) {
+    }
+}
+
+// polls until the message offered last has been read
+template <typename Poller>
+void pollMessage(Poller& poller) {
+    while (poller.poll() == 0) {
+    }
+}
+
+void controlResponse(benchmark::State& state) {
+    const bool isError = state.range(0) != 0;
+
+    ControlMessageEncoder message;
+    codecs::ControlResponse msg;
+    message.wrap(msg)
+        .controlSessionId(CONTROL_SESSION_ID)
+        .correlationId(CORRELATION_ID)
+        .relevantId(3)
+        .code(isError ? codecs::ControlResponseCode::ERROR : codecs::ControlResponseCode::OK)
+        .putErrorMessage(isError ? "unknown recording id: 3, the recording may have been purged" : "");
+    message.complete(msg);
+
+    const IpcStream stream = addIpcStream(*connectAeron(), IPC_CHANNEL, IPC_STREAM_ID);
+    ControlResponsePoller poller(stream.subscription, 10);
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        offer(*stream.publication, message);
+        pollMessage(poller);
+        benchmark::DoNotOptimize(poller.correlationId());
+    }
+    allocations.report(state);
+}
+
+// a call registered, completed by its response and taken, as AeronArchive does for every request
+void dispatchResponse(benchmark::State& state) {
+    ControlMessageEncoder message;
+    message.encodeResponse(CONTROL_SESSION_ID, CORRELATION_ID, 3, codecs::ControlResponseCode::OK);
+
+    ControlResponseDispatcher dispatcher(nullptr, 10);
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        dispatcher.expectResponse(CONTROL_SESSION_ID, CORRELATION_ID);
+        dispatcher.onFragment(message.buffer(), 0, message.length(), message.header());
+        benchmark::DoNotOptimize(dispatcher.take(CORRELATION_ID).relevantId);
+    }
+    allocations.report(state);
+}
+
+void recordingDescriptor(benchmark::State& state) {
+    ControlMessageEncoder message;
+    codecs::RecordingDescriptor msg;
+    message.wrap(msg)
+        .controlSessionId(CONTROL_SESSION_ID)
+        .correlationId(CORRELATION_ID)
+        .recordingId(3)
+        .startTimestamp(1)
+        .stopTimestamp(2)
+        .startPosition(0)
+        .stopPosition(1 << 20)
+        .initialTermId(5)
+        .segmentFileLength(128 * 1024 * 1024)
+        .termBufferLength(ControlMessageEncoder::TERM_LENGTH)
+        .mtuLength(1408)
+        .sessionId(11)
+        .streamId(1001)
+        .putStrippedChannel("aeron:udp?endpoint=localhost:40123")
+        .putOriginalChannel(CHANNEL)
+        .putSourceIdentity("127.0.0.1:51234");
+    message.complete(msg);
+
+    const IpcStream stream = addIpcStream(*connectAeron(), IPC_CHANNEL, IPC_STREAM_ID);
+    RecordingDescriptorPoller poller(stream.subscription, 10, CONTROL_SESSION_ID);
+    std::int64_t recordings = 0;
+    poller.reset(CORRELATION_ID, std::numeric_limits<std::int32_t>::max(),
+                 [&](std::int64_t controlSessionId, std::int64_t correlationId, std::int64_t recordingId,
+                     std::int64_t startTimestamp, std::int64_t stopTimestamp, std::int64_t startPosition,
+                     std::int64_t stopPosition, std::int32_t initialTermId, std::int32_t segmentFileLength,
+                     std::int32_t termBufferLength, std::int32_t mtuLength, std::int32_t sessionId,
+                     std::int32_t streamId, const std::string& strippedChannel, const std::string& originalChannel,
+                     const std::string& sourceIdentity) { ++recordings; });
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        offer(*stream.publication, message);
+        pollMessage(poller);
+    }
+    allocations.report(state);
+
+    benchmark::DoNotOptimize(recordings);
+}
+
+void recordingEvent(benchmark::State& state, ControlMessageEncoder& message) {
+    std::int64_t events = 0;
+    const IpcStream stream = addIpcStream(*connectAeron(), IPC_CHANNEL, IPC_STREAM_ID);
+    RecordingEventsAdapter adapter(
+        stream.subscription, 10,
+        [&](std::int64_t recordingId, std::int64_t startPosition, std::int32_t sessionId, std::int32_t streamId,
+            const std::string& channel, const std::string& sourceIdentity) { ++events; },
+        [&](std::int64_t recordingId, std::int64_t startPosition, std::int64_t position) { ++events; },
+        [&](std::int64_t recordingId, std::int64_t startPosition, std::int64_t position) { ++events; });
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        offer(*stream.publication, message);
+        pollMessage(adapter);
+    }
+    allocations.report(state);
+
+    benchmark::DoNotOptimize(events);
+}
+
+void recordingStarted(benchmark::State& state) {
+    ControlMessageEncoder message;
+    codecs::RecordingStarted msg;
+    message.wrap(msg)
+        .recordingId(3)
+        .startPosition(0)
+        .sessionId(11)
+        .streamId(1001)
+        .putChannel(CHANNEL)
+        .putSourceIdentity("127.0.0.1:51234");
+    message.complete(msg);
+
+    recordingEvent(state, message);
+}
+
+void recordingProgress(benchmark::State& state) {
+    ControlMessageEncoder message;
+    codecs::RecordingProgress msg;
+    message.wrap(msg).recordingId(3).startPosition(0).position(1 << 20);
+    message.complete(msg);
+
+    recordingEvent(state, message);
+}
+
+void recordingStopped(benchmark::State& state) {
+    ControlMessageEncoder message;
+    codecs::RecordingStopped msg;
+    message.wrap(msg).recordingId(3).startPosition(0).stopPosition(1 << 20);
+    message.complete(msg);
+
+    recordingEvent(state, message);
+}
+
+}  // namespace
+
+BENCHMARK(controlResponse)->ArgName("error")->Arg(0)->Arg(1);
+BENCHMARK(dispatchResponse);
+BENCHMARK(recordingDescriptor);
+BENCHMARK(recordingStarted);
+BENCHMARK(recordingProgress);
+BENCHMARK(recordingStopped);
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <RecordingPos.h>
+
+#include "BenchmarkUtil.h"
+
+using namespace aeron::archive;
+
+namespace {
+
+const std::int32_t COUNTER_COUNT = 10000;
+const std::int32_t TYPE_ID_OFFSET = sizeof(std::int32_t);
+const std::int32_t RECORDING_POSITION_TYPE_ID = 100;
+const std::int32_t SESSION_ID_OFFSET = sizeof(std::int64_t);
+const std::int32_t FIRST_SESSION_ID = 1000;
+
+// a counters file holding only recording positions, recording i is held by counter i
+class RecordingCounters {
+public:
+    RecordingCounters()
+        : metadata_(COUNTER_COUNT * aeron::concurrent::CountersReader::METADATA_LENGTH)
+        , values_(COUNTER_COUNT * aeron::concurrent::CountersReader::COUNTER_LENGTH)
+        , metadataBuffer_(&metadata_[0], metadata_.size())
+        , valuesBuffer_(&values_[0], values_.size())
+        , reader_(metadataBuffer_, valuesBuffer_) {
+        for (std::int32_t i = 0; i < COUNTER_COUNT; ++i) {
+            const std::int32_t recordOffset = aeron::concurrent::CountersReader::metadataOffset(i);
+            const std::int32_t keyOffset = recordOffset + aeron::concurrent::CountersReader::KEY_OFFSET;
+
+            metadataBuffer_.putInt32(recordOffset + TYPE_ID_OFFSET, RECORDING_POSITION_TYPE_ID);
+            metadataBuffer_.putInt64(keyOffset, i);
+            metadataBuffer_.putInt32(keyOffset + SESSION_ID_OFFSET, FIRST_SESSION_ID + i);
+            metadataBuffer_.putInt32Ordered(recordOffset, aeron::concurrent::CountersReader::RECORD_ALLOCATED);
+        }
+    }
+
+    aeron::concurrent::CountersReader& reader() { return reader_; }
+
+private:
+    std::vector<std::uint8_t> metadata_;
+    std::vector<std::uint8_t> values_;
+    aeron::concurrent::AtomicBuffer metadataBuffer_;
+    aeron::concurrent::AtomicBuffer valuesBuffer_;
+    aeron::concurrent::CountersReader reader_;
+};
+
+RecordingCounters& counters() {
+    static RecordingCounters counters;
+    return counters;
+}
+
+void findCounterIdByRecording(benchmark::State& state) {
+    auto& reader = counters().reader();
+    const std::int64_t recordingId = state.range(0);
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(RecordingPos::findCounterIdByRecording(reader, recordingId));
+    }
+    allocations.report(state);
+}
+
+void findCounterIdBySession(benchmark::State& state) {
+    auto& reader = counters().reader();
+    const std::int32_t sessionId = FIRST_SESSION_ID + static_cast<std::int32_t>(state.range(0));
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(RecordingPos::findCounterIdBySession(reader, sessionId));
+    }
+    allocations.report(state);
+}
+
+void isActive(benchmark::State& state) {
+    auto& reader = counters().reader();
+    const std::int32_t counterId = COUNTER_COUNT / 2;
+
+    AllocationCounter allocations;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(RecordingPos::isActive(reader, counterId, counterId));
+    }
+    allocations.report(state);
+}
+
+}  // namespace
+
+// first, middle and last counter, then a recording which is not found after a full scan
+BENCHMARK(findCounterIdByRecording)
+    ->ArgName("recordingId")
+    ->Arg(0)
+    ->Arg(COUNTER_COUNT / 2)
+    ->Arg(COUNTER_COUNT - 1)
+    ->Arg(COUNTER_COUNT);
+BENCHMARK(findCounterIdBySession)
+    ->ArgName("session")
+    ->Arg(0)
+    ->Arg(COUNTER_COUNT / 2)
+    ->Arg(COUNTER_COUNT - 1)
+    ->Arg(COUNTER_COUNT);
+BENCHMARK(isActive);
@@ -0,0 +1,53 @@
+#
+# Copyright 2018-2019 Fairtide Pte. Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# install google benchmark
+set(BENCHMARK_VERSION "v1.5.0" CACHE STRING "google benchmark version")
+set(BENCHMARK_PREFIX ${THIRDPARTY_BINARY_DIR}/googlebenchmark)
+
+ExternalProject_Add(googlebenchmark_project
+    GIT_REPOSITORY https://github.com/google/benchmark
+    GIT_TAG ${BENCHMARK_VERSION}
+    GIT_SHALLOW TRUE
+    GIT_PROGRESS TRUE
+    PREFIX "${BENCHMARK_PREFIX}"
+    CMAKE_ARGS
+        -DCMAKE_BUILD_TYPE=Release
+        -DCMAKE_C_COMPILER=${CMAKE_C_COMPILER}
+        -DCMAKE_CXX_COMPILER=${CMAKE_CXX_COMPILER}
+        -DCMAKE_MAKE_PROGRAM=${CMAKE_MAKE_PROGRAM}
+        -DCMAKE_GENERATOR=${CMAKE_GENERATOR}
+        -DCMAKE_POSITION_INDEPENDENT_CODE=ON
+        -DBENCHMARK_ENABLE_TESTING=OFF
+        -DBENCHMARK_ENABLE_GTEST_TESTS=OFF
+        -DBENCHMARK_ENABLE_INSTALL=OFF
+    BUILD_BYPRODUCTS
+        "${BENCHMARK_PREFIX}/src/googlebenchmark_project-build/src/${CMAKE_CFG_INTDIR}/${CMAKE_STATIC_LIBRARY_PREFIX}benchmark${CMAKE_STATIC_LIBRARY_SUFFIX}"
+        "${BENCHMARK_PREFIX}/src/googlebenchmark_project-build/src/${CMAKE_CFG_INTDIR}/${CMAKE_STATIC_LIBRARY_PREFIX}benchmark_main${CMAKE_STATIC_LIBRARY_SUFFIX}"
+     INSTALL_COMMAND ""
+)
+
+ExternalProject_Get_Property(googlebenchmark_project source_dir)
+
+set(BENCHMARK_INCLUDE_DIR ${source_dir}/include CACHE STRING "google benchmark include files")
+
+ExternalProject_Get_Property(googlebenchmark_project binary_dir)
+
+set(BENCHMARK_LIBS
+    ${binary_dir}/src/${CMAKE_CFG_INTDIR}/${CMAKE_STATIC_LIBRARY_PREFIX}benchmark_main${CMAKE_STATIC_LIBRARY_SUFFIX}
+    ${binary_dir}/src/${CMAKE_CFG_INTDIR}/${CMAKE_STATIC_LIBRARY_PREFIX}benchmark${CMAKE_STATIC_LIBRARY_SUFFIX}
+    CACHE STRING "google benchmark libraries"
+)
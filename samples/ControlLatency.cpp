@@ -0,0 +1,332 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <signal.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <AeronArchive.h>
+#include <LatencyHistogram.h>
+
+#include "MockArchive.h"
+#include "SamplesUtil.h"
+
+namespace archive = aeron::archive;
+namespace codecs = io::aeron::archive::codecs;
+namespace po = boost::program_options;
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+std::atomic<bool> running{true};
+
+void sigIntHandler(int) { running = false; }
+
+std::int64_t toNanos(Clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+
+using archive::Operation;
+
+struct OperationStats {
+    // from the call to the response
+    archive::LatencyHistogram service;
+    // from the time the call was due, or service time corrected for the calls a stall held back
+    archive::LatencyHistogram corrected;
+    std::int64_t errors{0};
+};
+
+class ControlLatency {
+public:
+    ControlLatency(const std::shared_ptr<archive::AeronArchive>& aeronArchive, bool isOpenLoop, std::int64_t intervalNs)
+        : archive_(aeronArchive), isOpenLoop_(isOpenLoop), intervalNs_(intervalNs) {}
+
+    void target(std::int64_t recordingId, std::int64_t replayLength, const std::string& replayChannel,
+                std::int32_t replayStreamId, const std::string& recordChannel, std::int32_t recordStreamId) {
+        recordingId_ = recordingId;
+        replayLength_ = replayLength;
+        replayChannel_ = replayChannel;
+        replayStreamId_ = replayStreamId;
+        recordChannel_ = recordChannel;
+        recordStreamId_ = recordStreamId;
+    }
+
+    void run(const std::vector<Operation>& schedule, std::chrono::nanoseconds duration) {
+        const auto start = Clock::now();
+        const auto end = start + duration;
+
+        for (std::int64_t i = 0; running; ++i) {
+            // the schedule does not slip when a call is late, late calls are issued back to back
+            const auto due = start + std::chrono::nanoseconds(i * intervalNs_);
+            if (due > end || Clock::now() > end) {
+                break;
+            }
+
+            while (Clock::now() < due) {
+                std::this_thread::yield();
+            }
+
+            execute(schedule[i % schedule.size()], due);
+        }
+    }
+
+    void reset() { stats_.clear(); }
+
+    void report(std::ostream& out) const {
+        for (const auto& entry : stats_) {
+            out << entry.first << " (errors=" << entry.second->errors << ")\n"
+                << "  service:   " << archive::latencySummary(entry.second->service.snapshot()) << '\n'
+                << "  corrected: " << archive::latencySummary(entry.second->corrected.snapshot()) << '\n';
+        }
+    }
+
+    void reportCsv(std::ostream& out, const std::string& prefix) const {
+        for (const auto& entry : stats_) {
+            out << prefix << ',' << entry.first << ",service," << entry.second->errors << ','
+                << archive::latencyCsvRow(entry.second->service.snapshot()) << '\n';
+            out << prefix << ',' << entry.first << ",corrected," << entry.second->errors << ','
+                << archive::latencyCsvRow(entry.second->corrected.snapshot()) << '\n';
+        }
+    }
+
+private:
+    void execute(Operation operation, Clock::time_point due) {
+        switch (operation) {
+            case Operation::RECORDING_POSITION:
+                timed("getRecordingPosition", due, [this] { archive_->getRecordingPosition(recordingId_); });
+                break;
+            case Operation::LIST_RECORDING:
+                timed("listRecording", due, [this] { archive::listRecording(*archive_, recordingId_); });
+                break;
+            case Operation::REPLAY: {
+                std::int64_t replaySessionId = -1;
+                auto done = timed("startReplay", due, [&] {
+                    replaySessionId =
+                        archive_->startReplay(recordingId_, 0, replayLength_, replayChannel_, replayStreamId_);
+                });
+                if (replaySessionId != -1) {
+                    timed("stopReplay", done, [&] { archive_->stopReplay(replaySessionId); });
+                }
+                break;
+            }
+            case Operation::RECORD: {
+                bool isRecording = false;
+                auto done = timed("startRecording", due, [&] {
+                    archive_->startRecording(recordChannel_, recordStreamId_, codecs::SourceLocation::LOCAL);
+                    isRecording = true;
+                });
+                if (isRecording) {
+                    timed("stopRecording", done, [&] { archive_->stopRecording(recordChannel_, recordStreamId_); });
+                }
+                break;
+            }
+        }
+    }
+
+    template <typename F>
+    Clock::time_point timed(const std::string& name, Clock::time_point due, F&& call) {
+        auto& stats = stats_[name];
+        if (!stats) {
+            stats = std::make_unique<OperationStats>();
+        }
+
+        const auto start = Clock::now();
+        const std::int64_t serviceNs = archive::timed(stats->errors, std::forward<F>(call));
+        const auto done = start + std::chrono::nanoseconds(serviceNs);
+
+        stats->service.record(serviceNs);
+
+        if (isOpenLoop_) {
+            stats->corrected.record(toNanos(done - due));
+        } else {
+            stats->corrected.recordCorrected(serviceNs, intervalNs_);
+        }
+
+        return done;
+    }
+
+private:
+    std::shared_ptr<archive::AeronArchive> archive_;
+    const bool isOpenLoop_;
+    const std::int64_t intervalNs_;
+
+    std::int64_t recordingId_{-1};
+    std::int64_t replayLength_{0};
+    std::string replayChannel_;
+    std::int32_t replayStreamId_{0};
+    std::string recordChannel_;
+    std::int32_t recordStreamId_{0};
+
+    std::map<std::string, std::unique_ptr<OperationStats>> stats_;
+};
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    ::signal(SIGINT, sigIntHandler);
+
+    std::string configFile, channel, mix, mode, csvFile, controlChannel, responseChannel, replayChannel,
+        recordChannel;
+    std::int32_t streamId, replayStreamId, recordStreamId, rate, durationS, warmupS, mockRecordings;
+    std::int64_t recordingId, replayLength, messageTimeoutNs, mockDelayUs;
+    double mockErrorRate, mockDropRate;
+    bool useMock;
+
+    po::options_description desc("Options");
+    desc.add_options()("help", "print help message")(
+        "channel,c", po::value<std::string>(&channel)->default_value("aeron:udp?endpoint=localhost:40123"),
+        "channel of the recording used for position, list and replay calls")(
+        "stream-id,i", po::value<std::int32_t>(&streamId)->default_value(10))(
+        "recording-id", po::value<std::int64_t>(&recordingId)->default_value(-1),
+        "recording to query, the latest one of the channel when not set")(
+        "mix", po::value<std::string>(&mix)->default_value("position=4,list=3,replay=2,record=1"),
+        "weights of position, list, replay (start and stop) and record (start and stop) calls")(
+        "mode", po::value<std::string>(&mode)->default_value("open"),
+        "open: latency counts from the time a call was due, closed: service time corrected for the calls a "
+        "stall held back")("rate,r", po::value<std::int32_t>(&rate)->default_value(1000),
+                           "calls per second, 0 issues them back to back in closed loop")(
+        "duration,d", po::value<std::int32_t>(&durationS)->default_value(30), "seconds measured")(
+        "warmup,w", po::value<std::int32_t>(&warmupS)->default_value(5), "seconds run before measuring")(
+        "control-channel", po::value<std::string>(&controlChannel), "overrides the control request channel")(
+        "response-channel", po::value<std::string>(&responseChannel), "overrides the control response channel")(
+        "message-timeout-ns", po::value<std::int64_t>(&messageTimeoutNs)->default_value(0),
+        "overrides the archive message timeout")(
+        "replay-channel", po::value<std::string>(&replayChannel)->default_value("aeron:udp?endpoint=localhost:40124"))(
+        "replay-stream-id", po::value<std::int32_t>(&replayStreamId)->default_value(100))(
+        "replay-length", po::value<std::int64_t>(&replayLength)->default_value(1024 * 1024))(
+        "record-channel", po::value<std::string>(&recordChannel)->default_value("aeron:ipc"),
+        "channel recorded and stopped by record calls")(
+        "record-stream-id", po::value<std::int32_t>(&recordStreamId)->default_value(1001))(
+        "csv", po::value<std::string>(&csvFile), "appends the results to this file")(
+        "mock", po::bool_switch(&useMock)->default_value(false), "answer the calls with an in-process MockArchive")(
+        "mock-recordings", po::value<std::int32_t>(&mockRecordings)->default_value(1000))(
+        "mock-delay-us", po::value<std::int64_t>(&mockDelayUs)->default_value(0))(
+        "mock-error-rate", po::value<double>(&mockErrorRate)->default_value(0.0))(
+        "mock-drop-rate", po::value<double>(&mockDropRate)->default_value(0.0))(
+        "file,f", po::value<std::string>(&configFile));
+
+    try {
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << desc << '\n';
+            return 1;
+        }
+
+        if (mode != "open" && mode != "closed") {
+            throw std::invalid_argument("unknown mode: " + mode);
+        }
+
+        const bool isOpenLoop = mode == "open";
+        if (isOpenLoop && rate <= 0) {
+            throw std::invalid_argument("open loop needs a positive rate");
+        }
+
+        const std::vector<Operation> schedule = archive::parseMix(mix);
+
+        std::unique_ptr<archive::Configuration> cfg;
+
+        if (!configFile.empty()) {
+            cfg = std::make_unique<archive::Configuration>(configFile);
+        } else {
+            cfg = std::make_unique<archive::Configuration>();
+        }
+
+        archive::Context ctx(*cfg);
+        if (!controlChannel.empty()) {
+            ctx.controlRequestChannel(controlChannel);
+        }
+        if (!responseChannel.empty()) {
+            ctx.controlResponseChannel(responseChannel);
+        }
+        if (messageTimeoutNs > 0) {
+            ctx.messageTimeoutNs(messageTimeoutNs);
+        }
+        ctx.conclude();
+
+        std::unique_ptr<archive::MockArchive> mock;
+        if (useMock) {
+            mock = std::make_unique<archive::MockArchive>(ctx);
+            mock->responseDelay(std::chrono::microseconds(mockDelayUs))
+                .errorRate(mockErrorRate)
+                .dropRate(mockDropRate);
+            mock->addRecordings(mockRecordings, channel, streamId, replayLength);
+            mock->start();
+        }
+
+        auto aeronArchive = archive::AeronArchive::connect(ctx);
+
+        if (recordingId == -1) {
+            archive::RecordingData recording = archive::getLatestRecordingData(*aeronArchive, channel, streamId);
+            if (recording.recordingId == -1) {
+                throw std::runtime_error("no recording of " + channel + ":" + std::to_string(streamId) +
+                                         ", record one first or pass --recording-id");
+            }
+
+            recordingId = recording.recordingId;
+            if (recording.stopPosition > 0) {
+                replayLength = std::min(replayLength, recording.stopPosition);
+            }
+        }
+
+        const std::int64_t intervalNs = rate > 0 ? 1000000000LL / rate : 0;
+
+        ControlLatency test(aeronArchive, isOpenLoop, intervalNs);
+        test.target(recordingId, replayLength, replayChannel, replayStreamId, recordChannel, recordStreamId);
+
+        std::cout << mode << " loop at " << rate << " calls/s against recording " << recordingId << " over "
+                  << ctx.controlRequestChannel() << '\n';
+
+        test.run(schedule, std::chrono::seconds(warmupS));
+        test.reset();
+        test.run(schedule, std::chrono::seconds(durationS));
+
+        test.report(std::cout);
+
+        if (!csvFile.empty()) {
+            std::ofstream csv = archive::appendCsv(
+                csvFile, "mode,rate,control_channel,operation,latency,errors," + archive::latencyCsvHeader());
+            test.reportCsv(csv, mode + ',' + std::to_string(rate) + ",\"" + ctx.controlRequestChannel() + '"');
+        }
+
+        if (mock) {
+            mock->stop();
+        }
+    } catch (const archive::ArchiveException& e) {
+        std::cerr << "aeron archive exception: " << e.what() << " (" << e.where() << ")\n";
+        return 1;
+    } catch (const aeron::util::SourcedException& e) {
+        std::cerr << "aeron exception: " << e.what() << " (" << e.where() << ")\n";
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "exception: " << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,375 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <signal.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <AeronArchive.h>
+#include <LatencyHistogram.h>
+
+#include "MockArchive.h"
+#include "SamplesUtil.h"
+
+namespace archive = aeron::archive;
+namespace codecs = io::aeron::archive::codecs;
+namespace po = boost::program_options;
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+std::atomic<bool> running{true};
+
+void sigIntHandler(int) { running = false; }
+
+using archive::Operation;
+
+std::vector<std::int32_t> parseThreadCounts(const std::string& counts) {
+    std::vector<std::int32_t> result;
+    std::istringstream in(counts);
+    std::string count;
+
+    while (std::getline(in, count, ',')) {
+        const std::int32_t value = std::stoi(count);
+        if (value <= 0) {
+            throw std::invalid_argument("thread count must be positive: " + count);
+        }
+        result.push_back(value);
+    }
+
+    if (result.empty()) {
+        throw std::invalid_argument("no thread counts given");
+    }
+
+    return result;
+}
+
+void merge(archive::LatencySnapshot& into, const archive::LatencySnapshot& from) {
+    if (from.totalCount == 0) {
+        return;
+    }
+
+    if (into.totalCount == 0) {
+        into = from;
+        return;
+    }
+
+    for (std::size_t i = 0; i < into.counts.size(); ++i) {
+        into.counts[i] += from.counts[i];
+    }
+    into.totalCount += from.totalCount;
+    into.sum += from.sum;
+    into.minValue = std::min(into.minValue, from.minValue);
+    into.maxValue = std::max(into.maxValue, from.maxValue);
+}
+
+struct Target {
+    std::int64_t recordingId;
+    std::int64_t replayLength;
+    std::string replayChannel;
+    std::int32_t replayStreamId;
+    std::string recordChannel;
+    // every thread records its own stream, offset by its index
+    std::int32_t recordStreamId;
+};
+
+struct RunResult {
+    std::int32_t threads;
+    std::int32_t clients;
+    std::int64_t calls;
+    std::int64_t errors;
+    double callsPerSecond;
+    archive::LatencySnapshot latency;
+    archive::LatencySnapshot lockWait;
+    archive::LatencySnapshot lockHold;
+};
+
+}  // namespace
+
+// Threads issue a mix of control calls back to back through either one shared client, serialised by its lock, or a
+// client each over one Aeron client. Every thread keeps its own histogram so the measurement adds no contention.
+class ControlScalability {
+public:
+    ControlScalability(const archive::Context& ctx, const Target& target, const std::vector<Operation>& schedule)
+        : ctx_(ctx), target_(target), schedule_(schedule) {}
+
+    RunResult run(std::int32_t threadCount, bool isShared, std::chrono::seconds duration) {
+        const std::int32_t clientCount = isShared ? 1 : threadCount;
+        while (static_cast<std::int32_t>(clients_.size()) < clientCount) {
+            clients_.push_back(archive::AeronArchive::connect(ctx_));
+        }
+
+        for (std::int32_t i = 0; i < clientCount; ++i) {
+            clients_[i]->lockWait().reset();
+            clients_[i]->lockHold().reset();
+        }
+
+        // every thread gets its own stats before any starts, the vector is not touched while they run
+        std::vector<std::unique_ptr<ThreadStats>> stats;
+        for (std::int32_t i = 0; i < threadCount; ++i) {
+            stats.push_back(std::make_unique<ThreadStats>());
+        }
+
+        std::vector<std::thread> threads;
+        const auto start = Clock::now();
+        const auto end = start + duration;
+
+        for (std::int32_t i = 0; i < threadCount; ++i) {
+            threads.emplace_back([this, i, end, &threadStats = *stats[i], &client = *clients_[isShared ? 0 : i]] {
+                runThread(client, i, end, threadStats);
+            });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        RunResult result{threadCount, clientCount, 0, 0, 0.0, {}, {}, {}};
+
+        for (const auto& threadStats : stats) {
+            result.calls += threadStats->calls;
+            result.errors += threadStats->errors;
+            merge(result.latency, threadStats->latency.snapshot());
+        }
+        result.callsPerSecond = result.calls / seconds;
+
+        for (std::int32_t i = 0; i < clientCount; ++i) {
+            merge(result.lockWait, clients_[i]->lockWait().snapshot());
+            merge(result.lockHold, clients_[i]->lockHold().snapshot());
+        }
+
+        return result;
+    }
+
+private:
+    struct ThreadStats {
+        archive::LatencyHistogram latency;
+        std::int64_t calls{0};
+        std::int64_t errors{0};
+    };
+
+    void runThread(archive::AeronArchive& client, std::int32_t threadIndex, Clock::time_point end,
+                   ThreadStats& stats) {
+        const std::int32_t recordStreamId = target_.recordStreamId + threadIndex;
+
+        // threads start at different points of the schedule so they do not issue the same call in lock step
+        for (std::size_t i = threadIndex; running && Clock::now() < end; ++i) {
+            switch (schedule_[i % schedule_.size()]) {
+                case Operation::RECORDING_POSITION:
+                    timed(stats, [&] { client.getRecordingPosition(target_.recordingId); });
+                    break;
+                case Operation::LIST_RECORDING:
+                    timed(stats, [&] { archive::listRecording(client, target_.recordingId); });
+                    break;
+                case Operation::REPLAY: {
+                    std::int64_t replaySessionId = -1;
+                    timed(stats, [&] {
+                        replaySessionId = client.startReplay(target_.recordingId, 0, target_.replayLength,
+                                                             target_.replayChannel, target_.replayStreamId);
+                    });
+                    if (replaySessionId != -1) {
+                        timed(stats, [&] { client.stopReplay(replaySessionId); });
+                    }
+                    break;
+                }
+                case Operation::RECORD: {
+                    bool isRecording = false;
+                    timed(stats, [&] {
+                        client.startRecording(target_.recordChannel, recordStreamId, codecs::SourceLocation::LOCAL);
+                        isRecording = true;
+                    });
+                    if (isRecording) {
+                        timed(stats, [&] { client.stopRecording(target_.recordChannel, recordStreamId); });
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    template <typename F>
+    static void timed(ThreadStats& stats, F&& call) {
+        stats.latency.record(archive::timed(stats.errors, std::forward<F>(call)));
+        ++stats.calls;
+    }
+
+private:
+    const archive::Context ctx_;
+    const Target target_;
+    const std::vector<Operation> schedule_;
+
+    std::vector<std::shared_ptr<archive::AeronArchive>> clients_;
+};
+
+namespace {
+
+void printResult(const RunResult& result) {
+    std::cout << std::fixed << std::setprecision(1) << result.threads << " threads on " << result.clients
+              << " clients: " << result.callsPerSecond << " calls/s, " << result.errors << " errors\n"
+              << "  latency:   " << archive::latencySummary(result.latency) << '\n'
+              << "  lock wait: " << archive::latencySummary(result.lockWait) << '\n'
+              << "  lock hold: " << archive::latencySummary(result.lockHold) << '\n';
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    ::signal(SIGINT, sigIntHandler);
+
+    std::string configFile, channel, mix, clients, threadCounts, csvFile, replayChannel, recordChannel;
+    std::int32_t streamId, replayStreamId, recordStreamId, durationS, warmupS, mockRecordings;
+    std::int64_t recordingId, replayLength, mockDelayUs;
+    bool useMock;
+
+    po::options_description desc("Options");
+    desc.add_options()("help", "print help message")(
+        "channel,c", po::value<std::string>(&channel)->default_value("aeron:udp?endpoint=localhost:40123"),
+        "channel of the recording used for position, list and replay calls")(
+        "stream-id,i", po::value<std::int32_t>(&streamId)->default_value(10))(
+        "recording-id", po::value<std::int64_t>(&recordingId)->default_value(-1),
+        "recording to query, the latest one of the channel when not set")(
+        "mix", po::value<std::string>(&mix)->default_value("position=4,list=3,replay=2,record=1"),
+        "weights of position, list, replay (start and stop) and record (start and stop) calls")(
+        "threads,t", po::value<std::string>(&threadCounts)->default_value("1,2,4,8,16,32,64"),
+        "comma separated thread counts")(
+        "clients", po::value<std::string>(&clients)->default_value("shared"),
+        "shared: one client for all threads, own: a client per thread")(
+        "duration,d", po::value<std::int32_t>(&durationS)->default_value(10), "seconds measured per thread count")(
+        "warmup,w", po::value<std::int32_t>(&warmupS)->default_value(2), "seconds run before each measurement")(
+        "replay-channel", po::value<std::string>(&replayChannel)->default_value("aeron:udp?endpoint=localhost:40124"))(
+        "replay-stream-id", po::value<std::int32_t>(&replayStreamId)->default_value(100))(
+        "replay-length", po::value<std::int64_t>(&replayLength)->default_value(1024 * 1024))(
+        "record-channel", po::value<std::string>(&recordChannel)->default_value("aeron:ipc"),
+        "channel recorded and stopped by record calls")(
+        "record-stream-id", po::value<std::int32_t>(&recordStreamId)->default_value(1001),
+        "stream recorded by the first thread, the others record the following ones")(
+        "csv", po::value<std::string>(&csvFile), "appends the results to this file")(
+        "mock", po::bool_switch(&useMock)->default_value(false), "answer the calls with an in-process MockArchive")(
+        "mock-recordings", po::value<std::int32_t>(&mockRecordings)->default_value(1000))(
+        "mock-delay-us", po::value<std::int64_t>(&mockDelayUs)->default_value(0))(
+        "file,f", po::value<std::string>(&configFile));
+
+    try {
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << desc << '\n';
+            return 1;
+        }
+
+        if (clients != "shared" && clients != "own") {
+            throw std::invalid_argument("unknown clients: " + clients);
+        }
+
+        const std::vector<Operation> schedule = archive::parseMix(mix);
+        const std::vector<std::int32_t> threadCountList = parseThreadCounts(threadCounts);
+
+        std::unique_ptr<archive::Configuration> cfg;
+
+        if (!configFile.empty()) {
+            cfg = std::make_unique<archive::Configuration>(configFile);
+        } else {
+            cfg = std::make_unique<archive::Configuration>();
+        }
+
+        // the clients of every thread share the Aeron client of the context
+        archive::Context ctx(*cfg);
+        ctx.lockTiming(true);
+        ctx.conclude();
+
+        std::unique_ptr<archive::MockArchive> mock;
+        if (useMock) {
+            mock = std::make_unique<archive::MockArchive>(ctx);
+            mock->responseDelay(std::chrono::microseconds(mockDelayUs));
+            mock->addRecordings(mockRecordings, channel, streamId, replayLength);
+            mock->start();
+        }
+
+        if (recordingId == -1) {
+            auto aeronArchive = archive::AeronArchive::connect(ctx);
+            archive::RecordingData recording = archive::getLatestRecordingData(*aeronArchive, channel, streamId);
+            if (recording.recordingId == -1) {
+                throw std::runtime_error("no recording of " + channel + ":" + std::to_string(streamId) +
+                                         ", record one first or pass --recording-id");
+            }
+
+            recordingId = recording.recordingId;
+            if (recording.stopPosition > 0) {
+                replayLength = std::min(replayLength, recording.stopPosition);
+            }
+        }
+
+        ControlScalability test(
+            ctx, Target{recordingId, replayLength, replayChannel, replayStreamId, recordChannel, recordStreamId},
+            schedule);
+        std::vector<RunResult> results;
+
+        for (std::int32_t threadCount : threadCountList) {
+            if (!running) {
+                break;
+            }
+
+            if (warmupS > 0) {
+                test.run(threadCount, clients == "shared", std::chrono::seconds(warmupS));
+            }
+
+            results.push_back(test.run(threadCount, clients == "shared", std::chrono::seconds(durationS)));
+            printResult(results.back());
+        }
+
+        if (!csvFile.empty()) {
+            std::ofstream csv = archive::appendCsv(
+                csvFile, "clients,threads,client_count,calls_per_s,errors,metric," + archive::latencyCsvHeader());
+
+            for (const auto& result : results) {
+                const std::string prefix = clients + ',' + std::to_string(result.threads) + ',' +
+                                           std::to_string(result.clients) + ',' +
+                                           std::to_string(result.callsPerSecond) + ',' + std::to_string(result.errors);
+                csv << prefix << ",latency," << archive::latencyCsvRow(result.latency) << '\n'
+                    << prefix << ",lock_wait," << archive::latencyCsvRow(result.lockWait) << '\n'
+                    << prefix << ",lock_hold," << archive::latencyCsvRow(result.lockHold) << '\n';
+            }
+        }
+
+        if (mock) {
+            mock->stop();
+        }
+    } catch (const archive::ArchiveException& e) {
+        std::cerr << "aeron archive exception: " << e.what() << " (" << e.where() << ")\n";
+        return 1;
+    } catch (const aeron::util::SourcedException& e) {
+        std::cerr << "aeron exception: " << e.what() << " (" << e.where() << ")\n";
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "exception: " << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,322 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <signal.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <AeronArchive.h>
+#include <LatencyHistogram.h>
+#include <RecordingAckTracker.h>
+
+#include "SamplesUtil.h"
+
+namespace archive = aeron::archive;
+namespace po = boost::program_options;
+
+namespace {
+const std::chrono::seconds RECORDING_TIMEOUT(30);
+
+std::atomic<bool> running{true};
+
+void sigIntHandler(int) { running = false; }
+
+using Clock = std::chrono::high_resolution_clock;
+
+std::int64_t toNanos(Clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+
+// every value must be at least minValue, a rate of 0 would divide by zero when pacing
+template <typename T>
+std::vector<T> parsePositiveList(const std::string& name, const std::string& values, T minValue = 1) {
+    std::vector<T> result;
+    std::istringstream in(values);
+    std::string value;
+
+    while (std::getline(in, value, ',')) {
+        const long long parsed = std::stoll(value);
+        if (parsed < minValue || parsed > std::numeric_limits<T>::max()) {
+            throw std::invalid_argument(name + " must be at least " + std::to_string(minValue) + ": " + value);
+        }
+
+        result.push_back(static_cast<T>(parsed));
+    }
+
+    if (result.empty()) {
+        throw std::invalid_argument("no " + name + " given");
+    }
+
+    return result;
+}
+
+struct RunResult {
+    std::int64_t rate;
+    std::int32_t messageLength;
+    std::int64_t messages;
+    // latencies over the spike threshold, the worst of them and when it was offered since the start of the run
+    std::int64_t spikes;
+    std::int64_t worstSpikeNs;
+    std::int64_t worstSpikeOfferedNs;
+    // bytes offered but not yet recorded
+    std::int64_t maxLag;
+    archive::LatencySnapshot latency;
+};
+
+}  // namespace
+
+// Offers are paced at a fixed rate and every offered position is stamped with the time the offer was due, so
+// back pressure counts towards the latency. A second thread follows the RecordingPos counter of the recording and
+// records how long each position took from being due to being recorded.
+class DurableLatency {
+public:
+    DurableLatency(const std::shared_ptr<archive::AeronArchive>& aeronArchive, const std::string& channel,
+                   std::int32_t streamId, std::chrono::nanoseconds spikeThreshold)
+        : archive_(aeronArchive)
+        , publication_(archive_->addRecordedExclusivePublication(channel, streamId))
+        , tracker_(archive_, publication_->sessionId())
+        , spikeThreshold_(spikeThreshold) {
+        std::cout << "recording " << channel << " stream " << streamId << " as recording "
+                  << tracker_.recordingId() << '\n';
+    }
+
+    void stopRecording() { archive_->stopRecording(*publication_); }
+
+    RunResult run(std::int64_t rate, std::int32_t messageLength, std::chrono::seconds duration) {
+        const std::int64_t messages = rate * duration.count();
+
+        sent_.resize(messages);
+        sentCount_ = 0;
+        isPublishing_ = true;
+        latency_.reset();
+
+        RunResult result{rate, messageLength, 0, 0, 0, 0, 0, {}};
+
+        std::vector<std::uint8_t> buffer(messageLength);
+        aeron::concurrent::AtomicBuffer bufferWrap(&buffer[0], messageLength);
+
+        const std::chrono::nanoseconds interval(1000000000 / rate);
+        const auto start = Clock::now();
+        auto due = start;
+
+        std::thread observer([this, start, &result] { observe(start, result); });
+
+        for (std::int64_t i = 0; i < messages && running; ++i) {
+            while (Clock::now() < due) {
+                // busy spin to keep the pace below the scheduler resolution
+            }
+
+            bufferWrap.putInt64(0, i);
+
+            std::int64_t position;
+            while ((position = publication_->offer(bufferWrap, 0, messageLength)) < 0 && running) {
+                std::this_thread::yield();
+            }
+
+            sent_[i] = Sent{position, toNanos(due - start)};
+            sentCount_.store(i + 1, std::memory_order_release);
+            due += interval;
+        }
+
+        isPublishing_ = false;
+        observer.join();
+
+        result.latency = latency_.snapshot();
+        return result;
+    }
+
+private:
+    struct Sent {
+        std::int64_t position;
+        std::int64_t dueNs;
+    };
+
+    void observe(Clock::time_point start, RunResult& result) {
+        std::int64_t index = 0;
+        auto progress = Clock::now();
+
+        while (running) {
+            const bool isPublishing = isPublishing_;
+            const std::int64_t sentCount = sentCount_.load(std::memory_order_acquire);
+
+            if (index == sentCount) {
+                if (!isPublishing) {
+                    break;
+                }
+                continue;
+            }
+
+            const std::int64_t recordedPosition = tracker_.recordedPosition();
+            const auto now = Clock::now();
+            const std::int64_t nowNs = toNanos(now - start);
+
+            result.maxLag = std::max(result.maxLag, sent_[sentCount - 1].position - recordedPosition);
+
+            const std::int64_t firstIndex = index;
+            for (; index < sentCount && sent_[index].position <= recordedPosition; ++index) {
+                const std::int64_t latencyNs = nowNs - sent_[index].dueNs;
+                latency_.record(latencyNs);
+
+                if (latencyNs > spikeThreshold_.count()) {
+                    ++result.spikes;
+                    if (latencyNs > result.worstSpikeNs) {
+                        result.worstSpikeNs = latencyNs;
+                        result.worstSpikeOfferedNs = sent_[index].dueNs;
+                    }
+                }
+            }
+            result.messages = index;
+
+            if (index > firstIndex) {
+                progress = now;
+            } else if (now - progress > RECORDING_TIMEOUT) {
+                std::cerr << "recording made no progress for " << RECORDING_TIMEOUT.count() << " s at position "
+                          << recordedPosition << '\n';
+                running = false;
+            }
+        }
+    }
+
+private:
+    std::shared_ptr<archive::AeronArchive> archive_;
+    std::shared_ptr<aeron::ExclusivePublication> publication_;
+    archive::RecordingAckTracker tracker_;
+    const std::chrono::nanoseconds spikeThreshold_;
+
+    // written by the publishing thread up to sentCount_, read by the observer
+    std::vector<Sent> sent_;
+    std::atomic<std::int64_t> sentCount_{0};
+    std::atomic<bool> isPublishing_{false};
+
+    archive::LatencyHistogram latency_;
+};
+
+namespace {
+
+void printResult(const RunResult& result) {
+    std::cout << std::fixed << std::setprecision(1) << result.rate << " msg/s of " << result.messageLength
+              << " bytes: " << archive::latencySummary(result.latency) << '\n'
+              << "    " << result.spikes << " spikes";
+    if (result.spikes > 0) {
+        std::cout << ", worst " << result.worstSpikeNs / 1000.0 << " us offered at "
+                  << result.worstSpikeOfferedNs / 1e9 << " s";
+    }
+    std::cout << ", max lag " << result.maxLag << " bytes\n";
+}
+
+}  // namespace
+
+//
+int main(int argc, char* argv[]) {
+    ::signal(SIGINT, sigIntHandler);
+
+    std::string channel, configFile, rates, messageLengths, csvFile;
+    std::int32_t streamId, durationSeconds, warmupSeconds;
+    std::int64_t spikeUs;
+
+    po::options_description desc("Options");
+    desc.add_options()("help", "print help message")(
+        "channel,c", po::value<std::string>(&channel)->default_value("aeron:udp?endpoint=localhost:40123"))(
+        "stream-id,i", po::value<std::int32_t>(&streamId)->default_value(10))(
+        "rates,r", po::value<std::string>(&rates)->default_value("1000,10000,100000"),
+        "comma separated message rates per second")(
+        "message-length,l", po::value<std::string>(&messageLengths)->default_value("32,256,1024"),
+        "comma separated message lengths")(
+        "duration,d", po::value<std::int32_t>(&durationSeconds)->default_value(10), "seconds measured per run")(
+        "warmup,w", po::value<std::int32_t>(&warmupSeconds)->default_value(2), "seconds discarded before each run")(
+        "spike-us", po::value<std::int64_t>(&spikeUs)->default_value(1000), "latency reported as a lag spike")(
+        "csv", po::value<std::string>(&csvFile), "appends the results to this file")(
+        "file,f", po::value<std::string>(&configFile));
+
+    try {
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << desc << '\n';
+            return 1;
+        }
+
+        const auto rateList = parsePositiveList<std::int64_t>("rates", rates);
+        // a message carries its int64 sequence number
+        const auto messageLengthList = parsePositiveList<std::int32_t>(
+            "message lengths", messageLengths, static_cast<std::int32_t>(sizeof(std::int64_t)));
+
+        std::unique_ptr<archive::Configuration> cfg;
+
+        if (!configFile.empty()) {
+            cfg = std::make_unique<archive::Configuration>(configFile);
+        } else {
+            cfg = std::make_unique<archive::Configuration>();
+        }
+
+        archive::Context ctx(*cfg);
+        auto aeronArchive = archive::AeronArchive::connect(ctx);
+
+        DurableLatency test(aeronArchive, channel, streamId, std::chrono::microseconds(spikeUs));
+        std::vector<RunResult> results;
+
+        for (std::int64_t rate : rateList) {
+            for (std::int32_t messageLength : messageLengthList) {
+                if (!running) {
+                    break;
+                }
+
+                if (warmupSeconds > 0) {
+                    test.run(rate, messageLength, std::chrono::seconds(warmupSeconds));
+                }
+
+                results.push_back(test.run(rate, messageLength, std::chrono::seconds(durationSeconds)));
+                printResult(results.back());
+            }
+        }
+
+        test.stopRecording();
+
+        if (!csvFile.empty()) {
+            std::ofstream csv = archive::appendCsv(
+                csvFile, "rate,message_length,spikes,worst_spike_us,max_lag_bytes," + archive::latencyCsvHeader());
+
+            for (const auto& result : results) {
+                csv << result.rate << ',' << result.messageLength << ',' << result.spikes << ','
+                    << result.worstSpikeNs / 1000.0 << ',' << result.maxLag << ','
+                    << archive::latencyCsvRow(result.latency) << '\n';
+            }
+        }
+    } catch (const archive::ArchiveException& e) {
+        std::cerr << "aeron archive exception: " << e.what() << " (" << e.where() << ")\n";
+        return 1;
+    } catch (const aeron::util::SourcedException& e) {
+        std::cerr << "aeron exception: " << e.what() << " (" << e.where() << ")\n";
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "exception: " << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <signal.h>
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+#include <boost/program_options.hpp>
+
+#include <concurrent/ringbuffer/ManyToOneRingBuffer.h>
+#include <util/MemoryMappedFile.h>
+
+#include <EventLog.h>
+
+namespace po = boost::program_options;
+
+namespace {
+const std::chrono::duration<long, std::milli> IDLE_SLEEP_MS(1);
+const int MESSAGE_LIMIT = 100;
+
+std::atomic<bool> running{true};
+
+void sigIntHandler(int) { running = false; }
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    ::signal(SIGINT, sigIntHandler);
+
+    std::string fileName;
+    bool follow;
+
+    po::options_description desc("Options");
+    desc.add_options()("help", "print help message")(
+        "file,f", po::value<std::string>(&fileName)->required(), "event log file")(
+        "follow", po::bool_switch(&follow), "keep reading new events until interrupted");
+
+    try {
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help")) {
+            std::cout << desc << '\n';
+            return 1;
+        }
+
+        po::notify(vm);
+
+        auto file = aeron::util::MemoryMappedFile::mapExisting(fileName.c_str());
+        aeron::concurrent::AtomicBuffer buffer(file->getMemoryPtr(),
+                                               static_cast<aeron::util::index_t>(file->getMemorySize()));
+        aeron::concurrent::ringbuffer::ManyToOneRingBuffer ringBuffer(buffer);
+
+        // reading consumes the events so a single reader is expected
+        auto handler = [](std::int32_t code, aeron::concurrent::AtomicBuffer& buffer, aeron::util::index_t offset,
+                          aeron::util::index_t length) {
+            std::cout << aeron::archive::EventLog::format(code, buffer, offset, length) << '\n';
+        };
+
+        while (running) {
+            if (ringBuffer.read(handler, MESSAGE_LIMIT) == 0) {
+                if (!follow) {
+                    break;
+                }
+
+                std::this_thread::sleep_for(IDLE_SLEEP_MS);
+            }
+        }
+
+        std::cout.flush();
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
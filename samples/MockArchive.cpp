@@ -0,0 +1,614 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "io_aeron_archive_codecs/CloseSessionRequest.h"
+#include "io_aeron_archive_codecs/ConnectRequest.h"
+#include "io_aeron_archive_codecs/ControlResponse.h"
+#include "io_aeron_archive_codecs/ExtendRecordingRequest.h"
+#include "io_aeron_archive_codecs/FindLastMatchingRecordingRequest.h"
+#include "io_aeron_archive_codecs/ListRecordingRequest.h"
+#include "io_aeron_archive_codecs/ListRecordingsForUriRequest.h"
+#include "io_aeron_archive_codecs/ListRecordingsRequest.h"
+#include "io_aeron_archive_codecs/RecordingDescriptor.h"
+#include "io_aeron_archive_codecs/RecordingPositionRequest.h"
+#include "io_aeron_archive_codecs/RecordingStarted.h"
+#include "io_aeron_archive_codecs/RecordingStopped.h"
+#include "io_aeron_archive_codecs/ReplayRequest.h"
+#include "io_aeron_archive_codecs/StartRecordingRequest.h"
+#include "io_aeron_archive_codecs/StopPositionRequest.h"
+#include "io_aeron_archive_codecs/StopRecordingRequest.h"
+#include "io_aeron_archive_codecs/StopRecordingSubscriptionRequest.h"
+#include "io_aeron_archive_codecs/StopReplayRequest.h"
+#include "io_aeron_archive_codecs/TruncateRecordingRequest.h"
+
+#include <ChannelUri.h>
+
+#include "MockArchive.h"
+
+namespace codecs = io::aeron::archive::codecs;
+
+namespace {
+
+const std::int32_t FRAGMENT_LIMIT = 10;
+const std::int64_t NULL_VALUE = -1;
+const std::int64_t NULL_POSITION = -1;
+const std::int32_t SEGMENT_FILE_LENGTH = 128 * 1024 * 1024;
+const std::int32_t TERM_BUFFER_LENGTH = 64 * 1024;
+const std::int32_t MTU_LENGTH = 1408;
+const std::string SOURCE_IDENTITY = "mock-archive";
+const std::string SESSION_ID_PARAM_NAME = "session-id";
+// a response still back pressured after this many offers is dropped, the client times out on it
+const std::int32_t SEND_ATTEMPTS = 3;
+
+std::int64_t epochMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+}  // namespace
+
+namespace aeron {
+namespace archive {
+
+MockArchive::MockArchive(const Context& ctx)
+    : ctx_(ctx)
+    , fragmentAssembler_([this](concurrent::AtomicBuffer& buffer, util::index_t offset, util::index_t length,
+                                Header& header) { onFragment(buffer, offset, length, header); })
+    , buffer_(&underlyingBuffer_[0], underlyingBuffer_.size()) {
+    ctx_.conclude();
+    aeron_ = ctx_.aeron();
+    fragmentHandler_ = fragmentAssembler_.handler();
+
+    std::int64_t subId = aeron_->addSubscription(ctx_.controlRequestChannel(), ctx_.controlRequestStreamId());
+    while (!(requestSubscription_ = aeron_->findSubscription(subId))) {
+        std::this_thread::yield();
+    }
+
+    std::int64_t pubId =
+        aeron_->addExclusivePublication(ctx_.recordingEventsChannel(), ctx_.recordingEventsStreamId());
+    while (!(eventsPublication_ = aeron_->findExclusivePublication(pubId))) {
+        std::this_thread::yield();
+    }
+}
+
+MockArchive::~MockArchive() { stop(); }
+
+MockArchive& MockArchive::responseDelay(std::chrono::nanoseconds delay) {
+    responseDelay_ = delay;
+    return *this;
+}
+
+MockArchive& MockArchive::errorRate(double rate) {
+    errorRate_ = rate;
+    return *this;
+}
+
+MockArchive& MockArchive::dropRate(double rate) {
+    dropRate_ = rate;
+    return *this;
+}
+
+MockArchive& MockArchive::seed(std::uint64_t seed) {
+    random_.seed(seed);
+    return *this;
+}
+
+std::int64_t MockArchive::addRecording(const std::string& channel, std::int32_t streamId, std::int32_t sessionId,
+                                       std::int64_t startPosition, std::int64_t stopPosition) {
+    const std::int64_t recordingId = static_cast<std::int64_t>(catalog_.size());
+    const std::int64_t timestamp = epochMs();
+
+    catalog_.push_back(Recording{recordingId, timestamp, timestamp, startPosition, stopPosition, sessionId, streamId,
+                                 channel, NULL_VALUE, false});
+
+    return recordingId;
+}
+
+void MockArchive::addRecordings(std::int32_t count, const std::string& channel, std::int32_t streamId,
+                                std::int64_t length) {
+    catalog_.reserve(catalog_.size() + count);
+
+    for (std::int32_t i = 0; i < count; ++i) {
+        addRecording(channel, streamId, nextSessionId_++, 0, length);
+    }
+}
+
+std::int32_t MockArchive::doWork() {
+    std::int32_t workCount = requestSubscription_->poll(fragmentHandler_, FRAGMENT_LIMIT);
+    const auto now = Clock::now();
+
+    // the delay is the same for every request so the queue is ordered by due time
+    while (!pending_.empty() && pending_.front().due <= now) {
+        PendingRequest request = std::move(pending_.front());
+        pending_.pop_front();
+
+        concurrent::AtomicBuffer buffer(&request.bytes[0], static_cast<util::index_t>(request.bytes.size()));
+        onRequest(buffer);
+        ++workCount;
+    }
+
+    return workCount;
+}
+
+void MockArchive::start() {
+    if (isRunning_.exchange(true)) {
+        return;
+    }
+
+    thread_ = std::thread([this] {
+        concurrent::YieldingIdleStrategy idleStrategy;
+        while (isRunning_) {
+            idleStrategy.idle(doWork());
+        }
+    });
+}
+
+void MockArchive::stop() {
+    isRunning_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+std::int64_t MockArchive::requestCount() const { return requestCount_.load(std::memory_order_relaxed); }
+
+std::int64_t MockArchive::errorCount() const { return errorCount_.load(std::memory_order_relaxed); }
+
+std::int64_t MockArchive::droppedCount() const { return droppedCount_.load(std::memory_order_relaxed); }
+
+std::int32_t MockArchive::recordingCount() const { return static_cast<std::int32_t>(catalog_.size()); }
+
+void MockArchive::onFragment(concurrent::AtomicBuffer& buffer, util::index_t offset, util::index_t length,
+                             Header& header) {
+    requestCount_.fetch_add(1, std::memory_order_relaxed);
+
+    const std::uint8_t* request = buffer.buffer() + offset;
+    pending_.push_back(
+        PendingRequest{Clock::now() + responseDelay_, std::vector<std::uint8_t>(request, request + length)});
+}
+
+template <typename T, typename Handler>
+void MockArchive::dispatch(concurrent::AtomicBuffer& buffer, codecs::MessageHeader& hdr, Handler&& handler) {
+    T msg;
+    msg.wrapForDecode((char*)buffer.buffer(), hdr.encodedLength(), hdr.blockLength(), hdr.version(),
+                      buffer.capacity());
+
+    auto it = sessions_.find(msg.controlSessionId());
+    if (it == sessions_.end()) {
+        return;
+    }
+
+    Session& session = it->second;
+
+    if (dropRate_ > 0.0 && uniform_(random_) < dropRate_) {
+        droppedCount_.fetch_add(1, std::memory_order_relaxed);
+    } else if (errorRate_ > 0.0 && uniform_(random_) < errorRate_) {
+        errorCount_.fetch_add(1, std::memory_order_relaxed);
+        sendResponse(session, msg.correlationId(), NULL_VALUE, codecs::ControlResponseCode::ERROR, "injected error");
+    } else {
+        try {
+            handler(session, msg);
+        } catch (const std::exception& e) {
+            sendResponse(session, msg.correlationId(), NULL_VALUE, codecs::ControlResponseCode::ERROR, e.what());
+        }
+    }
+}
+
+void MockArchive::onRequest(concurrent::AtomicBuffer& buffer) {
+    codecs::MessageHeader hdr;
+    hdr.wrap((char*)buffer.buffer(), 0, 0, buffer.capacity());
+
+    const std::uint16_t templateId = hdr.templateId();
+
+    if (templateId == codecs::ConnectRequest::sbeTemplateId()) {
+        codecs::ConnectRequest msg;
+        msg.wrapForDecode((char*)buffer.buffer(), hdr.encodedLength(), hdr.blockLength(), hdr.version(),
+                          buffer.capacity());
+
+        onConnect(msg.correlationId(), msg.responseStreamId(), msg.getResponseChannelAsString());
+    } else if (templateId == codecs::CloseSessionRequest::sbeTemplateId()) {
+        codecs::CloseSessionRequest msg;
+        msg.wrapForDecode((char*)buffer.buffer(), hdr.encodedLength(), hdr.blockLength(), hdr.version(),
+                          buffer.capacity());
+
+        sessions_.erase(msg.controlSessionId());
+    } else if (templateId == codecs::StartRecordingRequest::sbeTemplateId()) {
+        dispatch<codecs::StartRecordingRequest>(
+            buffer, hdr, [this](Session& session, codecs::StartRecordingRequest& msg) {
+                onStartRecording(session, msg.correlationId(), msg.getChannelAsString(), msg.streamId());
+            });
+    } else if (templateId == codecs::StopRecordingRequest::sbeTemplateId()) {
+        dispatch<codecs::StopRecordingRequest>(
+            buffer, hdr, [this](Session& session, codecs::StopRecordingRequest& msg) {
+                onStopRecording(session, msg.correlationId(),
+                                subscriptionIdFor(msg.getChannelAsString(), msg.streamId()));
+            });
+    } else if (templateId == codecs::StopRecordingSubscriptionRequest::sbeTemplateId()) {
+        dispatch<codecs::StopRecordingSubscriptionRequest>(
+            buffer, hdr, [this](Session& session, codecs::StopRecordingSubscriptionRequest& msg) {
+                onStopRecording(session, msg.correlationId(), msg.subscriptionId());
+            });
+    } else if (templateId == codecs::ReplayRequest::sbeTemplateId()) {
+        dispatch<codecs::ReplayRequest>(buffer, hdr, [this](Session& session, codecs::ReplayRequest& msg) {
+            onReplay(session, msg.correlationId(), msg.recordingId());
+        });
+    } else if (templateId == codecs::StopReplayRequest::sbeTemplateId()) {
+        dispatch<codecs::StopReplayRequest>(buffer, hdr, [this](Session& session, codecs::StopReplayRequest& msg) {
+            onStopReplay(session, msg.correlationId(), msg.replaySessionId());
+        });
+    } else if (templateId == codecs::ListRecordingsRequest::sbeTemplateId()) {
+        dispatch<codecs::ListRecordingsRequest>(
+            buffer, hdr, [this](Session& session, codecs::ListRecordingsRequest& msg) {
+                onListRecordings(session, msg.correlationId(), msg.fromRecordingId(), msg.recordCount(), "", 0,
+                                 false);
+            });
+    } else if (templateId == codecs::ListRecordingsForUriRequest::sbeTemplateId()) {
+        dispatch<codecs::ListRecordingsForUriRequest>(
+            buffer, hdr, [this](Session& session, codecs::ListRecordingsForUriRequest& msg) {
+                onListRecordings(session, msg.correlationId(), msg.fromRecordingId(), msg.recordCount(),
+                                 msg.getChannelAsString(), msg.streamId(), true);
+            });
+    } else if (templateId == codecs::ListRecordingRequest::sbeTemplateId()) {
+        dispatch<codecs::ListRecordingRequest>(
+            buffer, hdr, [this](Session& session, codecs::ListRecordingRequest& msg) {
+                onListRecording(session, msg.correlationId(), msg.recordingId());
+            });
+    } else if (templateId == codecs::ExtendRecordingRequest::sbeTemplateId()) {
+        dispatch<codecs::ExtendRecordingRequest>(
+            buffer, hdr, [this](Session& session, codecs::ExtendRecordingRequest& msg) {
+                onExtendRecording(session, msg.correlationId(), msg.getChannelAsString(), msg.streamId(),
+                                  msg.recordingId());
+            });
+    } else if (templateId == codecs::RecordingPositionRequest::sbeTemplateId()) {
+        dispatch<codecs::RecordingPositionRequest>(
+            buffer, hdr, [this](Session& session, codecs::RecordingPositionRequest& msg) {
+                onRecordingPosition(session, msg.correlationId(), msg.recordingId());
+            });
+    } else if (templateId == codecs::TruncateRecordingRequest::sbeTemplateId()) {
+        dispatch<codecs::TruncateRecordingRequest>(
+            buffer, hdr, [this](Session& session, codecs::TruncateRecordingRequest& msg) {
+                onTruncateRecording(session, msg.correlationId(), msg.recordingId(), msg.position());
+            });
+    } else if (templateId == codecs::StopPositionRequest::sbeTemplateId()) {
+        dispatch<codecs::StopPositionRequest>(
+            buffer, hdr, [this](Session& session, codecs::StopPositionRequest& msg) {
+                onStopPosition(session, msg.correlationId(), msg.recordingId());
+            });
+    } else if (templateId == codecs::FindLastMatchingRecordingRequest::sbeTemplateId()) {
+        dispatch<codecs::FindLastMatchingRecordingRequest>(
+            buffer, hdr, [this](Session& session, codecs::FindLastMatchingRecordingRequest& msg) {
+                onFindLastMatchingRecording(session, msg.correlationId(), msg.minRecordingId(),
+                                            msg.getChannelAsString(), msg.streamId(), msg.sessionId());
+            });
+    }
+}
+
+void MockArchive::onConnect(std::int64_t correlationId, std::int32_t responseStreamId,
+                            const std::string& responseChannel) {
+    const std::int64_t controlSessionId = nextId_++;
+
+    std::int64_t pubId = aeron_->addExclusivePublication(responseChannel, responseStreamId);
+    std::shared_ptr<ExclusivePublication> publication;
+    while (!(publication = aeron_->findExclusivePublication(pubId))) {
+        std::this_thread::yield();
+    }
+
+    // like the archive, answer once the client has its response image, a client which is gone times out
+    const auto deadline = Clock::now() + std::chrono::nanoseconds(ctx_.messageTimeoutNs());
+    while (!publication->isConnected()) {
+        if (Clock::now() > deadline) {
+            return;
+        }
+        idle_.idle();
+    }
+
+    Session& session = sessions_.emplace(controlSessionId, Session{controlSessionId, publication}).first->second;
+    sendResponse(session, correlationId, controlSessionId, codecs::ControlResponseCode::OK);
+}
+
+void MockArchive::onListRecording(Session& session, std::int64_t correlationId, std::int64_t recordingId) {
+    const Recording* recording = findRecording(recordingId);
+
+    if (recording) {
+        sendDescriptor(session, correlationId, *recording);
+    } else {
+        sendResponse(session, correlationId, recordingId, codecs::ControlResponseCode::RECORDING_UNKNOWN);
+    }
+}
+
+void MockArchive::onRecordingPosition(Session& session, std::int64_t correlationId, std::int64_t recordingId) {
+    const Recording* recording = findRecording(recordingId);
+    const std::int64_t position = recording && recording->isActive ? recording->stopPosition : NULL_POSITION;
+
+    sendResponse(session, correlationId, position, codecs::ControlResponseCode::OK);
+}
+
+void MockArchive::onStopPosition(Session& session, std::int64_t correlationId, std::int64_t recordingId) {
+    const Recording* recording = findRecording(recordingId);
+
+    if (!recording) {
+        sendResponse(session, correlationId, NULL_VALUE, codecs::ControlResponseCode::ERROR,
+                     "unknown recording id: " + std::to_string(recordingId));
+        return;
+    }
+
+    sendResponse(session, correlationId, recording->isActive ? NULL_POSITION : recording->stopPosition,
+                 codecs::ControlResponseCode::OK);
+}
+
+void MockArchive::onStartRecording(Session& session, std::int64_t correlationId, const std::string& channel,
+                                   std::int32_t streamId) {
+    if (subscriptionIdFor(channel, streamId) != NULL_VALUE) {
+        sendResponse(session, correlationId, NULL_VALUE, codecs::ControlResponseCode::ERROR,
+                     "recording exists for streamId=" + std::to_string(streamId) + " channel=" + channel);
+        return;
+    }
+
+    // the archive records every image of the subscription, here a single recording stands for them
+    auto sessionIdParam = ChannelUri::parse(channel).get(SESSION_ID_PARAM_NAME);
+    const std::int32_t sessionId = sessionIdParam ? std::stoi(*sessionIdParam) : nextSessionId_++;
+    const std::int64_t subscriptionId = addSubscription(channel, streamId);
+
+    const std::int64_t recordingId = addRecording(channel, streamId, sessionId, 0, 0);
+    Recording& recording = catalog_[recordingId];
+    recording.subscriptionId = subscriptionId;
+    recording.isActive = true;
+
+    sendRecordingStarted(recording);
+    sendResponse(session, correlationId, subscriptionId, codecs::ControlResponseCode::OK);
+}
+
+void MockArchive::onStopRecording(Session& session, std::int64_t correlationId, std::int64_t subscriptionId) {
+    if (recordingSubscriptions_.erase(subscriptionId) == 0) {
+        sendResponse(session, correlationId, subscriptionId, codecs::ControlResponseCode::SUBSCRIPTION_UNKNOWN,
+                     "no recording subscription found for subscriptionId=" + std::to_string(subscriptionId));
+        return;
+    }
+
+    for (Recording& recording : catalog_) {
+        if (recording.isActive && recording.subscriptionId == subscriptionId) {
+            recording.isActive = false;
+            recording.subscriptionId = NULL_VALUE;
+            recording.stopTimestamp = epochMs();
+            sendRecordingStopped(recording);
+        }
+    }
+
+    sendResponse(session, correlationId, 0, codecs::ControlResponseCode::OK);
+}
+
+void MockArchive::onReplay(Session& session, std::int64_t correlationId, std::int64_t recordingId) {
+    if (!findRecording(recordingId)) {
+        sendResponse(session, correlationId, NULL_VALUE, codecs::ControlResponseCode::ERROR,
+                     "unknown recording id: " + std::to_string(recordingId));
+        return;
+    }
+
+    const std::int64_t replaySessionId = nextId_++;
+    replays_.insert(replaySessionId);
+
+    sendResponse(session, correlationId, replaySessionId, codecs::ControlResponseCode::OK);
+}
+
+void MockArchive::onStopReplay(Session& session, std::int64_t correlationId, std::int64_t replaySessionId) {
+    if (replays_.erase(replaySessionId) == 0) {
+        sendResponse(session, correlationId, NULL_VALUE, codecs::ControlResponseCode::ERROR,
+                     "replay session not known: id=" + std::to_string(replaySessionId));
+        return;
+    }
+
+    sendResponse(session, correlationId, 0, codecs::ControlResponseCode::OK);
+}
+
+void MockArchive::onListRecordings(Session& session, std::int64_t correlationId, std::int64_t fromRecordingId,
+                                   std::int32_t recordCount, const std::string& channelFragment,
+                                   std::int32_t streamId, bool isFiltered) {
+    const std::int64_t catalogSize = static_cast<std::int64_t>(catalog_.size());
+    std::int32_t sentCount = 0;
+
+    for (std::int64_t recordingId = std::max<std::int64_t>(fromRecordingId, 0);
+         recordingId < catalogSize && sentCount < recordCount; ++recordingId) {
+        const Recording& recording = catalog_[recordingId];
+
+        if (!isFiltered ||
+            (recording.streamId == streamId && recording.channel.find(channelFragment) != std::string::npos)) {
+            sendDescriptor(session, correlationId, recording);
+            ++sentCount;
+        }
+    }
+
+    // fewer descriptors than asked for tells the client the listing is complete
+    if (sentCount < recordCount) {
+        sendResponse(session, correlationId, fromRecordingId, codecs::ControlResponseCode::RECORDING_UNKNOWN);
+    }
+}
+
+void MockArchive::onExtendRecording(Session& session, std::int64_t correlationId, const std::string& channel,
+                                    std::int32_t streamId, std::int64_t recordingId) {
+    Recording* recording = findRecording(recordingId);
+
+    if (!recording || recording->isActive || recording->streamId != streamId) {
+        sendResponse(session, correlationId, NULL_VALUE, codecs::ControlResponseCode::ERROR,
+                     "cannot extend recording id: " + std::to_string(recordingId));
+        return;
+    }
+
+    recording->subscriptionId = addSubscription(channel, streamId);
+    recording->isActive = true;
+
+    sendRecordingStarted(*recording);
+    sendResponse(session, correlationId, recording->subscriptionId, codecs::ControlResponseCode::OK);
+}
+
+void MockArchive::onTruncateRecording(Session& session, std::int64_t correlationId, std::int64_t recordingId,
+                                      std::int64_t position) {
+    Recording* recording = findRecording(recordingId);
+
+    if (!recording || recording->isActive || position < recording->startPosition ||
+        position > recording->stopPosition) {
+        sendResponse(session, correlationId, NULL_VALUE, codecs::ControlResponseCode::ERROR,
+                     "cannot truncate recording id: " + std::to_string(recordingId) +
+                         " to position: " + std::to_string(position));
+        return;
+    }
+
+    recording->stopPosition = position;
+
+    sendResponse(session, correlationId, 0, codecs::ControlResponseCode::OK);
+}
+
+void MockArchive::onFindLastMatchingRecording(Session& session, std::int64_t correlationId,
+                                              std::int64_t minRecordingId, const std::string& channelFragment,
+                                              std::int32_t streamId, std::int32_t sessionId) {
+    std::int64_t lastRecordingId = NULL_VALUE;
+
+    for (std::int64_t recordingId = static_cast<std::int64_t>(catalog_.size()) - 1;
+         recordingId >= std::max<std::int64_t>(minRecordingId, 0); --recordingId) {
+        const Recording& recording = catalog_[recordingId];
+
+        if (recording.sessionId == sessionId && recording.streamId == streamId &&
+            recording.channel.find(channelFragment) != std::string::npos) {
+            lastRecordingId = recordingId;
+            break;
+        }
+    }
+
+    sendResponse(session, correlationId, lastRecordingId, codecs::ControlResponseCode::OK);
+}
+
+MockArchive::Recording* MockArchive::findRecording(std::int64_t recordingId) {
+    if (recordingId < 0 || recordingId >= static_cast<std::int64_t>(catalog_.size())) {
+        return nullptr;
+    }
+
+    return &catalog_[recordingId];
+}
+
+std::int64_t MockArchive::subscriptionIdFor(const std::string& channel, std::int32_t streamId) const {
+    for (const auto& subscription : recordingSubscriptions_) {
+        if (subscription.second.first == channel && subscription.second.second == streamId) {
+            return subscription.first;
+        }
+    }
+
+    return NULL_VALUE;
+}
+
+std::int64_t MockArchive::addSubscription(const std::string& channel, std::int32_t streamId) {
+    const std::int64_t subscriptionId = nextId_++;
+    recordingSubscriptions_.emplace(subscriptionId, std::make_pair(channel, streamId));
+
+    return subscriptionId;
+}
+
+template <typename T>
+T& MockArchive::wrapAndApplyHeader(T& msg) {
+    codecs::MessageHeader hdr;
+
+    hdr.wrap((char*)buffer_.buffer(), 0, 0, buffer_.capacity())
+        .blockLength(T::sbeBlockLength())
+        .templateId(T::sbeTemplateId())
+        .schemaId(T::sbeSchemaId())
+        .version(T::sbeSchemaVersion());
+
+    return msg.wrapForEncode((char*)buffer_.buffer(), hdr.encodedLength(), buffer_.capacity());
+}
+
+void MockArchive::sendResponse(Session& session, std::int64_t correlationId, std::int64_t relevantId,
+                               codecs::ControlResponseCode::Value code, const std::string& errorMessage) {
+    codecs::ControlResponse msg;
+
+    wrapAndApplyHeader(msg)
+        .controlSessionId(session.controlSessionId)
+        .correlationId(correlationId)
+        .relevantId(relevantId)
+        .code(code)
+        .putErrorMessage(errorMessage);
+
+    send(*session.publication, codecs::MessageHeader::encodedLength() + msg.encodedLength());
+}
+
+void MockArchive::sendDescriptor(Session& session, std::int64_t correlationId, const Recording& recording) {
+    codecs::RecordingDescriptor msg;
+
+    wrapAndApplyHeader(msg)
+        .controlSessionId(session.controlSessionId)
+        .correlationId(correlationId)
+        .recordingId(recording.recordingId)
+        .startTimestamp(recording.startTimestamp)
+        .stopTimestamp(recording.isActive ? NULL_VALUE : recording.stopTimestamp)
+        .startPosition(recording.startPosition)
+        .stopPosition(recording.isActive ? NULL_POSITION : recording.stopPosition)
+        .initialTermId(0)
+        .segmentFileLength(SEGMENT_FILE_LENGTH)
+        .termBufferLength(TERM_BUFFER_LENGTH)
+        .mtuLength(MTU_LENGTH)
+        .sessionId(recording.sessionId)
+        .streamId(recording.streamId)
+        .putStrippedChannel(recording.channel)
+        .putOriginalChannel(recording.channel)
+        .putSourceIdentity(SOURCE_IDENTITY);
+
+    send(*session.publication, codecs::MessageHeader::encodedLength() + msg.encodedLength());
+}
+
+void MockArchive::sendRecordingStarted(const Recording& recording) {
+    codecs::RecordingStarted msg;
+
+    wrapAndApplyHeader(msg)
+        .recordingId(recording.recordingId)
+        .startPosition(recording.startPosition)
+        .sessionId(recording.sessionId)
+        .streamId(recording.streamId)
+        .putChannel(recording.channel)
+        .putSourceIdentity(SOURCE_IDENTITY);
+
+    sendEvent(codecs::MessageHeader::encodedLength() + msg.encodedLength());
+}
+
+void MockArchive::sendRecordingStopped(const Recording& recording) {
+    codecs::RecordingStopped msg;
+
+    wrapAndApplyHeader(msg)
+        .recordingId(recording.recordingId)
+        .startPosition(recording.startPosition)
+        .stopPosition(recording.stopPosition);
+
+    sendEvent(codecs::MessageHeader::encodedLength() + msg.encodedLength());
+}
+
+void MockArchive::send(ExclusivePublication& publication, util::index_t length) {
+    // a client which is gone is not waited for, its session stays until the mock stops
+    for (std::int32_t attempt = 0; attempt < SEND_ATTEMPTS; ++attempt) {
+        const std::int64_t result = publication.offer(buffer_, 0, length);
+        if (result > 0 || result == NOT_CONNECTED || result == PUBLICATION_CLOSED || result == MAX_POSITION_EXCEEDED) {
+            return;
+        }
+
+        idle_.idle();
+    }
+}
+
+void MockArchive::sendEvent(util::index_t length) {
+    // like the archive, events are dropped when nobody listens
+    eventsPublication_->offer(buffer_, 0, length);
+}
+
+}  // namespace archive
+}  // namespace aeron
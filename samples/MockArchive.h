@@ -0,0 +1,186 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <Aeron.h>
+#include <FragmentAssembler.h>
+#include <concurrent/YieldingIdleStrategy.h>
+
+#include <Context.h>
+
+#include "io_aeron_archive_codecs/ControlResponseCode.h"
+#include "io_aeron_archive_codecs/MessageHeader.h"
+
+namespace aeron {
+namespace archive {
+
+// A stand-in for the archive control plane which runs against a local media driver. It subscribes to the
+// control request channel, answers every request ArchiveProxy sends from an in-memory catalog and emits
+// recording events. Responses can be delayed, failed or dropped to exercise the client timeout and error paths.
+// Recordings have positions but no data and replays are acknowledged without a replay stream, so only the
+// control plane is exercised.
+// Configuration and catalog calls are expected before start(), all other work happens on the mock's own thread
+// or on the thread calling doWork().
+class MockArchive {
+public:
+    // stopPosition holds the recorded position while the recording is active
+    struct Recording {
+        std::int64_t recordingId;
+        std::int64_t startTimestamp;
+        std::int64_t stopTimestamp;
+        std::int64_t startPosition;
+        std::int64_t stopPosition;
+        std::int32_t sessionId;
+        std::int32_t streamId;
+        std::string channel;
+        std::int64_t subscriptionId;
+        bool isActive;
+    };
+
+    explicit MockArchive(const Context& ctx);
+    ~MockArchive();
+
+    MockArchive(const MockArchive&) = delete;
+    MockArchive& operator=(const MockArchive&) = delete;
+
+    // every request is answered this long after it was received
+    MockArchive& responseDelay(std::chrono::nanoseconds delay);
+    // fraction of session requests answered with an ERROR response
+    MockArchive& errorRate(double rate);
+    // fraction of session requests which are never answered
+    MockArchive& dropRate(double rate);
+    MockArchive& seed(std::uint64_t seed);
+
+    // adds a stopped recording to the catalog, returns its recording id
+    std::int64_t addRecording(const std::string& channel, std::int32_t streamId, std::int32_t sessionId,
+                              std::int64_t startPosition, std::int64_t stopPosition);
+    void addRecordings(std::int32_t count, const std::string& channel, std::int32_t streamId, std::int64_t length);
+
+    std::int32_t doWork();
+
+    // runs doWork() on a dedicated thread until stop()
+    void start();
+    void stop();
+
+    std::int64_t requestCount() const;
+    std::int64_t errorCount() const;
+    std::int64_t droppedCount() const;
+    std::int32_t recordingCount() const;
+
+private:
+    using Clock = std::chrono::high_resolution_clock;
+
+    struct Session {
+        std::int64_t controlSessionId;
+        std::shared_ptr<aeron::ExclusivePublication> publication;
+    };
+
+    struct PendingRequest {
+        Clock::time_point due;
+        std::vector<std::uint8_t> bytes;
+    };
+
+    void onFragment(aeron::concurrent::AtomicBuffer& buffer, aeron::util::index_t offset,
+                    aeron::util::index_t length, aeron::Header& header);
+    void onRequest(aeron::concurrent::AtomicBuffer& buffer);
+
+    template <typename T, typename Handler>
+    void dispatch(aeron::concurrent::AtomicBuffer& buffer, io::aeron::archive::codecs::MessageHeader& hdr,
+                  Handler&& handler);
+
+    void onConnect(std::int64_t correlationId, std::int32_t responseStreamId, const std::string& responseChannel);
+    void onListRecording(Session& session, std::int64_t correlationId, std::int64_t recordingId);
+    void onRecordingPosition(Session& session, std::int64_t correlationId, std::int64_t recordingId);
+    void onStopPosition(Session& session, std::int64_t correlationId, std::int64_t recordingId);
+    void onStartRecording(Session& session, std::int64_t correlationId, const std::string& channel,
+                          std::int32_t streamId);
+    void onStopRecording(Session& session, std::int64_t correlationId, std::int64_t subscriptionId);
+    void onReplay(Session& session, std::int64_t correlationId, std::int64_t recordingId);
+    void onStopReplay(Session& session, std::int64_t correlationId, std::int64_t replaySessionId);
+    void onListRecordings(Session& session, std::int64_t correlationId, std::int64_t fromRecordingId,
+                          std::int32_t recordCount, const std::string& channelFragment, std::int32_t streamId,
+                          bool isFiltered);
+    void onExtendRecording(Session& session, std::int64_t correlationId, const std::string& channel,
+                           std::int32_t streamId, std::int64_t recordingId);
+    void onTruncateRecording(Session& session, std::int64_t correlationId, std::int64_t recordingId,
+                             std::int64_t position);
+    void onFindLastMatchingRecording(Session& session, std::int64_t correlationId, std::int64_t minRecordingId,
+                                     const std::string& channelFragment, std::int32_t streamId,
+                                     std::int32_t sessionId);
+
+    Recording* findRecording(std::int64_t recordingId);
+    std::int64_t subscriptionIdFor(const std::string& channel, std::int32_t streamId) const;
+    std::int64_t addSubscription(const std::string& channel, std::int32_t streamId);
+
+    void sendResponse(Session& session, std::int64_t correlationId, std::int64_t relevantId,
+                      io::aeron::archive::codecs::ControlResponseCode::Value code,
+                      const std::string& errorMessage = "");
+    void sendDescriptor(Session& session, std::int64_t correlationId, const Recording& recording);
+    void sendRecordingStarted(const Recording& recording);
+    void sendRecordingStopped(const Recording& recording);
+    void send(aeron::ExclusivePublication& publication, aeron::util::index_t length);
+    void sendEvent(aeron::util::index_t length);
+
+    template <typename T>
+    T& wrapAndApplyHeader(T& msg);
+
+private:
+    Context ctx_;
+    std::shared_ptr<aeron::Aeron> aeron_;
+    std::shared_ptr<aeron::Subscription> requestSubscription_;
+    std::shared_ptr<aeron::ExclusivePublication> eventsPublication_;
+    aeron::FragmentAssembler fragmentAssembler_;
+    aeron::fragment_handler_t fragmentHandler_;
+
+    std::array<std::uint8_t, 4096> underlyingBuffer_;
+    aeron::concurrent::AtomicBuffer buffer_;
+    aeron::concurrent::YieldingIdleStrategy idle_;
+
+    std::unordered_map<std::int64_t, Session> sessions_;
+    std::deque<PendingRequest> pending_;
+    std::vector<Recording> catalog_;
+    std::unordered_map<std::int64_t, std::pair<std::string, std::int32_t>> recordingSubscriptions_;
+    std::unordered_set<std::int64_t> replays_;
+    std::int64_t nextId_{1};
+    std::int32_t nextSessionId_{1};
+
+    std::chrono::nanoseconds responseDelay_{0};
+    double errorRate_{0.0};
+    double dropRate_{0.0};
+    std::mt19937_64 random_;
+    std::uniform_real_distribution<double> uniform_{0.0, 1.0};
+
+    std::atomic<std::int64_t> requestCount_{0};
+    std::atomic<std::int64_t> errorCount_{0};
+    std::atomic<std::int64_t> droppedCount_{0};
+
+    std::atomic<bool> isRunning_{false};
+    std::thread thread_;
+};
+
+}  // namespace archive
+}  // namespace aeron
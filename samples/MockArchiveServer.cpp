@@ -0,0 +1,108 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <signal.h>
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+#include <boost/program_options.hpp>
+
+#include <ArchiveException.h>
+#include <Configuration.h>
+
+#include "MockArchive.h"
+
+namespace po = boost::program_options;
+
+using namespace aeron;
+
+namespace {
+
+std::atomic<bool> running{true};
+
+void sigIntHandler(int) { running = false; }
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::string configFile, channel;
+    std::int32_t streamId, recordings;
+    std::int64_t recordingLength, delayUs;
+    double errorRate, dropRate;
+
+    po::options_description desc("Options");
+    desc.add_options()("help", "print help message")(
+        "channel,c", po::value<std::string>(&channel)->default_value("aeron:udp?endpoint=localhost:40123"),
+        "channel of the catalog recordings")("stream-id,i", po::value<std::int32_t>(&streamId)->default_value(10))(
+        "recordings,n", po::value<std::int32_t>(&recordings)->default_value(1000), "catalog size")(
+        "recording-length", po::value<std::int64_t>(&recordingLength)->default_value(1024 * 1024))(
+        "delay-us", po::value<std::int64_t>(&delayUs)->default_value(0), "response delay in microseconds")(
+        "error-rate", po::value<double>(&errorRate)->default_value(0.0), "fraction of requests failed")(
+        "drop-rate", po::value<double>(&dropRate)->default_value(0.0), "fraction of requests not answered")(
+        "file,f", po::value<std::string>(&configFile));
+
+    try {
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << desc << '\n';
+            return 1;
+        }
+
+        ::signal(SIGINT, sigIntHandler);
+
+        std::unique_ptr<aeron::archive::Configuration> cfg;
+
+        if (!configFile.empty()) {
+            cfg = std::make_unique<aeron::archive::Configuration>(configFile);
+        } else {
+            cfg = std::make_unique<aeron::archive::Configuration>();
+        }
+
+        aeron::archive::Context ctx(*cfg);
+        aeron::archive::MockArchive archive(ctx);
+
+        archive.responseDelay(std::chrono::microseconds(delayUs)).errorRate(errorRate).dropRate(dropRate);
+        archive.addRecordings(recordings, channel, streamId, recordingLength);
+        archive.start();
+
+        std::cout << "mock archive listening on " << ctx.controlRequestChannel() << ":" << ctx.controlRequestStreamId()
+                  << " with " << archive.recordingCount() << " recordings\n";
+
+        while (running) {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+
+        archive.stop();
+
+        std::cout << "requests: " << archive.requestCount() << ", injected errors: " << archive.errorCount()
+                  << ", dropped: " << archive.droppedCount() << '\n';
+    } catch (const archive::ArchiveException& e) {
+        std::cerr << "aeron archive exception: " << e.what() << " (" << e.where() << ")\n";
+        return 1;
+    } catch (const util::SourcedException& e) {
+        std::cerr << "aeron exception: " << e.what() << " (" << e.where() << ")\n";
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "exception: " << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
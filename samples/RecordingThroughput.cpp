@@ -17,211 +17,319 @@
 #include <signal.h>
 #include <atomic>
 #include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
 #include <vector>
 
 #include <boost/program_options.hpp>
 
 #include <AeronArchive.h>
-#include <RecordingEventsAdapter.h>
-#include <concurrent/YieldingIdleStrategy.h>
+#include <LatencyHistogram.h>
+#include <RecordingAckTracker.h>
 
 namespace archive = aeron::archive;
 namespace codecs = io::aeron::archive::codecs;
 namespace po = boost::program_options;
 
 namespace {
-const int FRAGMENTS_LIMIT = 10;
 const double MEGABYTE = 1024.0 * 1024.0;
+const std::chrono::seconds RECORDING_TIMEOUT(30);
+const double LAG_PERCENTILES[] = {50.0, 99.0, 99.9};
 
 std::atomic<bool> running{true};
 
 void sigIntHandler(int) { running = false; }
 
-auto now() { return std::chrono::high_resolution_clock::now(); }
+using Clock = std::chrono::high_resolution_clock;
+
+double toSeconds(Clock::duration duration) { return std::chrono::duration<double>(duration).count(); }
+
+// every length must fit the sequence number stamped into a message and a single frame of the publication
+std::vector<std::int32_t> parseLengths(const std::string& lengths, std::int32_t maxLength) {
+    const std::int32_t minLength = sizeof(std::int32_t);
+    std::vector<std::int32_t> result;
+    std::istringstream in(lengths);
+    std::string length;
+
+    while (std::getline(in, length, ',')) {
+        const std::int32_t value = std::stoi(length);
+        if (value < minLength || value > maxLength) {
+            throw std::invalid_argument("message length " + length + " is outside " + std::to_string(minLength) +
+                                        ".." + std::to_string(maxLength));
+        }
+        result.push_back(value);
+    }
+
+    return result;
+}
+
+struct IterationResult {
+    std::int32_t messageLength;
+    std::int32_t iteration;
+    std::int64_t messages;
+    std::int64_t bytes;
+    // until every message is published, and until it is also recorded
+    double publishSeconds;
+    double recordSeconds;
+    // bytes published but not yet recorded, sampled while publishing
+    archive::LatencySnapshot lag;
+
+    double messagesPerSecond() const { return publishSeconds > 0 ? messages / publishSeconds : 0.0; }
+    double publishedMegabytesPerSecond() const { return publishSeconds > 0 ? bytes / MEGABYTE / publishSeconds : 0.0; }
+    double recordedMegabytesPerSecond() const { return recordSeconds > 0 ? bytes / MEGABYTE / recordSeconds : 0.0; }
+};
 
 }  // namespace
 
-//
+// Publishers on their own threads spread over a number of recorded streams, the recorded position of every
+// publication is followed through its RecordingPos counter to sample how far the recording lags behind.
 class RecordingThroughput {
 public:
     RecordingThroughput(const archive::Configuration& cfg, const std::string& channel, std::int32_t streamId,
-                        std::int32_t numberOfMessages, std::int32_t messageLength, bool disableRecording)
+                        std::int32_t streamCount, std::int32_t publisherCount, bool disableRecording,
+                        std::chrono::microseconds sampleInterval)
         : disableRecording_(disableRecording)
         , ctx_(cfg)
         , archive_(archive::AeronArchive::connect(ctx_))
         , aeron_(archive_->context().aeron())
         , channel_(channel)
         , streamId_(streamId)
-        , numberOfMessages_(numberOfMessages)
-        , messageLength_(messageLength)
-        , recordingThread_([this] {
-            if (!disableRecording_) {
-                runRecordingEventsPoller();
+        , streamCount_(streamCount)
+        , sampleInterval_(sampleInterval) {
+        if (!disableRecording_) {
+            for (std::int32_t i = 0; i < streamCount_; ++i) {
+                archive_->startRecording(channel_, streamId_ + i, codecs::SourceLocation::LOCAL);
             }
-        }) {}
+            std::cout << "started recording of " << channel_ << " streams " << streamId_ << ".."
+                      << streamId_ + streamCount_ - 1 << '\n';
+        }
 
-    ~RecordingThroughput() {
-        recordingThread_.join();
-        stopRecording();
+        for (std::int32_t i = 0; i < publisherCount; ++i) {
+            addPublisher(streamId_ + i % streamCount_);
+        }
+
+        samplingThread_ = std::thread([this] { sampleLag(); });
     }
 
-    void startRecording() {
-        if (!disableRecording_) {
-            archive_->startRecording(channel_, streamId_, codecs::SourceLocation::LOCAL);
-            std::cout << "started recording of " << channel_ << ":" << streamId_ << '\n';
-        }
+    ~RecordingThroughput() {
+        isSampling_ = false;
+        isRunning_ = false;
+        samplingThread_.join();
     }
 
     void stopRecording() {
         if (!disableRecording_) {
-            archive_->stopRecording(channel_, streamId_);
-            std::cout << "stopped recording of " << channel_ << ":" << streamId_ << '\n';
+            for (std::int32_t i = 0; i < streamCount_; ++i) {
+                archive_->stopRecording(channel_, streamId_ + i);
+            }
+            std::cout << "stopped recording of " << channel_ << '\n';
         }
     }
 
-    void streamMessagesForRecording() {
-        std::shared_ptr<aeron::ExclusivePublication> publication;
+    std::int32_t maxPayloadLength() const { return publishers_.front().publication->maxPayloadLength(); }
 
-        std::int64_t pubId = aeron_->addExclusivePublication(channel_, streamId_);
-        while (!(publication = aeron_->findExclusivePublication(pubId))) {
-            std::this_thread::yield();
-        }
+    IterationResult run(std::int32_t messagesPerPublisher, std::int32_t messageLength) {
+        lag_.reset();
+        isSampling_ = true;
 
-        isRecording_ = true;
-        stopPosition_ = std::numeric_limits<std::int64_t>::max();
-        recordingStartTime_ = now();
+        const auto start = Clock::now();
 
-        std::vector<std::uint8_t> buffer(messageLength_);
-        aeron::concurrent::AtomicBuffer bufferWrap(&buffer[0], messageLength_);
+        std::vector<std::thread> threads;
+        for (auto& publisher : publishers_) {
+            threads.emplace_back(
+                [&publisher, messagesPerPublisher, messageLength] {
+                    publish(*publisher.publication, messagesPerPublisher, messageLength);
+                });
+        }
 
-        std::cout << "publishing " << numberOfMessages_ << " messages...\n";
+        for (auto& thread : threads) {
+            thread.join();
+        }
 
-        auto start = now();
+        const auto published = Clock::now();
 
-        for (std::int32_t i = 0; i < numberOfMessages_; ++i) {
-            bufferWrap.putInt32(0, 'a' + i % ('z' - 'a'));
-            while (publication->offer(bufferWrap, 0, messageLength_) < 0) {
-                std::this_thread::yield();
+        for (auto& publisher : publishers_) {
+            if (publisher.tracker &&
+                !publisher.tracker->awaitRecorded(publisher.publication->position(), RECORDING_TIMEOUT)) {
+                throw std::runtime_error("recording of session " +
+                                         std::to_string(publisher.publication->sessionId()) + " did not catch up");
             }
         }
 
-        stopPosition_ = publication->position();
+        const auto recorded = Clock::now();
+        isSampling_ = false;
 
-        std::int64_t durationMs = std::chrono::duration_cast<std::chrono::milliseconds>(now() - start).count();
-        std::int64_t msgRate = (numberOfMessages_ / durationMs) * 1000;
+        const std::int64_t messages = static_cast<std::int64_t>(messagesPerPublisher) * publishers_.size();
 
-        std::cout << "all messages are published. Stop position: " << stopPosition_ << ", msg rate = " << msgRate
-                  << " msg/sec\n";
-
-        while (!disableRecording_ && isRecording_) {
-            ::sleep(1);
-        }
+        return IterationResult{messageLength,
+                               0,
+                               messages,
+                               messages * messageLength,
+                               toSeconds(published - start),
+                               disableRecording_ ? 0.0 : toSeconds(recorded - start),
+                               lag_.snapshotAndReset()};
     }
 
 private:
-    void runRecordingEventsPoller() {
-        std::cout << "polling thread started\n";
-
-        try {
-            std::int64_t id = aeron_->addSubscription(ctx_.recordingEventsChannel(), ctx_.recordingEventsStreamId());
-
-            std::shared_ptr<aeron::Subscription> subscription;
-            while (!(subscription = aeron_->findSubscription(id))) {
-                std::this_thread::yield();
-            }
-
-            aeron::concurrent::YieldingIdleStrategy idleStrategy;
-            archive::RecordingEventsAdapter adapter(subscription, FRAGMENTS_LIMIT, OnStartHandler(),
-                                                    OnProgressHandler(), OnStopHandler());
+    struct Publisher {
+        std::shared_ptr<aeron::ExclusivePublication> publication;
+        // null when recording is disabled
+        std::unique_ptr<archive::RecordingAckTracker> tracker;
+    };
 
-            std::cout << "listening for recording events on " << ctx_.recordingEventsChannel() << ":"
-                      << ctx_.recordingEventsStreamId() << '\n';
+    void addPublisher(std::int32_t streamId) {
+        std::shared_ptr<aeron::ExclusivePublication> publication;
 
-            while (running) {
-                idleStrategy.idle(adapter.poll());
-            }
-        } catch (const archive::ArchiveException& e) {
-            std::cerr << "aeron archive exception: " << e.what() << " (" << e.where() << ")\n" << '\n';
-        } catch (const aeron::util::SourcedException& e) {
-            std::cerr << "aeron exception: " << e.what() << " (" << e.where() << ")\n";
-        } catch (const std::exception& e) {
-            std::cerr << "exception: " << e.what() << '\n';
-        } catch (...) {
-            std::cerr << "unknown exception\n";
+        std::int64_t pubId = aeron_->addExclusivePublication(channel_, streamId);
+        while (!(publication = aeron_->findExclusivePublication(pubId))) {
+            std::this_thread::yield();
         }
 
-        std::cout << "polling thread completed\n";
-    }
+        Publisher publisher{publication, nullptr};
+        if (!disableRecording_) {
+            publisher.tracker = std::make_unique<archive::RecordingAckTracker>(archive_, publication->sessionId());
+        }
 
-    archive::RecordingEventsAdapter::OnStart OnStartHandler() {
-        return [this](std::int64_t recordingId, std::int64_t startPosition, std::int32_t sessionId,
-                      std::int32_t streamId, const std::string& channel, const std::string& sourceIdentity) {
-            std::cout << "Recording #" << recordingId << " started for " << channel << ":" << streamId << ":"
-                      << sessionId << " from " << startPosition << " position\n";
-        };
+        publishers_.push_back(std::move(publisher));
     }
 
-    archive::RecordingEventsAdapter::OnProgress OnProgressHandler() {
-        return [this](std::int64_t recordingId, std::int64_t startPosition, std::int64_t position) {
-            if (position >= stopPosition_) {
-                std::int64_t durationMs =
-                    std::chrono::duration_cast<std::chrono::milliseconds>(now() - recordingStartTime_).count();
-                std::int64_t recordingLength = position - startPosition;
-                double dataRate = (recordingLength * 1000.0 / durationMs) / MEGABYTE;
-                double recordingMb = recordingLength / MEGABYTE;
-                std::int64_t msgRate = (numberOfMessages_ / durationMs) * 1000;
-
-                std::cout << "Published and recorded " << recordingMb << " MB @ " << dataRate << " MB/s - " << msgRate
-                          << " msg/sec - " << messageLength_ << " byte payload + 32 byte header\n";
+    static void publish(aeron::ExclusivePublication& publication, std::int32_t messages, std::int32_t messageLength) {
+        std::vector<std::uint8_t> buffer(messageLength);
+        aeron::concurrent::AtomicBuffer bufferWrap(&buffer[0], messageLength);
 
-                isRecording_ = false;
+        for (std::int32_t i = 0; i < messages && running; ++i) {
+            bufferWrap.putInt32(0, i);
+            while (publication.offer(bufferWrap, 0, messageLength) < 0) {
+                if (!running) {
+                    return;
+                }
+                std::this_thread::yield();
             }
-        };
+        }
     }
 
-    archive::RecordingEventsAdapter::OnStop OnStopHandler() {
-        return [this](std::int64_t recordingId, std::int64_t startPosition, std::int64_t position) {
-            std::cout << "Recording #" << recordingId << " stopped at " << position << " position\n";
-            isRecording_ = false;
-        };
+    void sampleLag() {
+        while (isRunning_) {
+            if (isSampling_) {
+                for (auto& publisher : publishers_) {
+                    if (publisher.tracker) {
+                        const std::int64_t lag =
+                            publisher.publication->position() - publisher.tracker->recordedPosition();
+                        lag_.record(std::max<std::int64_t>(lag, 0));
+                    }
+                }
+            }
+
+            std::this_thread::sleep_for(sampleInterval_);
+        }
     }
 
 private:
-    bool disableRecording_;
+    const bool disableRecording_;
 
     archive::Context ctx_;
     std::shared_ptr<archive::AeronArchive> archive_;
     std::shared_ptr<aeron::Aeron> aeron_;
 
-    const std::string& channel_;
+    const std::string channel_;
     const std::int32_t streamId_;
-    const std::int32_t numberOfMessages_;
-    const std::int32_t messageLength_;
+    const std::int32_t streamCount_;
+    const std::chrono::microseconds sampleInterval_;
 
-    std::thread recordingThread_;
+    std::vector<Publisher> publishers_;
+    archive::LatencyHistogram lag_;
 
-    std::int64_t stopPosition_;
-    bool isRecording_{false};
-    decltype(now()) recordingStartTime_;
+    std::atomic<bool> isRunning_{true};
+    std::atomic<bool> isSampling_{false};
+    std::thread samplingThread_;
 };
 
+namespace {
+
+void printResult(const IterationResult& result) {
+    std::cout << std::fixed << std::setprecision(1) << result.messageLength << " bytes #" << result.iteration << ": "
+              << result.messages << " msgs in " << result.publishSeconds << " s - " << result.messagesPerSecond()
+              << " msg/s, published " << result.publishedMegabytesPerSecond() << " MB/s, recorded "
+              << result.recordedMegabytesPerSecond() << " MB/s, lag p50/p99/p99.9/max "
+              << result.lag.valueAtPercentile(50.0) << "/" << result.lag.valueAtPercentile(99.0) << "/"
+              << result.lag.valueAtPercentile(99.9) << "/" << result.lag.maxValue << " bytes\n";
+}
+
+void writeCsv(const std::string& file, const std::vector<IterationResult>& results, std::int32_t publishers,
+              std::int32_t streams) {
+    std::ofstream out(file);
+    out << "publishers,streams,message_length,iteration,messages,bytes,publish_s,record_s,msgs_per_s,"
+           "published_mb_per_s,recorded_mb_per_s,lag_p50,lag_p99,lag_p999,lag_max\n";
+
+    for (const auto& result : results) {
+        out << publishers << ',' << streams << ',' << result.messageLength << ',' << result.iteration << ','
+            << result.messages << ',' << result.bytes << ',' << result.publishSeconds << ',' << result.recordSeconds
+            << ',' << result.messagesPerSecond() << ',' << result.publishedMegabytesPerSecond() << ','
+            << result.recordedMegabytesPerSecond();
+        for (double percentile : LAG_PERCENTILES) {
+            out << ',' << result.lag.valueAtPercentile(percentile);
+        }
+        out << ',' << result.lag.maxValue << '\n';
+    }
+}
+
+void writeJson(const std::string& file, const std::vector<IterationResult>& results, std::int32_t publishers,
+               std::int32_t streams) {
+    std::ofstream out(file);
+    out << "{\"publishers\": " << publishers << ", \"streams\": " << streams << ", \"results\": [";
+
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+        out << (i == 0 ? "\n" : ",\n") << "  {\"messageLength\": " << result.messageLength
+            << ", \"iteration\": " << result.iteration << ", \"messages\": " << result.messages
+            << ", \"bytes\": " << result.bytes << ", \"publishSeconds\": " << result.publishSeconds
+            << ", \"recordSeconds\": " << result.recordSeconds
+            << ", \"messagesPerSecond\": " << result.messagesPerSecond()
+            << ", \"publishedMegabytesPerSecond\": " << result.publishedMegabytesPerSecond()
+            << ", \"recordedMegabytesPerSecond\": " << result.recordedMegabytesPerSecond()
+            << ", \"lagBytes\": {\"p50\": " << result.lag.valueAtPercentile(50.0)
+            << ", \"p99\": " << result.lag.valueAtPercentile(99.0)
+            << ", \"p99.9\": " << result.lag.valueAtPercentile(99.9) << ", \"max\": " << result.lag.maxValue << "}}";
+    }
+
+    out << "\n]}\n";
+}
+
+}  // namespace
+
 //
 int main(int argc, char* argv[]) {
     ::signal(SIGINT, sigIntHandler);
 
-    std::string channel, configFile;
-    std::int32_t streamId;
+    std::string channel, configFile, messageLengths, csvFile, jsonFile;
+    std::int32_t streamId, streamCount, publisherCount;
     std::int32_t numberOfMessages;
-    std::int32_t messageLength;
+    std::int32_t warmupIterations, iterations;
+    std::int64_t sampleIntervalUs;
     bool disableRecording;
 
     po::options_description desc("Options");
     desc.add_options()("help", "print help message")(
         "channel,c", po::value<std::string>(&channel)->default_value("aeron:udp?endpoint=localhost:40123"))(
-        "stream-id,i", po::value<std::int32_t>(&streamId)->default_value(10))(
-        "messages-count,m", po::value<std::int32_t>(&numberOfMessages)->default_value(1000000))(
-        "message-length,l", po::value<std::int32_t>(&messageLength)->default_value(256))(
+        "stream-id,i", po::value<std::int32_t>(&streamId)->default_value(10), "first of the recorded streams")(
+        "streams,s", po::value<std::int32_t>(&streamCount)->default_value(1))(
+        "publishers,p", po::value<std::int32_t>(&publisherCount)->default_value(1),
+        "publisher threads, spread over the streams")(
+        "messages-count,m", po::value<std::int32_t>(&numberOfMessages)->default_value(1000000),
+        "messages per publisher and iteration")(
+        "message-length,l", po::value<std::string>(&messageLengths)->default_value("256"),
+        "comma separated message lengths to sweep")(
+        "warmup,w", po::value<std::int32_t>(&warmupIterations)->default_value(1),
+        "iterations per message length which are not reported")(
+        "iterations,n", po::value<std::int32_t>(&iterations)->default_value(3),
+        "reported iterations per message length")(
+        "sample-interval-us", po::value<std::int64_t>(&sampleIntervalUs)->default_value(100),
+        "interval between recording lag samples")(
         "disable-recording,d", po::bool_switch(&disableRecording)->default_value(false))(
+        "csv", po::value<std::string>(&csvFile))("json", po::value<std::string>(&jsonFile))(
         "file,f", po::value<std::string>(&configFile));
 
     try {
@@ -234,6 +342,10 @@ int main(int argc, char* argv[]) {
             return 1;
         }
 
+        if (streamCount <= 0 || publisherCount <= 0) {
+            throw std::invalid_argument("streams and publishers must be positive");
+        }
+
         std::unique_ptr<archive::Configuration> cfg;
 
         if (!configFile.empty()) {
@@ -242,19 +354,33 @@ int main(int argc, char* argv[]) {
             cfg = std::make_unique<archive::Configuration>();
         }
 
-        RecordingThroughput test(*cfg, channel, streamId, numberOfMessages, messageLength, disableRecording);
-        char repeat;
+        RecordingThroughput test(*cfg, channel, streamId, streamCount, publisherCount, disableRecording,
+                                 std::chrono::microseconds(sampleIntervalUs));
+        std::vector<IterationResult> results;
+
+        for (std::int32_t messageLength : parseLengths(messageLengths, test.maxPayloadLength())) {
+            for (std::int32_t i = -warmupIterations; i < iterations && running; ++i) {
+                IterationResult result = test.run(numberOfMessages, messageLength);
+                result.iteration = i;
 
-        test.startRecording();
-        do {
-            test.streamMessagesForRecording();
+                if (i >= 0) {
+                    printResult(result);
+                    results.push_back(result);
+                }
+            }
+        }
 
-            std::cout << "repeat? [y/n]: ";
-            std::cin >> repeat;
-        } while (repeat == 'y');
+        test.stopRecording();
+
+        if (!csvFile.empty()) {
+            writeCsv(csvFile, results, publisherCount, streamCount);
+        }
+
+        if (!jsonFile.empty()) {
+            writeJson(jsonFile, results, publisherCount, streamCount);
+        }
 
         std::cout << "Shutting down...\n";
-        running = false;
     } catch (const archive::ArchiveException& e) {
         std::cerr << "aeron archive exception: " << e.what() << " (" << e.where() << ")\n" << '\n';
         return 1;
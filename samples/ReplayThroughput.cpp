@@ -0,0 +1,348 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <signal.h>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <AeronArchive.h>
+#include <FragmentAssembler.h>
+#include <LatencyHistogram.h>
+#include <RecordingAckTracker.h>
+#include <concurrent/YieldingIdleStrategy.h>
+
+#include "SamplesUtil.h"
+
+namespace archive = aeron::archive;
+namespace po = boost::program_options;
+
+namespace {
+const std::int32_t FRAGMENTS_LIMIT = 10;
+const double MEGABYTE = 1024.0 * 1024.0;
+const std::chrono::seconds RECORDING_TIMEOUT(30);
+
+std::atomic<bool> running{true};
+
+void sigIntHandler(int) { running = false; }
+
+using Clock = std::chrono::high_resolution_clock;
+
+std::int64_t toNanos(Clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+
+double toSeconds(Clock::duration duration) { return std::chrono::duration<double>(duration).count(); }
+
+struct RecordingRange {
+    std::int64_t recordingId;
+    std::int64_t startPosition;
+    std::int64_t stopPosition;
+};
+
+struct ReplayResult {
+    std::int64_t messages{0};
+    std::int64_t bytes{0};
+    // from the first to the last fragment
+    double streamSeconds{0.0};
+    std::int64_t stalls{0};
+};
+
+}  // namespace
+
+// Replays a stopped recording a number of times, optionally several replays at once, and measures the time from
+// asking for the replay to its first fragment, the sustained rate and the gaps between fragments.
+class ReplayThroughput {
+public:
+    ReplayThroughput(const std::shared_ptr<archive::AeronArchive>& aeronArchive, const RecordingRange& recording,
+                     const std::string& replayChannel, std::int32_t replayStreamId, std::chrono::nanoseconds stall)
+        : archive_(aeronArchive)
+        , recording_(recording)
+        , replayChannel_(replayChannel)
+        , replayStreamId_(replayStreamId)
+        , stall_(stall)
+        , timeout_(std::chrono::nanoseconds(archive_->context().messageTimeoutNs())) {}
+
+    void run(std::int32_t concurrentReplays) {
+        const auto start = Clock::now();
+
+        std::vector<ReplayResult> results(concurrentReplays);
+        std::vector<std::thread> threads;
+        for (auto& result : results) {
+            threads.emplace_back([this, &result] { replay(result); });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        if (failure_) {
+            std::rethrow_exception(failure_);
+        }
+
+        const double wallSeconds = toSeconds(Clock::now() - start);
+        std::int64_t messages = 0, bytes = 0, stalls = 0;
+        double slowestMegabytesPerSecond = 0.0;
+
+        for (const auto& result : results) {
+            messages += result.messages;
+            bytes += result.bytes;
+            stalls += result.stalls;
+
+            const double megabytesPerSecond =
+                result.streamSeconds > 0 ? result.bytes / MEGABYTE / result.streamSeconds : 0.0;
+            if (slowestMegabytesPerSecond == 0.0 || megabytesPerSecond < slowestMegabytesPerSecond) {
+                slowestMegabytesPerSecond = megabytesPerSecond;
+            }
+        }
+
+        std::cout << std::fixed << std::setprecision(1) << concurrentReplays << " replays of "
+                  << bytes / MEGABYTE / concurrentReplays << " MB in " << wallSeconds << " s - "
+                  << bytes / MEGABYTE / wallSeconds << " MB/s, " << messages / wallSeconds
+                  << " msg/s in total, slowest replay " << slowestMegabytesPerSecond << " MB/s, " << stalls
+                  << " stalls\n";
+    }
+
+    void report() {
+        std::cout << "time to first fragment: " << archive::latencySummary(timeToFirstFragment_.snapshot()) << '\n'
+                  << "gap between fragments:  " << archive::latencySummary(gaps_.snapshot()) << '\n';
+    }
+
+    void reset() {
+        timeToFirstFragment_.reset();
+        gaps_.reset();
+    }
+
+private:
+    void replay(ReplayResult& result) {
+        try {
+            const std::int64_t length = recording_.stopPosition - recording_.startPosition;
+            const auto requested = Clock::now();
+
+            auto subscription =
+                archive_->replay(recording_.recordingId, recording_.startPosition, length, replayChannel_,
+                                 replayStreamId_);
+
+            Clock::time_point first, last;
+            bool hasFirst = false, isDone = false;
+
+            aeron::FragmentAssembler fragmentAssembler(
+                [&](aeron::concurrent::AtomicBuffer& buffer, aeron::util::index_t offset,
+                    aeron::util::index_t messageLength, aeron::Header& header) {
+                    ++result.messages;
+                    result.bytes += messageLength;
+                    isDone = header.position() >= recording_.stopPosition;
+                });
+            auto handler = fragmentAssembler.handler();
+            aeron::concurrent::YieldingIdleStrategy idleStrategy;
+
+            while (!isDone && running) {
+                const std::int32_t fragments = subscription->poll(handler, FRAGMENTS_LIMIT);
+                const auto now = Clock::now();
+
+                if (fragments > 0) {
+                    if (!hasFirst) {
+                        hasFirst = true;
+                        first = now;
+                        timeToFirstFragment_.record(toNanos(now - requested));
+                    } else {
+                        const std::int64_t gapNs = toNanos(now - last);
+                        gaps_.record(gapNs);
+                        if (gapNs > stall_.count()) {
+                            ++result.stalls;
+                        }
+                    }
+                    last = now;
+                } else {
+                    if (now - (hasFirst ? last : requested) > timeout_) {
+                        throw archive::ArchiveException("replay of recordingId=" +
+                                                            std::to_string(recording_.recordingId) + " stalled",
+                                                        SOURCEINFO);
+                    }
+                    idleStrategy.idle();
+                }
+            }
+
+            result.streamSeconds = toSeconds(last - first);
+        } catch (...) {
+            std::unique_lock<std::mutex> lock(failureLock_);
+            if (!failure_) {
+                failure_ = std::current_exception();
+            }
+            running = false;
+        }
+    }
+
+private:
+    std::shared_ptr<archive::AeronArchive> archive_;
+    const RecordingRange recording_;
+    const std::string replayChannel_;
+    const std::int32_t replayStreamId_;
+    const std::chrono::nanoseconds stall_;
+    const std::chrono::nanoseconds timeout_;
+
+    archive::LatencyHistogram timeToFirstFragment_;
+    archive::LatencyHistogram gaps_;
+
+    std::mutex failureLock_;
+    std::exception_ptr failure_;
+};
+
+namespace {
+
+RecordingRange createRecording(const std::shared_ptr<archive::AeronArchive>& aeronArchive,
+                               const std::string& channel, std::int32_t streamId, std::int64_t size,
+                               std::int32_t messageLength) {
+    auto publication = aeronArchive->addRecordedExclusivePublication(channel, streamId);
+    archive::RecordingAckTracker tracker(aeronArchive, publication->sessionId());
+
+    std::vector<std::uint8_t> buffer(messageLength);
+    aeron::concurrent::AtomicBuffer bufferWrap(&buffer[0], messageLength);
+
+    std::cout << "recording " << size / MEGABYTE << " MB of " << messageLength << " byte messages...\n";
+
+    for (std::int32_t i = 0; publication->position() < size && running; ++i) {
+        bufferWrap.putInt32(0, i);
+        while (publication->offer(bufferWrap, 0, messageLength) < 0) {
+            if (!running) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    const std::int64_t stopPosition = publication->position();
+    if (!tracker.awaitRecorded(stopPosition, RECORDING_TIMEOUT)) {
+        throw std::runtime_error("recording did not reach position " + std::to_string(stopPosition));
+    }
+
+    aeronArchive->stopRecording(*publication);
+
+    return RecordingRange{tracker.recordingId(), 0, stopPosition};
+}
+
+RecordingRange findRecording(archive::AeronArchive& aeronArchive, std::int64_t recordingId) {
+    RecordingRange range{recordingId, -1, -1};
+
+    aeronArchive.listRecording(
+        recordingId, [&](std::int64_t controlSessionId, std::int64_t correlationId, std::int64_t recordingId,
+                         std::int64_t startTimestamp, std::int64_t stopTimestamp, std::int64_t startPosition,
+                         std::int64_t stopPosition, std::int32_t initialTermId, std::int32_t segmentFileLength,
+                         std::int32_t termBufferLength, std::int32_t mtuLength, std::int32_t sessionId,
+                         std::int32_t streamId, const std::string& strippedChannel,
+                         const std::string& originalChannel, const std::string& sourceIdentity) {
+            range.startPosition = startPosition;
+            range.stopPosition = stopPosition;
+        });
+
+    if (range.stopPosition == -1) {
+        throw std::runtime_error("recording " + std::to_string(recordingId) + " is unknown or still active");
+    }
+
+    return range;
+}
+
+}  // namespace
+
+//
+int main(int argc, char* argv[]) {
+    ::signal(SIGINT, sigIntHandler);
+
+    std::string channel, replayChannel, configFile;
+    std::int32_t streamId, replayStreamId, messageLength, concurrentReplays, iterations, warmupIterations;
+    std::int64_t recordingId, sizeMb, stallUs;
+
+    po::options_description desc("Options");
+    desc.add_options()("help", "print help message")(
+        "channel,c", po::value<std::string>(&channel)->default_value("aeron:udp?endpoint=localhost:40123"),
+        "channel recorded when no recording id is given")(
+        "stream-id,i", po::value<std::int32_t>(&streamId)->default_value(10))(
+        "recording-id", po::value<std::int64_t>(&recordingId)->default_value(-1),
+        "stopped recording to replay, a new one is recorded when not set")(
+        "size-mb", po::value<std::int64_t>(&sizeMb)->default_value(1024), "size of the new recording")(
+        "message-length,l", po::value<std::int32_t>(&messageLength)->default_value(256))(
+        "replay-channel", po::value<std::string>(&replayChannel)->default_value("aeron:udp?endpoint=localhost:40124"),
+        "e.g. aeron:ipc")("replay-stream-id", po::value<std::int32_t>(&replayStreamId)->default_value(100))(
+        "replays,k", po::value<std::int32_t>(&concurrentReplays)->default_value(1), "concurrent replays")(
+        "iterations,n", po::value<std::int32_t>(&iterations)->default_value(3))(
+        "warmup,w", po::value<std::int32_t>(&warmupIterations)->default_value(1))(
+        "stall-us", po::value<std::int64_t>(&stallUs)->default_value(1000),
+        "gap between fragments counted as a stall")("file,f", po::value<std::string>(&configFile));
+
+    try {
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << desc << '\n';
+            return 1;
+        }
+
+        // a message carries its int32 sequence number
+        if (messageLength < static_cast<std::int32_t>(sizeof(std::int32_t))) {
+            throw std::invalid_argument("message length must be at least " + std::to_string(sizeof(std::int32_t)));
+        }
+
+        std::unique_ptr<archive::Configuration> cfg;
+
+        if (!configFile.empty()) {
+            cfg = std::make_unique<archive::Configuration>(configFile);
+        } else {
+            cfg = std::make_unique<archive::Configuration>();
+        }
+
+        archive::Context ctx(*cfg);
+        auto aeronArchive = archive::AeronArchive::connect(ctx);
+
+        const RecordingRange recording =
+            recordingId == -1 ? createRecording(aeronArchive, channel, streamId, sizeMb * 1024 * 1024, messageLength)
+                              : findRecording(*aeronArchive, recordingId);
+
+        std::cout << "replaying recording " << recording.recordingId << " [" << recording.startPosition << ", "
+                  << recording.stopPosition << ") over " << replayChannel << '\n';
+
+        ReplayThroughput test(aeronArchive, recording, replayChannel, replayStreamId,
+                              std::chrono::microseconds(stallUs));
+
+        for (std::int32_t i = 0; i < warmupIterations && running; ++i) {
+            test.run(concurrentReplays);
+        }
+        test.reset();
+
+        for (std::int32_t i = 0; i < iterations && running; ++i) {
+            test.run(concurrentReplays);
+        }
+        test.report();
+    } catch (const archive::ArchiveException& e) {
+        std::cerr << "aeron archive exception: " << e.what() << " (" << e.where() << ")\n";
+        return 1;
+    } catch (const aeron::util::SourcedException& e) {
+        std::cerr << "aeron exception: " << e.what() << " (" << e.where() << ")\n";
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "exception: " << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -14,7 +14,13 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
 
 #include "SamplesUtil.h"
 
@@ -83,5 +89,103 @@ void findAllRecordingIds(aeron::archive::AeronArchive& archive) {
 
     archive.listRecordings(0, 100, consumer);
 }
+
+namespace {
+
+const double REPORTED_PERCENTILES[] = {50.0, 90.0, 99.0, 99.9, 99.99};
+const char* const REPORTED_PERCENTILE_NAMES[] = {"p50", "p90", "p99", "p99.9", "p99.99"};
+
+double toMicros(double nanos) { return nanos / 1000.0; }
+
+}  // namespace
+
+std::string latencySummary(const LatencySnapshot& snapshot) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1) << "count=" << snapshot.totalCount
+        << " mean=" << toMicros(snapshot.mean());
+
+    for (std::size_t i = 0; i < sizeof(REPORTED_PERCENTILES) / sizeof(REPORTED_PERCENTILES[0]); ++i) {
+        out << ' ' << REPORTED_PERCENTILE_NAMES[i] << '='
+            << toMicros(static_cast<double>(snapshot.valueAtPercentile(REPORTED_PERCENTILES[i])));
+    }
+
+    out << " max=" << toMicros(static_cast<double>(snapshot.maxValue)) << " us";
+    return out.str();
+}
+
+std::string latencyCsvHeader() {
+    std::ostringstream out;
+    out << "count,mean_us";
+
+    for (const char* name : REPORTED_PERCENTILE_NAMES) {
+        out << ',' << name << "_us";
+    }
+
+    out << ",max_us";
+    return out.str();
+}
+
+std::string latencyCsvRow(const LatencySnapshot& snapshot) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3) << snapshot.totalCount << ',' << toMicros(snapshot.mean());
+
+    for (double percentile : REPORTED_PERCENTILES) {
+        out << ',' << toMicros(static_cast<double>(snapshot.valueAtPercentile(percentile)));
+    }
+
+    out << ',' << toMicros(static_cast<double>(snapshot.maxValue));
+    return out.str();
+}
+
+std::ofstream appendCsv(const std::string& file, const std::string& header) {
+    std::ifstream existing(file);
+    const bool isNew = existing.peek() == std::ifstream::traits_type::eof();
+    existing.close();
+
+    std::ofstream csv(file, std::ios::app);
+    if (isNew) {
+        csv << header << '\n';
+    }
+
+    return csv;
+}
+
+std::vector<Operation> parseMix(const std::string& mix) {
+    const std::map<std::string, Operation> names{{"position", Operation::RECORDING_POSITION},
+                                                 {"list", Operation::LIST_RECORDING},
+                                                 {"replay", Operation::REPLAY},
+                                                 {"record", Operation::RECORD}};
+    std::vector<Operation> schedule;
+    std::istringstream in(mix);
+    std::string entry;
+
+    while (std::getline(in, entry, ',')) {
+        const auto separator = entry.find('=');
+        auto it = names.find(entry.substr(0, separator));
+        if (it == names.end() || separator == std::string::npos) {
+            throw std::invalid_argument("invalid mix entry: " + entry);
+        }
+
+        schedule.insert(schedule.end(), std::stoi(entry.substr(separator + 1)), it->second);
+    }
+
+    if (schedule.empty()) {
+        throw std::invalid_argument("empty operation mix: " + mix);
+    }
+
+    std::shuffle(schedule.begin(), schedule.end(), std::mt19937(42));
+    return schedule;
+}
+
+std::int32_t listRecording(AeronArchive& archive, std::int64_t recordingId) {
+    return archive.listRecording(
+        recordingId,
+        [](std::int64_t controlSessionId, std::int64_t correlationId, std::int64_t recordingId,
+           std::int64_t startTimestamp, std::int64_t stopTimestamp, std::int64_t startPosition,
+           std::int64_t stopPosition, std::int32_t initialTermId, std::int32_t segmentFileLength,
+           std::int32_t termBufferLength, std::int32_t mtuLength, std::int32_t sessionId, std::int32_t streamId,
+           const std::string& strippedChannel, const std::string& originalChannel,
+           const std::string& sourceIdentity) {});
+}
 }  // namespace archive
 }  // namespace aeron
@@ -16,7 +16,14 @@
 
 #pragma once
 
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
 #include <AeronArchive.h>
+#include <ArchiveException.h>
+#include <LatencyHistogram.h>
 
 namespace aeron {
 namespace archive {
@@ -35,5 +42,36 @@ std::int64_t findLatestRecordingId(aeron::archive::AeronArchive& archive, const
                                    std::int32_t streamId);
 
 void findAllRecordingIds(aeron::archive::AeronArchive& archive);
+
+// count, mean, p50, p90, p99, p99.9, p99.99 and max of a nanosecond snapshot in microseconds
+std::string latencySummary(const LatencySnapshot& snapshot);
+std::string latencyCsvHeader();
+std::string latencyCsvRow(const LatencySnapshot& snapshot);
+
+// opens the file for appending, the header line is written first when the file is new or empty
+std::ofstream appendCsv(const std::string& file, const std::string& header);
+
+// control calls measured by ControlLatency and ControlScalability
+enum class Operation { RECORDING_POSITION, LIST_RECORDING, REPLAY, RECORD };
+
+// parses "position=4,list=3,replay=2,record=1" into a shuffled schedule with the given weights
+std::vector<Operation> parseMix(const std::string& mix);
+
+// lists one recording and drops its descriptor, only the round trip is of interest
+std::int32_t listRecording(AeronArchive& archive, std::int64_t recordingId);
+
+// returns how long the call took in ns, a failed call is counted in errors and timed like any other
+template <typename F>
+std::int64_t timed(std::int64_t& errors, F&& call) {
+    const auto start = std::chrono::high_resolution_clock::now();
+    try {
+        call();
+    } catch (const ArchiveException& e) {
+        ++errors;
+    }
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start)
+        .count();
+}
 }  // namespace archive
 }  // namespace aeron
@@ -20,6 +20,7 @@
 
 #include "AeronArchive.h"
 #include "ChannelUri.h"
+#include "EventLog.h"
 
 namespace codecs = io::aeron::archive::codecs;
 
@@ -28,6 +29,73 @@ namespace {
 static const std::int32_t FRAGMENT_LIMIT = 10;
 static const std::int32_t DEFAULT_RETRY_ATTEMPTS = 3;
 
+static const std::int32_t AWAIT_CONNECTION_LOOP_ID = 0;
+static const std::int32_t POLL_RESPONSE_LOOP_ID = 1;
+static const std::int32_t POLL_DESCRIPTORS_LOOP_ID = 2;
+
+// counts a request as sent and in flight until the response is polled or the poll fails
+class InFlightRequest {
+public:
+    explicit InFlightRequest(aeron::archive::ArchiveCounters* counters)
+        : counters_(counters) {
+        if (counters_) {
+            counters_->onRequestSent();
+        }
+    }
+
+    ~InFlightRequest() {
+        if (counters_) {
+            counters_->onRequestCompleted();
+        }
+    }
+
+private:
+    aeron::archive::ArchiveCounters* counters_;
+};
+
+// holds the client lock for the scope, when timed it records how long the lock was waited for and held, each
+// after the lock is released so recording does not lengthen the hold
+class TimedLock {
+    using Clock = std::chrono::high_resolution_clock;
+
+public:
+    TimedLock(std::mutex& mutex, bool isTimed, aeron::archive::LatencyHistogram& waits,
+              aeron::archive::LatencyHistogram& holds)
+        : lock_(mutex, std::defer_lock)
+        , isTimed_(isTimed)
+        , waits_(waits)
+        , holds_(holds) {
+        if (!isTimed_) {
+            lock_.lock();
+            return;
+        }
+
+        start_ = Clock::now();
+        lock_.lock();
+        acquired_ = Clock::now();
+    }
+
+    ~TimedLock() {
+        if (!isTimed_) {
+            return;
+        }
+
+        const auto released = Clock::now();
+        lock_.unlock();
+
+        waits_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(acquired_ - start_).count());
+        holds_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(released - acquired_).count());
+    }
+
+private:
+    std::unique_lock<std::mutex> lock_;
+    const bool isTimed_;
+    aeron::archive::LatencyHistogram& waits_;
+    aeron::archive::LatencyHistogram& holds_;
+    Clock::time_point start_;
+    Clock::time_point acquired_;
+};
+
 }  // namespace
 
 namespace aeron {
@@ -35,7 +103,10 @@ namespace archive {
 
 AeronArchive::AeronArchive(const Context& ctx)
     : ctx_(ctx)
-    , messageTimeoutNs_(ctx_.messageTimeoutNs()) {
+    , messageTimeoutNs_(ctx_.messageTimeoutNs())
+    , awaitConnectionCycle_(AWAIT_CONNECTION_LOOP_ID, "await connection")
+    , responseCycle_(POLL_RESPONSE_LOOP_ID, "poll response")
+    , descriptorCycle_(POLL_DESCRIPTORS_LOOP_ID, "poll descriptors") {
     ctx_.conclude();
 
     aeron_ = ctx_.aeron();
@@ -48,7 +119,7 @@ AeronArchive::AeronArchive(const Context& ctx)
         std::this_thread::yield();
     }
 
-    controlResponsePoller_ = std::make_unique<ControlResponsePoller>(subscription, FRAGMENT_LIMIT);
+    dispatcher_ = std::make_unique<ControlResponseDispatcher>(subscription, FRAGMENT_LIMIT);
 
     std::int64_t pubId = aeron_->addExclusivePublication(ctx_.controlRequestChannel(), ctx_.controlRequestStreamId());
     std::shared_ptr<ExclusivePublication> publication;
@@ -59,19 +130,27 @@ AeronArchive::AeronArchive(const Context& ctx)
     archiveProxy_ = std::make_unique<ArchiveProxy>(publication, ctx_.messageTimeoutNs(), DEFAULT_RETRY_ATTEMPTS);
 
     std::int64_t correlationId = aeron_->nextCorrelationId();
+    dispatcher_->expectResponse(ControlResponseDispatcher::ANY_SESSION, correlationId);
     if (!archiveProxy_->connect(ctx_.controlResponseChannel(), ctx_.controlResponseStreamId(), correlationId,
                                 aeron_->conductorAgentInvoker())) {
         throw ArchiveException("cannot connect to archive: " + ctx_.controlResponseChannel(), SOURCEINFO);
     }
 
     controlSessionId_ = awaitSessionOpened(correlationId);
-    recordingDescriptorPoller_ =
-        std::make_unique<RecordingDescriptorPoller>(subscription, FRAGMENT_LIMIT, controlSessionId_);
+
+    counters_ = std::make_unique<ArchiveCounters>(*aeron_, controlSessionId_);
+    archiveProxy_->counters(counters_.get());
+    awaitConnectionCycle_.attach(*aeron_, controlSessionId_);
+    responseCycle_.attach(*aeron_, controlSessionId_);
+    descriptorCycle_.attach(*aeron_, controlSessionId_);
 }
 
 AeronArchive::AeronArchive(const Context& ctx, const ArchiveProxy& archiveProxy)
     : ctx_(ctx)
-    , archiveProxy_(std::make_unique<ArchiveProxy>(archiveProxy)) {
+    , archiveProxy_(std::make_unique<ArchiveProxy>(archiveProxy))
+    , awaitConnectionCycle_(AWAIT_CONNECTION_LOOP_ID, "await connection")
+    , responseCycle_(POLL_RESPONSE_LOOP_ID, "poll response")
+    , descriptorCycle_(POLL_DESCRIPTORS_LOOP_ID, "poll descriptors") {
     // TODO
 }
 
@@ -88,32 +167,45 @@ std::shared_ptr<AeronArchive> AeronArchive::asyncConnect(const Context& ctx) {
 // getters
 const Context& AeronArchive::context() const { return ctx_; }
 
+std::int64_t AeronArchive::controlSessionId() const { return controlSessionId_; }
+
+ArchiveCounters* AeronArchive::counters() const { return counters_.get(); }
+
+LatencyHistogram& AeronArchive::latency(ArchiveOperation operation) {
+    return latencies_[static_cast<std::int32_t>(operation)];
+}
+
+LatencyHistogram& AeronArchive::lockWait() { return lockWait_; }
+
+LatencyHistogram& AeronArchive::lockHold() { return lockHold_; }
+
+const DutyCycleTracker& AeronArchive::awaitConnectionCycle() const { return awaitConnectionCycle_; }
+
+const DutyCycleTracker& AeronArchive::responseCycle() const { return responseCycle_; }
+
+const DutyCycleTracker& AeronArchive::descriptorCycle() const { return descriptorCycle_; }
+
 //
 boost::optional<std::string> AeronArchive::pollForErrorResponse() {
-    std::unique_lock<std::mutex> lock(lock_);
+    TimedLock lock(lock_, ctx_.lockTiming(), lockWait_, lockHold_);
 
-    if (controlResponsePoller_->poll() != 0 && controlResponsePoller_->isPollComplete()) {
-        if (controlResponsePoller_->controlSessionId() == controlSessionId_ &&
-            controlResponsePoller_->templateId() == codecs::ControlResponse::sbeTemplateId() &&
-            controlResponsePoller_->code() == codecs::ControlResponseCode::ERROR) {
-            return controlResponsePoller_->errorMessage();
-        }
+    dispatcher_->poll();
+
+    if (auto error = dispatcher_->takeError(controlSessionId_)) {
+        return error->errorMessage;
     }
 
     return {};
 }
 
 void AeronArchive::checkForErrorResponse() {
-    std::unique_lock<std::mutex> lock(lock_);
-
-    if (controlResponsePoller_->poll() != 0 && controlResponsePoller_->isPollComplete()) {
-        if (controlResponsePoller_->controlSessionId() == controlSessionId_ &&
-            controlResponsePoller_->templateId() == codecs::ControlResponse::sbeTemplateId() &&
-            controlResponsePoller_->code() == codecs::ControlResponseCode::ERROR) {
-            throw ArchiveException("error: " + controlResponsePoller_->errorMessage() +
-                                       ", relevant id: " + std::to_string(controlResponsePoller_->relevantId()),
-                                   SOURCEINFO);
-        }
+    TimedLock lock(lock_, ctx_.lockTiming(), lockWait_, lockHold_);
+
+    dispatcher_->poll();
+
+    if (auto error = dispatcher_->takeError(controlSessionId_)) {
+        throw ArchiveException("error: " + error->errorMessage + ", relevant id: " + std::to_string(error->relevantId),
+                               SOURCEINFO);
     }
 }
 
@@ -156,7 +248,7 @@ std::int64_t AeronArchive::startRecording(const std::string& channel, std::int32
         [&](std::int64_t correlationId) {
             return archiveProxy_->startRecording(channel, streamId, sourceLocation, correlationId, controlSessionId_);
         },
-        "start recording");
+        ArchiveOperation::START_RECORDING);
 }
 
 std::int64_t AeronArchive::extendRecording(std::int64_t recordingId, const std::string& channel, std::int32_t streamId,
@@ -166,7 +258,7 @@ std::int64_t AeronArchive::extendRecording(std::int64_t recordingId, const std::
             return archiveProxy_->extendRecording(channel, streamId, sourceLocation, recordingId, correlationId,
                                                   controlSessionId_);
         },
-        "extend recording");
+        ArchiveOperation::EXTEND_RECORDING);
 }
 
 void AeronArchive::stopRecording(const std::string& channel, std::int32_t streamId) {
@@ -174,7 +266,7 @@ void AeronArchive::stopRecording(const std::string& channel, std::int32_t stream
         [&](std::int64_t correlationId) {
             return this->archiveProxy_->stopRecording(channel, streamId, correlationId, controlSessionId_);
         },
-        "stop recording");
+        ArchiveOperation::STOP_RECORDING);
 }
 
 void AeronArchive::stopRecording(const aeron::Publication& publication) {
@@ -194,7 +286,7 @@ void AeronArchive::stopRecording(std::int64_t subscriptionId) {
         [&](std::int64_t correlationId) {
             return this->archiveProxy_->stopRecording(subscriptionId, correlationId, controlSessionId_);
         },
-        "stop recording");
+        ArchiveOperation::STOP_RECORDING);
 }
 
 std::int64_t AeronArchive::startReplay(std::int64_t recordingId, std::int64_t position, std::int64_t length,
@@ -204,7 +296,7 @@ std::int64_t AeronArchive::startReplay(std::int64_t recordingId, std::int64_t po
             return archiveProxy_->replay(recordingId, position, length, replayChannel, replayStreamId, correlationId,
                                          controlSessionId_);
         },
-        "start replay");
+        ArchiveOperation::START_REPLAY);
 }
 
 void AeronArchive::stopReplay(std::int64_t replaySessionId) {
@@ -212,7 +304,7 @@ void AeronArchive::stopReplay(std::int64_t replaySessionId) {
         [&](std::int64_t correlationId) {
             return this->archiveProxy_->stopReplay(replaySessionId, correlationId, controlSessionId_);
         },
-        "stop replay");
+        ArchiveOperation::STOP_REPLAY);
 }
 
 std::shared_ptr<aeron::Subscription> AeronArchive::replay(std::int64_t recordingId, std::int64_t position,
@@ -249,7 +341,7 @@ std::int32_t AeronArchive::listRecordings(std::int64_t fromRecordingId, std::int
         [&](std::int64_t correlationId) {
             return this->archiveProxy_->listRecordings(fromRecordingId, recordCount, correlationId, controlSessionId_);
         },
-        recordCount, std::move(consumer), "list recordings");
+        recordCount, std::move(consumer), ArchiveOperation::LIST_RECORDINGS);
 }
 
 std::int32_t AeronArchive::listRecordingsForUri(std::int64_t fromRecordingId, std::int32_t recordCount,
@@ -260,7 +352,7 @@ std::int32_t AeronArchive::listRecordingsForUri(std::int64_t fromRecordingId, st
             return archiveProxy_->listRecordingsForUri(fromRecordingId, recordCount, channelFragment, streamId, correlationId,
                                                        controlSessionId_);
         },
-        recordCount, std::move(consumer), "list recordings for URI");
+        recordCount, std::move(consumer), ArchiveOperation::LIST_RECORDINGS_FOR_URI);
 }
 
 std::int32_t AeronArchive::listRecording(std::int64_t recordingId, RecordingDescriptorConsumer&& consumer) {
@@ -268,7 +360,7 @@ std::int32_t AeronArchive::listRecording(std::int64_t recordingId, RecordingDesc
         [&](std::int64_t correlationId) {
             return this->archiveProxy_->listRecording(recordingId, correlationId, controlSessionId_);
         },
-        1, std::move(consumer), "list recording");
+        1, std::move(consumer), ArchiveOperation::LIST_RECORDING);
 }
 
 std::int64_t AeronArchive::getRecordingPosition(std::int64_t recordingId) {
@@ -276,7 +368,7 @@ std::int64_t AeronArchive::getRecordingPosition(std::int64_t recordingId) {
         [&](std::int64_t correlationId) {
             return this->archiveProxy_->getRecordingPosition(recordingId, correlationId, controlSessionId_);
         },
-        "get recording position");
+        ArchiveOperation::GET_RECORDING_POSITION);
 }
 
 void AeronArchive::truncateRecording(std::int64_t recordingId, std::int64_t position) {
@@ -284,7 +376,7 @@ void AeronArchive::truncateRecording(std::int64_t recordingId, std::int64_t posi
         [&](std::int64_t correlationId) {
             return this->archiveProxy_->truncateRecording(recordingId, position, correlationId, controlSessionId_);
         },
-        "truncate recording");
+        ArchiveOperation::TRUNCATE_RECORDING);
 }
 
 std::int64_t AeronArchive::getStopPosition(std::int64_t recordingId) {
@@ -292,7 +384,7 @@ std::int64_t AeronArchive::getStopPosition(std::int64_t recordingId) {
         [&](std::int64_t correlationId) {
             return this->archiveProxy_->getStopPosition(recordingId, correlationId, controlSessionId_);
         },
-        "get recording stop position");
+        ArchiveOperation::GET_STOP_POSITION);
 }
 
 std::int32_t AeronArchive::findLastMatchingRecording(std::int64_t minRecordingId, const std::string& channelFragment,
@@ -302,48 +394,42 @@ std::int32_t AeronArchive::findLastMatchingRecording(std::int64_t minRecordingId
             return this->archiveProxy_->findLastMatchingRecording(minRecordingId, channelFragment, streamId, sessionId,
                                                                   correlationId, controlSessionId_);
         },
-        "find last matching recording");
+        ArchiveOperation::FIND_LAST_MATCHING_RECORDING);
 }
 
 std::int64_t AeronArchive::awaitSessionOpened(std::int64_t correlationId) {
     auto deadline = Clock::now() + messageTimeoutNs_;
 
     awaitConnection(deadline);
+    pollNextResponse(correlationId, deadline);
 
-    while (true) {
-        pollNextResponse(correlationId, deadline);
-
-        if (controlResponsePoller_->correlationId() != correlationId ||
-            controlResponsePoller_->templateId() != codecs::ControlResponse::sbeTemplateId()) {
-            aeron_->conductorAgentInvoker().invoke();
-            continue;
-        }
-
-        auto code = controlResponsePoller_->code();
-        if (code != codecs::ControlResponseCode::OK) {
-            if (code == codecs::ControlResponseCode::ERROR) {
-                throw ArchiveException("unexpected response: " + controlResponsePoller_->errorMessage() +
-                                           ", relevant id: " + std::to_string(controlResponsePoller_->relevantId()),
-                                       SOURCEINFO);
-            }
-
-            throw ArchiveException("unexpected response: code=" + std::to_string(code), SOURCEINFO);
+    auto response = dispatcher_->take(correlationId);
+    if (response.code != codecs::ControlResponseCode::OK) {
+        if (response.code == codecs::ControlResponseCode::ERROR) {
+            throw ArchiveException("unexpected response: " + response.errorMessage +
+                                       ", relevant id: " + std::to_string(response.relevantId),
+                                   SOURCEINFO);
         }
 
-        return controlResponsePoller_->controlSessionId();
+        throw ArchiveException("unexpected response: code=" + std::to_string(response.code), SOURCEINFO);
     }
+
+    return response.controlSessionId;
 }
 
 void AeronArchive::awaitConnection(const TimePoint& deadline) {
-    while (!controlResponsePoller_->subscription()->isConnected()) {
-        if (Clock::now() > deadline) {
+    DutyCycleTracker::Scope cycleScope(awaitConnectionCycle_);
+
+    while (!dispatcher_->subscription()->isConnected()) {
+        if (awaitConnectionCycle_.beginCycle() > deadline) {
             throw ArchiveException(
-                "failed to establish response connection on " + controlResponsePoller_->subscription()->channel() +
-                    ", stream id: " + std::to_string(controlResponsePoller_->subscription()->streamId()),
+                "failed to establish response connection on " + dispatcher_->subscription()->channel() +
+                    ", stream id: " + std::to_string(dispatcher_->subscription()->streamId()),
                 SOURCEINFO);
         }
 
         idleStrategy_.idle();
+        awaitConnectionCycle_.beginInvoke();
         aeron_->conductorAgentInvoker().invoke();
     }
 }
@@ -351,87 +437,118 @@ void AeronArchive::awaitConnection(const TimePoint& deadline) {
 std::int64_t AeronArchive::pollForResponse(std::int64_t correlationId) {
     auto deadline = Clock::now() + messageTimeoutNs_;
 
-    while (true) {
-        pollNextResponse(correlationId, deadline);
+    pollNextResponse(correlationId, deadline);
 
-        if (controlResponsePoller_->controlSessionId() != controlSessionId_ ||
-            controlResponsePoller_->templateId() != codecs::ControlResponse::sbeTemplateId()) {
-            aeron_->conductorAgentInvoker().invoke();
-            continue;
+    auto response = dispatcher_->take(correlationId);
+    if (response.code == codecs::ControlResponseCode::ERROR) {
+        if (counters_) {
+            counters_->onError();
         }
+        throw ArchiveException("response for correlation id: " + std::to_string(correlationId) +
+                                   ", error: " + response.errorMessage +
+                                   ", relevant id: " + std::to_string(response.relevantId),
+                               SOURCEINFO);
+    }
 
-        auto code = controlResponsePoller_->code();
-        if (code == codecs::ControlResponseCode::ERROR) {
-            throw ArchiveException("response for correlation id: " + std::to_string(correlationId) +
-                                       ", error: " + controlResponsePoller_->errorMessage() +
-                                       ", relevant id: " + std::to_string(controlResponsePoller_->relevantId()),
-                                   SOURCEINFO);
-        } else if (correlationId == controlResponsePoller_->correlationId()) {
-            if (code != codecs::ControlResponseCode::OK) {
-                throw ArchiveException("unexpected response: code=" + std::to_string(code), SOURCEINFO);
-            }
+    if (counters_) {
+        counters_->onResponseReceived();
+    }
 
-            return controlResponsePoller_->relevantId();
-        }
+    if (response.code != codecs::ControlResponseCode::OK) {
+        throw ArchiveException("unexpected response: code=" + std::to_string(response.code), SOURCEINFO);
     }
+
+    return response.relevantId;
 }
 
 void AeronArchive::pollNextResponse(std::int64_t correlationId, const TimePoint& deadline) {
+    DutyCycleTracker::Scope cycleScope(responseCycle_);
+
     while (true) {
-        std::int32_t fragments = controlResponsePoller_->poll();
+        const TimePoint now = responseCycle_.beginCycle();
+        std::int32_t fragments = dispatcher_->poll();
 
-        if (controlResponsePoller_->isPollComplete()) {
+        if (dispatcher_->isComplete(correlationId)) {
+            responseCycle_.onWork();
             break;
         }
 
         if (fragments > 0) {
+            responseCycle_.onWork();
             continue;
         }
 
-        if (!controlResponsePoller_->subscription()->isConnected()) {
+        if (!dispatcher_->subscription()->isConnected()) {
             throw ArchiveException("subscription to archive is not connected", SOURCEINFO);
         }
 
-        if (Clock::now() > deadline) {
+        if (now > deadline) {
+            if (counters_) {
+                counters_->onTimeout();
+            }
+            AERON_ARCHIVE_LOG_EVENT(EventCode::TIMEOUT, controlSessionId_, correlationId, 0, 0, 0);
             throw ArchiveException("awaiting response for correlationId=" + std::to_string(correlationId), SOURCEINFO);
         }
 
         idleStrategy_.idle();
+        responseCycle_.beginInvoke();
         aeron_->conductorAgentInvoker().invoke();
     }
 }
 
-std::int64_t AeronArchive::pollForDescriptors(std::int64_t correlationId, std::int32_t recordCount,
-                                              RecordingDescriptorConsumer&& consumer) {
+std::int64_t AeronArchive::pollForDescriptors(std::int64_t correlationId, std::int32_t recordCount) {
     std::int32_t existingRemainCount = recordCount;
     auto deadline = Clock::now() + messageTimeoutNs_;
 
-    recordingDescriptorPoller_->reset(correlationId, recordCount, std::move(consumer));
+    DutyCycleTracker::Scope cycleScope(descriptorCycle_);
 
     while (true) {
-        std::int32_t fragments = recordingDescriptorPoller_->poll();
-        std::int32_t remainingRecordCount = recordingDescriptorPoller_->remainingRecordCount();
+        const TimePoint now = descriptorCycle_.beginCycle();
+        std::int32_t fragments = dispatcher_->poll();
+
+        if (dispatcher_->isComplete(correlationId)) {
+            descriptorCycle_.onWork();
+
+            auto response = dispatcher_->take(correlationId);
+            if (response.code == codecs::ControlResponseCode::ERROR) {
+                if (counters_) {
+                    counters_->onError();
+                }
+                throw ArchiveException("response for correlationId=" + std::to_string(correlationId) +
+                                           ", error: " + response.errorMessage,
+                                       SOURCEINFO);
+            }
 
-        if (recordingDescriptorPoller_->isDispatchComplete()) {
-            return recordCount - remainingRecordCount;
+            if (counters_) {
+                counters_->onResponseReceived();
+            }
+            return recordCount - response.remainingRecordCount;
         }
 
+        std::int32_t remainingRecordCount = dispatcher_->remainingRecordCount(correlationId);
+
         if (existingRemainCount != remainingRecordCount) {
             existingRemainCount = remainingRecordCount;
-            deadline = Clock::now() + messageTimeoutNs_;
+            deadline = now + messageTimeoutNs_;
         }
 
+        descriptorCycle_.beginInvoke();
         aeron_->conductorAgentInvoker().invoke();
 
         if (fragments > 0) {
+            descriptorCycle_.onWork();
             continue;
         }
 
-        if (!recordingDescriptorPoller_->subscription()->isConnected()) {
+        if (!dispatcher_->subscription()->isConnected()) {
             throw ArchiveException("subscription to archive is not connected", SOURCEINFO);
         }
 
-        if (Clock::now() > deadline) {
+        if (now > deadline) {
+            if (counters_) {
+                counters_->onTimeout();
+            }
+            AERON_ARCHIVE_LOG_EVENT(EventCode::TIMEOUT, controlSessionId_, correlationId, 0, 0, 0);
             throw ArchiveException("awaiting recording descriptors: correlationId=" + std::to_string(correlationId),
                                    SOURCEINFO);
         }
@@ -440,29 +557,61 @@ std::int64_t AeronArchive::pollForDescriptors(std::int64_t correlationId, std::i
     }
 }
 
-std::int64_t AeronArchive::callAndPollForResponse(std::function<bool(std::int64_t)>&& f, const char* request) {
-    std::unique_lock<std::mutex> lock(lock_);
+std::int64_t AeronArchive::callAndPollForResponse(std::function<bool(std::int64_t)>&& f,
+                                                  ArchiveOperation operation) {
+    TimedLock lock(lock_, ctx_.lockTiming(), lockWait_, lockHold_);
 
     std::int64_t correlationId = aeron_->nextCorrelationId();
+    auto start = Clock::now();
 
-    if (!f(correlationId)) {
-        throw ArchiveException(std::string(request) + ": failed to send", SOURCEINFO);
-    }
+    // registered before sending so the response cannot be read before it is expected
+    dispatcher_->expectResponse(controlSessionId_, correlationId);
 
-    return pollForResponse(correlationId);
+    try {
+        if (!f(correlationId)) {
+            throw ArchiveException(std::string(operationName(operation)) + ": failed to send", SOURCEINFO);
+        }
+
+        InFlightRequest inFlight(counters_.get());
+        std::int64_t relevantId = pollForResponse(correlationId);
+
+        recordLatency(operation, start);
+        return relevantId;
+    } catch (...) {
+        dispatcher_->cancel(correlationId);
+        throw;
+    }
 }
 
 std::int64_t AeronArchive::callAndPollForDescriptors(std::function<bool(std::int64_t)>&& f, std::int32_t recordCount,
-                                                     RecordingDescriptorConsumer&& consumer, const char* request) {
-    std::unique_lock<std::mutex> lock(lock_);
+                                                     RecordingDescriptorConsumer&& consumer,
+                                                     ArchiveOperation operation) {
+    TimedLock lock(lock_, ctx_.lockTiming(), lockWait_, lockHold_);
 
     std::int64_t correlationId = aeron_->nextCorrelationId();
+    auto start = Clock::now();
+
+    dispatcher_->expectDescriptors(controlSessionId_, correlationId, recordCount, std::move(consumer));
 
-    if (!f(correlationId)) {
-        throw ArchiveException(std::string(request) + ": failed to send", SOURCEINFO);
+    try {
+        if (!f(correlationId)) {
+            throw ArchiveException(std::string(operationName(operation)) + ": failed to send", SOURCEINFO);
+        }
+
+        InFlightRequest inFlight(counters_.get());
+        std::int64_t count = pollForDescriptors(correlationId, recordCount);
+
+        recordLatency(operation, start);
+        return count;
+    } catch (...) {
+        dispatcher_->cancel(correlationId);
+        throw;
     }
+}
 
-    return pollForDescriptors(correlationId, recordCount, std::move(consumer));
+void AeronArchive::recordLatency(ArchiveOperation operation, const TimePoint& start) {
+    latencies_[static_cast<std::int32_t>(operation)].record(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
 }
 
 }  // namespace archive
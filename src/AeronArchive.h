@@ -23,11 +23,14 @@
 
 #include "io_aeron_archive_codecs/SourceLocation.h"
 
+#include "ArchiveCounters.h"
 #include "ArchiveException.h"
+#include "ArchiveOperation.h"
 #include "ArchiveProxy.h"
 #include "Context.h"
-#include "ControlResponsePoller.h"
-#include "RecordingDescriptorPoller.h"
+#include "ControlResponseDispatcher.h"
+#include "DutyCycleTracker.h"
+#include "LatencyHistogram.h"
 
 namespace aeron {
 namespace archive {
@@ -49,6 +52,17 @@ public:
 
     // getters
     const Context& context() const;
+    std::int64_t controlSessionId() const;
+    // null until the session is opened
+    ArchiveCounters* counters() const;
+    // time from encoding a request until its response is received, successful calls only
+    LatencyHistogram& latency(ArchiveOperation operation);
+    // time callers waited for the client lock and held it, in nanoseconds, empty unless Context::lockTiming is set
+    LatencyHistogram& lockWait();
+    LatencyHistogram& lockHold();
+    const DutyCycleTracker& awaitConnectionCycle() const;
+    const DutyCycleTracker& responseCycle() const;
+    const DutyCycleTracker& descriptorCycle() const;
 
     //
     boost::optional<std::string> pollForErrorResponse();
@@ -109,18 +123,21 @@ private:
 
     std::int64_t pollForResponse(std::int64_t correlationId);
     void pollNextResponse(std::int64_t correlationId, const TimePoint& deadline);
-    std::int64_t pollForDescriptors(std::int64_t correlationId, std::int32_t recordCount,
-                                    RecordingDescriptorConsumer&& consumer);
+    std::int64_t pollForDescriptors(std::int64_t correlationId, std::int32_t recordCount);
 
-    std::int64_t callAndPollForResponse(std::function<bool(std::int64_t)>&& f, const char* request);
+    std::int64_t callAndPollForResponse(std::function<bool(std::int64_t)>&& f, ArchiveOperation operation);
     std::int64_t callAndPollForDescriptors(std::function<bool(std::int64_t)>&& f, std::int32_t recordCount,
-                                           RecordingDescriptorConsumer&& consumer, const char* request);
+                                           RecordingDescriptorConsumer&& consumer, ArchiveOperation operation);
+    void recordLatency(ArchiveOperation operation, const TimePoint& start);
 
 private:
     Context ctx_;
     std::unique_ptr<ArchiveProxy> archiveProxy_;
-    std::unique_ptr<ControlResponsePoller> controlResponsePoller_;
-    std::unique_ptr<RecordingDescriptorPoller> recordingDescriptorPoller_;
+    std::unique_ptr<ControlResponseDispatcher> dispatcher_;
+    std::unique_ptr<ArchiveCounters> counters_;
+    LatencyHistogram latencies_[ARCHIVE_OPERATION_COUNT];
+    LatencyHistogram lockWait_;
+    LatencyHistogram lockHold_;
 
     std::shared_ptr<aeron::Aeron> aeron_;
     aeron::concurrent::YieldingIdleStrategy idleStrategy_;  // TODO: make it generic
@@ -128,6 +145,10 @@ private:
 
     std::chrono::nanoseconds messageTimeoutNs_;
     std::int64_t controlSessionId_;
+
+    DutyCycleTracker awaitConnectionCycle_;
+    DutyCycleTracker responseCycle_;
+    DutyCycleTracker descriptorCycle_;
 };
 
 }  // namespace archive
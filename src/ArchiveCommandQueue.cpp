@@ -0,0 +1,474 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <thread>
+
+#include "ArchiveCommandQueue.h"
+#include "ArchiveException.h"
+#include "EventLog.h"
+
+namespace codecs = io::aeron::archive::codecs;
+
+namespace {
+
+const std::int32_t FRAGMENT_LIMIT = 10;
+const std::int32_t DEFAULT_RETRY_ATTEMPTS = 3;
+const std::int32_t DRAIN_LIMIT = 16;
+
+std::int64_t roundUpToPowerOfTwo(std::int32_t value) {
+    std::int64_t capacity = 1;
+    while (capacity < value) {
+        capacity <<= 1;
+    }
+
+    return capacity;
+}
+
+}  // namespace
+
+namespace aeron {
+namespace archive {
+
+ArchiveCommand ArchiveCommand::startRecording(const std::string& channel, std::int32_t streamId,
+                                              codecs::SourceLocation::Value sourceLocation) {
+    ArchiveCommand command;
+    command.operation = ArchiveOperation::START_RECORDING;
+    command.channel = channel;
+    command.streamId = streamId;
+    command.sourceLocation = sourceLocation;
+    return command;
+}
+
+ArchiveCommand ArchiveCommand::extendRecording(std::int64_t recordingId, const std::string& channel,
+                                               std::int32_t streamId, codecs::SourceLocation::Value sourceLocation) {
+    ArchiveCommand command = startRecording(channel, streamId, sourceLocation);
+    command.operation = ArchiveOperation::EXTEND_RECORDING;
+    command.recordingId = recordingId;
+    return command;
+}
+
+ArchiveCommand ArchiveCommand::stopRecording(const std::string& channel, std::int32_t streamId) {
+    ArchiveCommand command;
+    command.operation = ArchiveOperation::STOP_RECORDING;
+    command.channel = channel;
+    command.streamId = streamId;
+    return command;
+}
+
+ArchiveCommand ArchiveCommand::stopRecording(std::int64_t subscriptionId) {
+    ArchiveCommand command;
+    command.operation = ArchiveOperation::STOP_RECORDING;
+    command.subscriptionId = subscriptionId;
+    return command;
+}
+
+ArchiveCommand ArchiveCommand::startReplay(std::int64_t recordingId, std::int64_t position, std::int64_t length,
+                                           const std::string& replayChannel, std::int32_t replayStreamId) {
+    ArchiveCommand command;
+    command.operation = ArchiveOperation::START_REPLAY;
+    command.recordingId = recordingId;
+    command.position = position;
+    command.length = length;
+    command.channel = replayChannel;
+    command.streamId = replayStreamId;
+    return command;
+}
+
+ArchiveCommand ArchiveCommand::stopReplay(std::int64_t replaySessionId) {
+    ArchiveCommand command;
+    command.operation = ArchiveOperation::STOP_REPLAY;
+    command.replaySessionId = replaySessionId;
+    return command;
+}
+
+ArchiveCommand ArchiveCommand::listRecordings(std::int64_t fromRecordingId, std::int32_t recordCount,
+                                              RecordingDescriptorConsumer&& consumer) {
+    ArchiveCommand command;
+    command.operation = ArchiveOperation::LIST_RECORDINGS;
+    command.recordingId = fromRecordingId;
+    command.recordCount = recordCount;
+    command.consumer = std::move(consumer);
+    return command;
+}
+
+ArchiveCommand ArchiveCommand::listRecordingsForUri(std::int64_t fromRecordingId, std::int32_t recordCount,
+                                                    const std::string& channelFragment, std::int32_t streamId,
+                                                    RecordingDescriptorConsumer&& consumer) {
+    ArchiveCommand command = listRecordings(fromRecordingId, recordCount, std::move(consumer));
+    command.operation = ArchiveOperation::LIST_RECORDINGS_FOR_URI;
+    command.channel = channelFragment;
+    command.streamId = streamId;
+    return command;
+}
+
+ArchiveCommand ArchiveCommand::listRecording(std::int64_t recordingId, RecordingDescriptorConsumer&& consumer) {
+    ArchiveCommand command = listRecordings(recordingId, 1, std::move(consumer));
+    command.operation = ArchiveOperation::LIST_RECORDING;
+    return command;
+}
+
+ArchiveCommand ArchiveCommand::getRecordingPosition(std::int64_t recordingId) {
+    ArchiveCommand command;
+    command.operation = ArchiveOperation::GET_RECORDING_POSITION;
+    command.recordingId = recordingId;
+    return command;
+}
+
+ArchiveCommand ArchiveCommand::getStopPosition(std::int64_t recordingId) {
+    ArchiveCommand command = getRecordingPosition(recordingId);
+    command.operation = ArchiveOperation::GET_STOP_POSITION;
+    return command;
+}
+
+ArchiveCommand ArchiveCommand::truncateRecording(std::int64_t recordingId, std::int64_t position) {
+    ArchiveCommand command;
+    command.operation = ArchiveOperation::TRUNCATE_RECORDING;
+    command.recordingId = recordingId;
+    command.position = position;
+    return command;
+}
+
+ArchiveCommand ArchiveCommand::findLastMatchingRecording(std::int64_t minRecordingId,
+                                                         const std::string& channelFragment, std::int32_t streamId,
+                                                         std::int32_t sessionId) {
+    ArchiveCommand command;
+    command.operation = ArchiveOperation::FIND_LAST_MATCHING_RECORDING;
+    command.recordingId = minRecordingId;
+    command.channel = channelFragment;
+    command.streamId = streamId;
+    command.sessionId = sessionId;
+    return command;
+}
+
+bool ArchiveCommand::isListing() const {
+    return operation == ArchiveOperation::LIST_RECORDINGS || operation == ArchiveOperation::LIST_RECORDINGS_FOR_URI ||
+           operation == ArchiveOperation::LIST_RECORDING;
+}
+
+bool ArchiveCommandResult::isSuccess() const { return code == codecs::ControlResponseCode::OK; }
+
+ArchiveCommandRing::ArchiveCommandRing(std::int32_t capacity)
+    : mask_(roundUpToPowerOfTwo(capacity) - 1), slots_(new Slot[mask_ + 1]) {
+    for (std::int64_t i = 0; i <= mask_; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool ArchiveCommandRing::offer(ArchiveCommand&& command, ArchiveCommandCallback&& callback) {
+    std::int64_t tail = tail_.load(std::memory_order_relaxed);
+    Slot* slot;
+
+    while (true) {
+        slot = &slots_[tail & mask_];
+        const std::int64_t sequence = slot->sequence.load(std::memory_order_acquire);
+
+        if (sequence == tail) {
+            // the slot is free, claim it unless another producer got there first
+            if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (sequence < tail) {
+            // the slot still holds the command of the previous lap
+            return false;
+        } else {
+            tail = tail_.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->command = std::move(command);
+    slot->callback = std::move(callback);
+    slot->sequence.store(tail + 1, std::memory_order_release);
+
+    return true;
+}
+
+std::int32_t ArchiveCommandRing::drain(const CommandHandler& handler, std::int32_t limit) {
+    std::int64_t head = head_.load(std::memory_order_relaxed);
+    std::int32_t count = 0;
+
+    while (count < limit) {
+        Slot& slot = slots_[head & mask_];
+        if (slot.sequence.load(std::memory_order_acquire) != head + 1) {
+            break;
+        }
+
+        handler(slot.command, slot.callback);
+
+        // drop whatever the handler left behind so captures are not held for a lap
+        slot.command.consumer = nullptr;
+        slot.callback = nullptr;
+        slot.sequence.store(head + mask_ + 1, std::memory_order_release);
+
+        head_.store(++head, std::memory_order_relaxed);
+        ++count;
+    }
+
+    return count;
+}
+
+std::int32_t ArchiveCommandRing::capacity() const { return static_cast<std::int32_t>(mask_ + 1); }
+
+std::int32_t ArchiveCommandRing::size() const {
+    const std::int64_t size = tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_relaxed);
+    return static_cast<std::int32_t>(std::max<std::int64_t>(0, std::min(size, mask_ + 1)));
+}
+
+ArchiveCommandTracker::ArchiveCommandTracker(ControlResponseDispatcher& dispatcher, std::int64_t controlSessionId,
+                                             std::chrono::nanoseconds messageTimeoutNs)
+    : dispatcher_(dispatcher), controlSessionId_(controlSessionId), messageTimeoutNs_(messageTimeoutNs) {}
+
+void ArchiveCommandTracker::expect(ArchiveCommand& command, std::int64_t correlationId) {
+    if (command.isListing()) {
+        dispatcher_.expectDescriptors(controlSessionId_, correlationId, command.recordCount,
+                                      std::move(command.consumer));
+    } else {
+        dispatcher_.expectResponse(controlSessionId_, correlationId);
+    }
+}
+
+void ArchiveCommandTracker::onSent(const ArchiveCommand& command, std::int64_t correlationId,
+                                   ArchiveCommandCallback& callback, TimePoint now) {
+    inFlight_.emplace(correlationId, InFlight{command.operation, std::move(callback), now + messageTimeoutNs_,
+                                              command.recordCount, command.recordCount});
+}
+
+void ArchiveCommandTracker::onSendFailed(const ArchiveCommand& command, std::int64_t correlationId,
+                                         ArchiveCommandCallback& callback, std::string&& errorMessage) {
+    dispatcher_.cancel(correlationId);
+
+    ArchiveCommandResult result;
+    result.operation = command.operation;
+    result.correlationId = correlationId;
+    result.errorMessage = std::move(errorMessage);
+
+    completed_.emplace_back(std::move(callback), std::move(result));
+}
+
+std::int32_t ArchiveCommandTracker::completeCalls(TimePoint now) {
+    std::int32_t workCount = 0;
+
+    for (auto it = inFlight_.begin(); it != inFlight_.end();) {
+        const std::int64_t correlationId = it->first;
+        InFlight& call = it->second;
+
+        ArchiveCommandResult result;
+        result.operation = call.operation;
+        result.correlationId = correlationId;
+
+        if (dispatcher_.isComplete(correlationId)) {
+            auto response = dispatcher_.take(correlationId);
+            result.code = response.code;
+            result.relevantId = response.relevantId;
+            result.recordCount = call.recordCount - response.remainingRecordCount;
+            result.errorMessage = std::move(response.errorMessage);
+        } else {
+            // a listing waits up to the timeout for every descriptor
+            const std::int32_t remainingRecordCount = dispatcher_.remainingRecordCount(correlationId);
+            if (remainingRecordCount != call.remainingRecordCount) {
+                call.remainingRecordCount = remainingRecordCount;
+                call.deadline = now + messageTimeoutNs_;
+            }
+
+            if (now <= call.deadline) {
+                ++it;
+                continue;
+            }
+
+            dispatcher_.cancel(correlationId);
+            AERON_ARCHIVE_LOG_EVENT(EventCode::TIMEOUT, controlSessionId_, correlationId, 0, 0, 0);
+            result.recordCount = call.recordCount - remainingRecordCount;
+            result.errorMessage = "awaiting response for correlationId=" + std::to_string(correlationId);
+        }
+
+        completed_.emplace_back(std::move(call.callback), std::move(result));
+        it = inFlight_.erase(it);
+        ++workCount;
+    }
+
+    return workCount;
+}
+
+void ArchiveCommandTracker::runCallbacks() {
+    for (auto& completion : completed_) {
+        if (completion.first) {
+            completion.first(completion.second);
+        }
+    }
+    completed_.clear();
+}
+
+std::int32_t ArchiveCommandTracker::inFlightCount() const { return static_cast<std::int32_t>(inFlight_.size()); }
+
+ArchiveCommandQueue::ArchiveCommandQueue(const Context& ctx, std::int32_t capacity)
+    : ctx_(ctx), messageTimeoutNs_(ctx_.messageTimeoutNs()), ring_(capacity) {
+    ctx_.conclude();
+
+    aeron_ = ctx_.aeron();
+
+    std::int64_t subId = aeron_->addSubscription(ctx_.controlResponseChannel(), ctx_.controlResponseStreamId());
+    std::shared_ptr<Subscription> subscription;
+    while (!(subscription = aeron_->findSubscription(subId))) {
+        std::this_thread::yield();
+    }
+
+    dispatcher_ = std::make_unique<ControlResponseDispatcher>(subscription, FRAGMENT_LIMIT);
+
+    std::int64_t pubId = aeron_->addExclusivePublication(ctx_.controlRequestChannel(), ctx_.controlRequestStreamId());
+    std::shared_ptr<ExclusivePublication> publication;
+    while (!(publication = aeron_->findExclusivePublication(pubId))) {
+        std::this_thread::yield();
+    }
+
+    archiveProxy_ = std::make_unique<ArchiveProxy>(publication, ctx_.messageTimeoutNs(), DEFAULT_RETRY_ATTEMPTS);
+
+    std::int64_t correlationId = aeron_->nextCorrelationId();
+
+    dispatcher_->expectResponse(ControlResponseDispatcher::ANY_SESSION, correlationId);
+    if (!archiveProxy_->connect(ctx_.controlResponseChannel(), ctx_.controlResponseStreamId(), correlationId,
+                                aeron_->conductorAgentInvoker())) {
+        throw ArchiveException("cannot connect to archive: " + ctx_.controlResponseChannel(), SOURCEINFO);
+    }
+
+    const TimePoint deadline = Clock::now() + messageTimeoutNs_;
+
+    while (!dispatcher_->isComplete(correlationId)) {
+        if (dispatcher_->poll() == 0) {
+            aeron_->conductorAgentInvoker().invoke();
+
+            if (Clock::now() > deadline) {
+                throw ArchiveException("awaiting response for correlationId=" + std::to_string(correlationId),
+                                       SOURCEINFO);
+            }
+
+            idleStrategy_.idle();
+        }
+    }
+
+    auto response = dispatcher_->take(correlationId);
+    if (response.code != codecs::ControlResponseCode::OK) {
+        throw ArchiveException("unexpected response: code=" + std::to_string(response.code) + " " +
+                                   response.errorMessage,
+                               SOURCEINFO);
+    }
+
+    controlSessionId_ = response.controlSessionId;
+    tracker_ = std::make_unique<ArchiveCommandTracker>(*dispatcher_, controlSessionId_, messageTimeoutNs_);
+    sendHandler_ = [this](ArchiveCommand& command, ArchiveCommandCallback& callback) { send(command, callback); };
+}
+
+bool ArchiveCommandQueue::offer(ArchiveCommand&& command, ArchiveCommandCallback&& callback) {
+    return ring_.offer(std::move(command), std::move(callback));
+}
+
+std::future<ArchiveCommandResult> ArchiveCommandQueue::offer(ArchiveCommand&& command) {
+    auto promise = std::make_shared<std::promise<ArchiveCommandResult>>();
+    std::future<ArchiveCommandResult> future = promise->get_future();
+
+    if (!ring_.offer(std::move(command),
+                     [promise](const ArchiveCommandResult& result) { promise->set_value(result); })) {
+        return std::future<ArchiveCommandResult>();
+    }
+
+    return future;
+}
+
+std::int32_t ArchiveCommandQueue::poll() {
+    std::int32_t workCount = ring_.drain(sendHandler_, DRAIN_LIMIT);
+
+    if (tracker_->inFlightCount() > 0) {
+        workCount += dispatcher_->poll();
+        aeron_->conductorAgentInvoker().invoke();
+        workCount += tracker_->completeCalls(Clock::now());
+    }
+
+    tracker_->runCallbacks();
+
+    return workCount;
+}
+
+std::int64_t ArchiveCommandQueue::controlSessionId() const { return controlSessionId_; }
+
+std::int32_t ArchiveCommandQueue::queuedCount() const { return ring_.size(); }
+
+std::int32_t ArchiveCommandQueue::inFlightCount() const { return tracker_->inFlightCount(); }
+
+void ArchiveCommandQueue::send(ArchiveCommand& command, ArchiveCommandCallback& callback) {
+    const std::int64_t correlationId = aeron_->nextCorrelationId();
+
+    tracker_->expect(command, correlationId);
+
+    std::string errorMessage;
+    try {
+        if (!sendRequest(command, correlationId)) {
+            errorMessage = "failed to send request: correlationId=" + std::to_string(correlationId);
+        }
+    } catch (const std::exception& e) {
+        errorMessage = e.what();
+    }
+
+    if (!errorMessage.empty()) {
+        tracker_->onSendFailed(command, correlationId, callback, std::move(errorMessage));
+        return;
+    }
+
+    tracker_->onSent(command, correlationId, callback, Clock::now());
+}
+
+bool ArchiveCommandQueue::sendRequest(const ArchiveCommand& command, std::int64_t correlationId) {
+    switch (command.operation) {
+        case ArchiveOperation::START_RECORDING:
+            return archiveProxy_->startRecording(command.channel, command.streamId, command.sourceLocation,
+                                                 correlationId, controlSessionId_);
+        case ArchiveOperation::EXTEND_RECORDING:
+            return archiveProxy_->extendRecording(command.channel, command.streamId, command.sourceLocation,
+                                                  command.recordingId, correlationId, controlSessionId_);
+        case ArchiveOperation::STOP_RECORDING:
+            if (command.subscriptionId != -1) {
+                return archiveProxy_->stopRecording(command.subscriptionId, correlationId, controlSessionId_);
+            }
+            return archiveProxy_->stopRecording(command.channel, command.streamId, correlationId, controlSessionId_);
+        case ArchiveOperation::START_REPLAY:
+            return archiveProxy_->replay(command.recordingId, command.position, command.length, command.channel,
+                                         command.streamId, correlationId, controlSessionId_);
+        case ArchiveOperation::STOP_REPLAY:
+            return archiveProxy_->stopReplay(command.replaySessionId, correlationId, controlSessionId_);
+        case ArchiveOperation::LIST_RECORDINGS:
+            return archiveProxy_->listRecordings(command.recordingId, command.recordCount, correlationId,
+                                                 controlSessionId_);
+        case ArchiveOperation::LIST_RECORDINGS_FOR_URI:
+            return archiveProxy_->listRecordingsForUri(command.recordingId, command.recordCount, command.channel,
+                                                       command.streamId, correlationId, controlSessionId_);
+        case ArchiveOperation::LIST_RECORDING:
+            return archiveProxy_->listRecording(command.recordingId, correlationId, controlSessionId_);
+        case ArchiveOperation::GET_RECORDING_POSITION:
+            return archiveProxy_->getRecordingPosition(command.recordingId, correlationId, controlSessionId_);
+        case ArchiveOperation::TRUNCATE_RECORDING:
+            return archiveProxy_->truncateRecording(command.recordingId, command.position, correlationId,
+                                                    controlSessionId_);
+        case ArchiveOperation::GET_STOP_POSITION:
+            return archiveProxy_->getStopPosition(command.recordingId, correlationId, controlSessionId_);
+        case ArchiveOperation::FIND_LAST_MATCHING_RECORDING:
+            return archiveProxy_->findLastMatchingRecording(command.recordingId, command.channel, command.streamId,
+                                                            command.sessionId, correlationId, controlSessionId_);
+    }
+
+    throw ArchiveException("unknown operation: " + std::to_string(static_cast<std::int32_t>(command.operation)),
+                           SOURCEINFO);
+}
+
+}  // namespace archive
+}  // namespace aeron
@@ -0,0 +1,234 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <Aeron.h>
+#include <concurrent/YieldingIdleStrategy.h>
+
+#include "io_aeron_archive_codecs/ControlResponseCode.h"
+#include "io_aeron_archive_codecs/SourceLocation.h"
+
+#include "ArchiveOperation.h"
+#include "ArchiveProxy.h"
+#include "Context.h"
+#include "ControlResponseDispatcher.h"
+
+namespace aeron {
+namespace archive {
+
+// A control request with its arguments, built by the factory matching the AeronArchive call.
+struct ArchiveCommand {
+    static ArchiveCommand startRecording(const std::string& channel, std::int32_t streamId,
+                                         io::aeron::archive::codecs::SourceLocation::Value sourceLocation);
+    static ArchiveCommand extendRecording(std::int64_t recordingId, const std::string& channel, std::int32_t streamId,
+                                          io::aeron::archive::codecs::SourceLocation::Value sourceLocation);
+    static ArchiveCommand stopRecording(const std::string& channel, std::int32_t streamId);
+    static ArchiveCommand stopRecording(std::int64_t subscriptionId);
+    static ArchiveCommand startReplay(std::int64_t recordingId, std::int64_t position, std::int64_t length,
+                                      const std::string& replayChannel, std::int32_t replayStreamId);
+    static ArchiveCommand stopReplay(std::int64_t replaySessionId);
+    static ArchiveCommand listRecordings(std::int64_t fromRecordingId, std::int32_t recordCount,
+                                         RecordingDescriptorConsumer&& consumer);
+    static ArchiveCommand listRecordingsForUri(std::int64_t fromRecordingId, std::int32_t recordCount,
+                                               const std::string& channelFragment, std::int32_t streamId,
+                                               RecordingDescriptorConsumer&& consumer);
+    static ArchiveCommand listRecording(std::int64_t recordingId, RecordingDescriptorConsumer&& consumer);
+    static ArchiveCommand getRecordingPosition(std::int64_t recordingId);
+    static ArchiveCommand getStopPosition(std::int64_t recordingId);
+    static ArchiveCommand truncateRecording(std::int64_t recordingId, std::int64_t position);
+    static ArchiveCommand findLastMatchingRecording(std::int64_t minRecordingId, const std::string& channelFragment,
+                                                    std::int32_t streamId, std::int32_t sessionId);
+
+    bool isListing() const;
+
+    ArchiveOperation operation{ArchiveOperation::GET_RECORDING_POSITION};
+    // the recorded or replay channel, or the channel fragment to match
+    std::string channel;
+    std::int32_t streamId{0};
+    io::aeron::archive::codecs::SourceLocation::Value sourceLocation{
+        io::aeron::archive::codecs::SourceLocation::LOCAL};
+    std::int64_t recordingId{-1};
+    std::int64_t position{0};
+    std::int64_t length{0};
+    // stops a recording by subscription id instead of channel and stream id when set
+    std::int64_t subscriptionId{-1};
+    std::int64_t replaySessionId{-1};
+    std::int32_t recordCount{0};
+    std::int32_t sessionId{0};
+    RecordingDescriptorConsumer consumer;
+};
+
+struct ArchiveCommandResult {
+    ArchiveOperation operation{ArchiveOperation::GET_RECORDING_POSITION};
+    std::int64_t correlationId{-1};
+    // NULL_VALUE when the request could not be sent or its response did not arrive in time
+    io::aeron::archive::codecs::ControlResponseCode::Value code{
+        io::aeron::archive::codecs::ControlResponseCode::NULL_VALUE};
+    std::int64_t relevantId{-1};
+    // descriptors received by a listing
+    std::int32_t recordCount{0};
+    std::string errorMessage;
+
+    bool isSuccess() const;
+};
+
+using ArchiveCommandCallback = std::function<void(const ArchiveCommandResult& result)>;
+
+// Bounded multi producer, single consumer ring of preallocated command slots after Dmitry Vyukov's bounded queue.
+// A producer claims a slot with one CAS on the tail and publishes it through the slot sequence, the consumer frees it
+// the same way. Producers never block on each other or on the consumer, but one may retry its CAS while others claim
+// slots, so offering is lock free rather than wait free. The command is moved into its slot, and left untouched when
+// the ring is full. Offering is not allocation free though: the command factories build their std::string arguments,
+// a callback may allocate its captures and the future overload of ArchiveCommandQueue::offer allocates its shared
+// promise.
+class ArchiveCommandRing {
+public:
+    using CommandHandler = std::function<void(ArchiveCommand& command, ArchiveCommandCallback& callback)>;
+
+    // the capacity is rounded up to a power of two
+    explicit ArchiveCommandRing(std::int32_t capacity);
+
+    ArchiveCommandRing(const ArchiveCommandRing&) = delete;
+    ArchiveCommandRing& operator=(const ArchiveCommandRing&) = delete;
+
+    // any thread, false when the ring is full
+    bool offer(ArchiveCommand&& command, ArchiveCommandCallback&& callback);
+    // the consumer thread only, returns the number of commands handled
+    std::int32_t drain(const CommandHandler& handler, std::int32_t limit);
+
+    std::int32_t capacity() const;
+    // approximate when producers are active
+    std::int32_t size() const;
+
+private:
+    struct Slot {
+        std::atomic<std::int64_t> sequence;
+        ArchiveCommand command;
+        ArchiveCommandCallback callback;
+    };
+
+    const std::int64_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(64) std::atomic<std::int64_t> tail_{0};
+    alignas(64) std::atomic<std::int64_t> head_{0};
+};
+
+// Follows the commands sent by an ArchiveCommandQueue until their response, descriptors or timeout. Each call waits
+// up to the message timeout for its response, a listing gets a fresh timeout with every descriptor. Completions are
+// collected and only handed to their callbacks by runCallbacks(). Not thread safe, used by the owner thread only.
+class ArchiveCommandTracker {
+public:
+    using Clock = std::chrono::high_resolution_clock;
+    using TimePoint = Clock::time_point;
+
+    ArchiveCommandTracker(ControlResponseDispatcher& dispatcher, std::int64_t controlSessionId,
+                          std::chrono::nanoseconds messageTimeoutNs);
+
+    ArchiveCommandTracker(const ArchiveCommandTracker&) = delete;
+    ArchiveCommandTracker& operator=(const ArchiveCommandTracker&) = delete;
+
+    // registers the call with the dispatcher, before its request is sent so no response is missed
+    void expect(ArchiveCommand& command, std::int64_t correlationId);
+    void onSent(const ArchiveCommand& command, std::int64_t correlationId, ArchiveCommandCallback& callback,
+                TimePoint now);
+    // completes the call at once with the reason it could not be sent
+    void onSendFailed(const ArchiveCommand& command, std::int64_t correlationId, ArchiveCommandCallback& callback,
+                      std::string&& errorMessage);
+
+    // completes the answered calls and those past their deadline, returns the number completed
+    std::int32_t completeCalls(TimePoint now);
+    // callbacks run last so one offering from within a callback cannot disturb the sweep
+    void runCallbacks();
+
+    std::int32_t inFlightCount() const;
+
+private:
+    struct InFlight {
+        ArchiveOperation operation;
+        ArchiveCommandCallback callback;
+        TimePoint deadline;
+        std::int32_t recordCount;
+        std::int32_t remainingRecordCount;
+    };
+
+private:
+    ControlResponseDispatcher& dispatcher_;
+    const std::int64_t controlSessionId_;
+    const std::chrono::nanoseconds messageTimeoutNs_;
+
+    std::unordered_map<std::int64_t, InFlight> inFlight_;
+    std::vector<std::pair<ArchiveCommandCallback, ArchiveCommandResult>> completed_;
+};
+
+// Lets any thread fire archive commands without blocking while a single owner thread touches the control session.
+// Commands are offered to a ring and poll(), called by the owner thread only, sends them through its own control
+// session, routes responses with a ControlResponseDispatcher and completes every command through its callback or
+// future on the owner thread. Several commands may be in flight at once, each times out on its own.
+class ArchiveCommandQueue {
+    using Clock = std::chrono::high_resolution_clock;
+    using TimePoint = Clock::time_point;
+
+public:
+    // connects the control session on the calling thread
+    ArchiveCommandQueue(const Context& ctx, std::int32_t capacity);
+
+    ArchiveCommandQueue(const ArchiveCommandQueue&) = delete;
+    ArchiveCommandQueue& operator=(const ArchiveCommandQueue&) = delete;
+
+    // any thread, false when the queue is full
+    bool offer(ArchiveCommand&& command, ArchiveCommandCallback&& callback);
+    // any thread, an invalid future when the queue is full
+    std::future<ArchiveCommandResult> offer(ArchiveCommand&& command);
+
+    // the owner thread only: sends queued commands and completes the answered or timed out ones, callbacks run
+    // from here and must not throw
+    std::int32_t poll();
+
+    std::int64_t controlSessionId() const;
+    std::int32_t queuedCount() const;
+    // owner thread only
+    std::int32_t inFlightCount() const;
+
+private:
+    void send(ArchiveCommand& command, ArchiveCommandCallback& callback);
+    bool sendRequest(const ArchiveCommand& command, std::int64_t correlationId);
+
+private:
+    Context ctx_;
+    std::shared_ptr<aeron::Aeron> aeron_;
+    std::unique_ptr<ControlResponseDispatcher> dispatcher_;
+    std::unique_ptr<ArchiveProxy> archiveProxy_;
+    aeron::concurrent::YieldingIdleStrategy idleStrategy_;
+    const std::chrono::nanoseconds messageTimeoutNs_;
+    std::int64_t controlSessionId_{-1};
+
+    ArchiveCommandRing ring_;
+    ArchiveCommandRing::CommandHandler sendHandler_;
+    std::unique_ptr<ArchiveCommandTracker> tracker_;
+};
+
+}  // namespace archive
+}  // namespace aeron
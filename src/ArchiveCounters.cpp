@@ -0,0 +1,76 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <thread>
+
+#include "ArchiveCounters.h"
+
+namespace aeron {
+namespace archive {
+
+constexpr std::int32_t ArchiveCounters::REQUESTS_SENT_TYPE_ID;
+constexpr std::int32_t ArchiveCounters::RESPONSES_RECEIVED_TYPE_ID;
+constexpr std::int32_t ArchiveCounters::ERRORS_TYPE_ID;
+constexpr std::int32_t ArchiveCounters::TIMEOUTS_TYPE_ID;
+constexpr std::int32_t ArchiveCounters::OFFER_RETRIES_TYPE_ID;
+constexpr std::int32_t ArchiveCounters::BACK_PRESSURE_EVENTS_TYPE_ID;
+constexpr std::int32_t ArchiveCounters::IN_FLIGHT_TYPE_ID;
+
+ArchiveCounters::ArchiveCounters(Aeron& aeron, std::int64_t controlSessionId)
+    : controlSessionId_(controlSessionId)
+    , requestsSent_(addCounter(aeron, REQUESTS_SENT_TYPE_ID, controlSessionId, "requests sent"))
+    , responsesReceived_(addCounter(aeron, RESPONSES_RECEIVED_TYPE_ID, controlSessionId, "responses received"))
+    , errors_(addCounter(aeron, ERRORS_TYPE_ID, controlSessionId, "errors"))
+    , timeouts_(addCounter(aeron, TIMEOUTS_TYPE_ID, controlSessionId, "timeouts"))
+    , offerRetries_(addCounter(aeron, OFFER_RETRIES_TYPE_ID, controlSessionId, "offer retries"))
+    , backPressureEvents_(addCounter(aeron, BACK_PRESSURE_EVENTS_TYPE_ID, controlSessionId, "back pressure events"))
+    , inFlight_(addCounter(aeron, IN_FLIGHT_TYPE_ID, controlSessionId, "requests in flight")) {}
+
+void ArchiveCounters::onRequestSent() {
+    requestsSent_->increment();
+    inFlight_->increment();
+}
+
+void ArchiveCounters::onRequestCompleted() { inFlight_->add(-1); }
+
+void ArchiveCounters::onResponseReceived() { responsesReceived_->increment(); }
+
+void ArchiveCounters::onError() { errors_->increment(); }
+
+void ArchiveCounters::onTimeout() { timeouts_->increment(); }
+
+void ArchiveCounters::onOfferRetry() { offerRetries_->increment(); }
+
+void ArchiveCounters::onBackPressure() { backPressureEvents_->increment(); }
+
+std::int64_t ArchiveCounters::controlSessionId() const { return controlSessionId_; }
+
+std::shared_ptr<Counter> ArchiveCounters::addCounter(Aeron& aeron, std::int32_t typeId,
+                                                     std::int64_t controlSessionId, const std::string& name) {
+    const std::string label = "archive client " + name + ": controlSessionId=" + std::to_string(controlSessionId);
+
+    std::int64_t counterId = aeron.addCounter(typeId, reinterpret_cast<const std::uint8_t*>(&controlSessionId),
+                                              sizeof(controlSessionId), label);
+    std::shared_ptr<Counter> counter;
+    while (!(counter = aeron.findCounter(counterId))) {
+        std::this_thread::yield();
+    }
+
+    return counter;
+}
+
+}  // namespace archive
+}  // namespace aeron
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <Aeron.h>
+
+#include "CounterTypes.h"
+
+namespace aeron {
+namespace archive {
+
+// Aeron counters of the control plane of one archive session, keyed by the control session id so they can be
+// read with AeronStat or any CountersReader. Updating one is a single atomic add.
+class ArchiveCounters {
+public:
+    static constexpr std::int32_t REQUESTS_SENT_TYPE_ID = REQUESTS_SENT_COUNTER_TYPE_ID;
+    static constexpr std::int32_t RESPONSES_RECEIVED_TYPE_ID = RESPONSES_RECEIVED_COUNTER_TYPE_ID;
+    static constexpr std::int32_t ERRORS_TYPE_ID = ERRORS_COUNTER_TYPE_ID;
+    static constexpr std::int32_t TIMEOUTS_TYPE_ID = TIMEOUTS_COUNTER_TYPE_ID;
+    static constexpr std::int32_t OFFER_RETRIES_TYPE_ID = OFFER_RETRIES_COUNTER_TYPE_ID;
+    static constexpr std::int32_t BACK_PRESSURE_EVENTS_TYPE_ID = BACK_PRESSURE_EVENTS_COUNTER_TYPE_ID;
+    static constexpr std::int32_t IN_FLIGHT_TYPE_ID = IN_FLIGHT_COUNTER_TYPE_ID;
+
+    ArchiveCounters(aeron::Aeron& aeron, std::int64_t controlSessionId);
+
+    ArchiveCounters(const ArchiveCounters&) = delete;
+    ArchiveCounters& operator=(const ArchiveCounters&) = delete;
+
+    void onRequestSent();
+    void onRequestCompleted();
+    void onResponseReceived();
+    void onError();
+    void onTimeout();
+    void onOfferRetry();
+    void onBackPressure();
+
+    std::int64_t controlSessionId() const;
+
+private:
+    static std::shared_ptr<aeron::Counter> addCounter(aeron::Aeron& aeron, std::int32_t typeId,
+                                                      std::int64_t controlSessionId, const std::string& name);
+
+private:
+    const std::int64_t controlSessionId_;
+    std::shared_ptr<aeron::Counter> requestsSent_;
+    std::shared_ptr<aeron::Counter> responsesReceived_;
+    std::shared_ptr<aeron::Counter> errors_;
+    std::shared_ptr<aeron::Counter> timeouts_;
+    std::shared_ptr<aeron::Counter> offerRetries_;
+    std::shared_ptr<aeron::Counter> backPressureEvents_;
+    std::shared_ptr<aeron::Counter> inFlight_;
+};
+
+}  // namespace archive
+}  // namespace aeron
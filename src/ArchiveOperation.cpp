@@ -0,0 +1,54 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ArchiveOperation.h"
+
+namespace aeron {
+namespace archive {
+
+const char* operationName(ArchiveOperation operation) {
+    switch (operation) {
+        case ArchiveOperation::START_RECORDING:
+            return "start recording";
+        case ArchiveOperation::EXTEND_RECORDING:
+            return "extend recording";
+        case ArchiveOperation::STOP_RECORDING:
+            return "stop recording";
+        case ArchiveOperation::START_REPLAY:
+            return "start replay";
+        case ArchiveOperation::STOP_REPLAY:
+            return "stop replay";
+        case ArchiveOperation::LIST_RECORDINGS:
+            return "list recordings";
+        case ArchiveOperation::LIST_RECORDINGS_FOR_URI:
+            return "list recordings for URI";
+        case ArchiveOperation::LIST_RECORDING:
+            return "list recording";
+        case ArchiveOperation::GET_RECORDING_POSITION:
+            return "get recording position";
+        case ArchiveOperation::TRUNCATE_RECORDING:
+            return "truncate recording";
+        case ArchiveOperation::GET_STOP_POSITION:
+            return "get recording stop position";
+        case ArchiveOperation::FIND_LAST_MATCHING_RECORDING:
+            return "find last matching recording";
+    }
+
+    return "unknown";
+}
+
+}  // namespace archive
+}  // namespace aeron
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace aeron {
+namespace archive {
+
+// control operations of an archive session which are timed individually
+enum class ArchiveOperation : std::int32_t {
+    START_RECORDING,
+    EXTEND_RECORDING,
+    STOP_RECORDING,
+    START_REPLAY,
+    STOP_REPLAY,
+    LIST_RECORDINGS,
+    LIST_RECORDINGS_FOR_URI,
+    LIST_RECORDING,
+    GET_RECORDING_POSITION,
+    TRUNCATE_RECORDING,
+    GET_STOP_POSITION,
+    FIND_LAST_MATCHING_RECORDING
+};
+
+constexpr std::int32_t ARCHIVE_OPERATION_COUNT =
+    static_cast<std::int32_t>(ArchiveOperation::FIND_LAST_MATCHING_RECORDING) + 1;
+
+const char* operationName(ArchiveOperation operation);
+
+}  // namespace archive
+}  // namespace aeron
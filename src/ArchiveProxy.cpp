@@ -32,9 +32,40 @@
 
 #include "ArchiveException.h"
 #include "ArchiveProxy.h"
+#include "EventLog.h"
 
 namespace codecs = io::aeron::archive::codecs;
 
+namespace {
+
+const std::int64_t NULL_VALUE = -1;
+
+// every request but connect starts with the control session id followed by the correlation id
+std::int64_t controlSessionIdOf(const aeron::concurrent::AtomicBuffer& buffer) {
+    const std::uint16_t templateId = buffer.getUInt16(codecs::MessageHeader::templateIdEncodingOffset());
+    if (templateId == codecs::ConnectRequest::sbeTemplateId()) {
+        return NULL_VALUE;
+    }
+
+    return buffer.getInt64(codecs::MessageHeader::encodedLength() +
+                           codecs::StopReplayRequest::controlSessionIdEncodingOffset());
+}
+
+std::int64_t correlationIdOf(const aeron::concurrent::AtomicBuffer& buffer) {
+    const std::uint16_t templateId = buffer.getUInt16(codecs::MessageHeader::templateIdEncodingOffset());
+    if (templateId == codecs::ConnectRequest::sbeTemplateId()) {
+        return buffer.getInt64(codecs::MessageHeader::encodedLength() +
+                               codecs::ConnectRequest::correlationIdEncodingOffset());
+    } else if (templateId == codecs::CloseSessionRequest::sbeTemplateId()) {
+        return NULL_VALUE;
+    }
+
+    return buffer.getInt64(codecs::MessageHeader::encodedLength() +
+                           codecs::StopReplayRequest::correlationIdEncodingOffset());
+}
+
+}  // namespace
+
 namespace aeron {
 namespace archive {
 
@@ -45,6 +76,8 @@ ArchiveProxy::ArchiveProxy(const std::shared_ptr<aeron::ExclusivePublication>& p
     , connectTimeoutNs_(connectTimeoutNs)
     , retryAttempts_(retryAttempts) {}
 
+void ArchiveProxy::counters(ArchiveCounters* counters) { counters_ = counters; }
+
 bool ArchiveProxy::connect(const std::string& responseChannel, std::int32_t responseStreamId,
                            std::int64_t correlationId) {
     codecs::ConnectRequest msg;
@@ -265,6 +298,9 @@ bool ArchiveProxy::offer(std::int32_t length) {
     while (true) {
         std::int64_t result = publication_->offer(buffer_, 0, codecs::MessageHeader::encodedLength() + length);
         if (result > 0) {
+            AERON_ARCHIVE_LOG_EVENT(EventCode::REQUEST_SENT, retryAttempts_ - attempts + 1,
+                                    controlSessionIdOf(buffer_), correlationIdOf(buffer_),
+                                    buffer_.getUInt16(codecs::MessageHeader::templateIdEncodingOffset()), length);
             return true;
         }
 
@@ -276,6 +312,8 @@ bool ArchiveProxy::offer(std::int32_t length) {
             throw ArchiveException("offer failed due to max position being reached", SOURCEINFO);
         }
 
+        onOfferRetry(result);
+
         if (--attempts <= 0) {
             return false;
         }
@@ -287,9 +325,14 @@ bool ArchiveProxy::offer(std::int32_t length) {
 bool ArchiveProxy::offerWithTimeout(std::int32_t length,
                                     aeron::AgentInvoker<aeron::ClientConductor>* aeronClientInvoker) {
     auto deadline = std::chrono::high_resolution_clock::now() + connectTimeoutNs_;
+    std::int32_t attempts = 0;
     while (true) {
+        ++attempts;
         std::int64_t result = publication_->offer(buffer_, 0, codecs::MessageHeader::encodedLength() + length);
         if (result > 0) {
+            AERON_ARCHIVE_LOG_EVENT(EventCode::REQUEST_SENT, attempts, controlSessionIdOf(buffer_),
+                                    correlationIdOf(buffer_),
+                                    buffer_.getUInt16(codecs::MessageHeader::templateIdEncodingOffset()), length);
             return true;
         }
 
@@ -299,6 +342,8 @@ bool ArchiveProxy::offerWithTimeout(std::int32_t length,
             throw ArchiveException("offer failed due to max position being reached", SOURCEINFO);
         }
 
+        onOfferRetry(result);
+
         if (std::chrono::high_resolution_clock::now() > deadline) {
             return false;
         }
@@ -311,5 +356,14 @@ bool ArchiveProxy::offerWithTimeout(std::int32_t length,
     }
 }
 
+void ArchiveProxy::onOfferRetry(std::int64_t result) {
+    if (counters_) {
+        counters_->onOfferRetry();
+        if (result == aeron::BACK_PRESSURED || result == aeron::ADMIN_ACTION) {
+            counters_->onBackPressure();
+        }
+    }
+}
+
 }  // namespace archive
 }  // namespace aeron
@@ -24,6 +24,8 @@
 #include "io_aeron_archive_codecs/MessageHeader.h"
 #include "io_aeron_archive_codecs/SourceLocation.h"
 
+#include "ArchiveCounters.h"
+
 namespace aeron {
 namespace archive {
 
@@ -32,6 +34,9 @@ public:
     ArchiveProxy(const std::shared_ptr<aeron::ExclusivePublication>& publication, std::int64_t connectTimeoutNs,
                  std::int32_t retryAttempts);
 
+    // counters are optional and not owned, offer retries and back pressure are counted when set
+    void counters(ArchiveCounters* counters);
+
     bool connect(const std::string& responseChannel, std::int32_t responseStreamId, std::int64_t correlationId);
 
     bool tryConnect(const std::string& responseChannel, std::int32_t responseStreamId, std::int64_t correlationId);
@@ -94,6 +99,7 @@ private:
 
     bool offer(std::int32_t length);
     bool offerWithTimeout(std::int32_t length, aeron::AgentInvoker<aeron::ClientConductor>* aeronClientInvoker);
+    void onOfferRetry(std::int64_t result);
 
 private:
     std::shared_ptr<aeron::ExclusivePublication> publication_;
@@ -104,6 +110,7 @@ private:
     concurrent::AtomicBuffer buffer_;
     const std::chrono::nanoseconds connectTimeoutNs_;
     const std::int32_t retryAttempts_;
+    ArchiveCounters* counters_{nullptr};
 };
 
 }  // namespace archive
@@ -0,0 +1,400 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <thread>
+
+#include "ArchiveException.h"
+#include "ArchiveSessionMultiplexer.h"
+#include "EventLog.h"
+
+namespace codecs = io::aeron::archive::codecs;
+
+namespace {
+
+const std::int32_t FRAGMENT_LIMIT = 10;
+const std::int32_t DEFAULT_RETRY_ATTEMPTS = 3;
+
+}  // namespace
+
+namespace aeron {
+namespace archive {
+
+ControlSessionRegistry::ControlSessionRegistry(ControlResponseDispatcher& dispatcher) : dispatcher_(dispatcher) {}
+
+void ControlSessionRegistry::expectConnect(std::int64_t correlationId) {
+    dispatcher_.expectResponse(ControlResponseDispatcher::ANY_SESSION, correlationId);
+}
+
+std::int64_t ControlSessionRegistry::onConnected(const ControlResponseDispatcher::Response& response) {
+    if (response.code != codecs::ControlResponseCode::OK) {
+        throw ArchiveException("unexpected response: code=" + std::to_string(response.code) + " " +
+                                   response.errorMessage,
+                               SOURCEINFO);
+    }
+
+    sessions_.insert(response.controlSessionId);
+
+    return response.controlSessionId;
+}
+
+void ControlSessionRegistry::expectCall(std::int64_t controlSessionId, std::int64_t correlationId,
+                                        std::int32_t recordCount, RecordingDescriptorConsumer&& consumer) {
+    if (sessions_.count(controlSessionId) == 0) {
+        throw ArchiveException("control session is closed: controlSessionId=" + std::to_string(controlSessionId),
+                               SOURCEINFO);
+    }
+
+    if (consumer) {
+        dispatcher_.expectDescriptors(controlSessionId, correlationId, recordCount, std::move(consumer));
+    } else {
+        dispatcher_.expectResponse(controlSessionId, correlationId);
+    }
+}
+
+bool ControlSessionRegistry::close(std::int64_t controlSessionId) { return sessions_.erase(controlSessionId) > 0; }
+
+std::int32_t ControlSessionRegistry::sessionCount() const { return static_cast<std::int32_t>(sessions_.size()); }
+
+ArchiveSessionMultiplexer::Session::Session(ArchiveSessionMultiplexer& multiplexer, std::int64_t controlSessionId)
+    : multiplexer_(multiplexer), controlSessionId_(controlSessionId) {}
+
+ArchiveSessionMultiplexer::Session::~Session() {
+    if (!isClosed_) {
+        // the archive times the session out should the request not get through
+        try {
+            multiplexer_.closeSession(controlSessionId_);
+        } catch (...) {
+        }
+    }
+}
+
+std::int64_t ArchiveSessionMultiplexer::Session::controlSessionId() const { return controlSessionId_; }
+
+void ArchiveSessionMultiplexer::Session::close() {
+    if (!isClosed_) {
+        isClosed_ = true;
+        multiplexer_.closeSession(controlSessionId_);
+    }
+}
+
+std::int64_t ArchiveSessionMultiplexer::Session::startRecording(const std::string& channel, std::int32_t streamId,
+                                                                codecs::SourceLocation::Value sourceLocation) {
+    return multiplexer_.callAndPollForResponse(controlSessionId_, [&](std::int64_t correlationId) {
+        return multiplexer_.archiveProxy_->startRecording(channel, streamId, sourceLocation, correlationId,
+                                                          controlSessionId_);
+    });
+}
+
+std::int64_t ArchiveSessionMultiplexer::Session::extendRecording(std::int64_t recordingId, const std::string& channel,
+                                                                 std::int32_t streamId,
+                                                                 codecs::SourceLocation::Value sourceLocation) {
+    return multiplexer_.callAndPollForResponse(controlSessionId_, [&](std::int64_t correlationId) {
+        return multiplexer_.archiveProxy_->extendRecording(channel, streamId, sourceLocation, recordingId,
+                                                           correlationId, controlSessionId_);
+    });
+}
+
+void ArchiveSessionMultiplexer::Session::stopRecording(const std::string& channel, std::int32_t streamId) {
+    multiplexer_.callAndPollForResponse(controlSessionId_, [&](std::int64_t correlationId) {
+        return multiplexer_.archiveProxy_->stopRecording(channel, streamId, correlationId, controlSessionId_);
+    });
+}
+
+void ArchiveSessionMultiplexer::Session::stopRecording(std::int64_t subscriptionId) {
+    multiplexer_.callAndPollForResponse(controlSessionId_, [&](std::int64_t correlationId) {
+        return multiplexer_.archiveProxy_->stopRecording(subscriptionId, correlationId, controlSessionId_);
+    });
+}
+
+std::int64_t ArchiveSessionMultiplexer::Session::startReplay(std::int64_t recordingId, std::int64_t position,
+                                                             std::int64_t length, const std::string& replayChannel,
+                                                             std::int32_t replayStreamId) {
+    return multiplexer_.callAndPollForResponse(controlSessionId_, [&](std::int64_t correlationId) {
+        return multiplexer_.archiveProxy_->replay(recordingId, position, length, replayChannel, replayStreamId,
+                                                  correlationId, controlSessionId_);
+    });
+}
+
+void ArchiveSessionMultiplexer::Session::stopReplay(std::int64_t replaySessionId) {
+    multiplexer_.callAndPollForResponse(controlSessionId_, [&](std::int64_t correlationId) {
+        return multiplexer_.archiveProxy_->stopReplay(replaySessionId, correlationId, controlSessionId_);
+    });
+}
+
+std::int32_t ArchiveSessionMultiplexer::Session::listRecordings(std::int64_t fromRecordingId,
+                                                                std::int32_t recordCount,
+                                                                RecordingDescriptorConsumer&& consumer) {
+    return multiplexer_.callAndPollForDescriptors(
+        controlSessionId_,
+        [&](std::int64_t correlationId) {
+            return multiplexer_.archiveProxy_->listRecordings(fromRecordingId, recordCount, correlationId,
+                                                              controlSessionId_);
+        },
+        recordCount, std::move(consumer));
+}
+
+std::int32_t ArchiveSessionMultiplexer::Session::listRecordingsForUri(std::int64_t fromRecordingId,
+                                                                      std::int32_t recordCount,
+                                                                      const std::string& channelFragment,
+                                                                      std::int32_t streamId,
+                                                                      RecordingDescriptorConsumer&& consumer) {
+    return multiplexer_.callAndPollForDescriptors(
+        controlSessionId_,
+        [&](std::int64_t correlationId) {
+            return multiplexer_.archiveProxy_->listRecordingsForUri(fromRecordingId, recordCount, channelFragment,
+                                                                    streamId, correlationId, controlSessionId_);
+        },
+        recordCount, std::move(consumer));
+}
+
+std::int32_t ArchiveSessionMultiplexer::Session::listRecording(std::int64_t recordingId,
+                                                               RecordingDescriptorConsumer&& consumer) {
+    return multiplexer_.callAndPollForDescriptors(
+        controlSessionId_,
+        [&](std::int64_t correlationId) {
+            return multiplexer_.archiveProxy_->listRecording(recordingId, correlationId, controlSessionId_);
+        },
+        1, std::move(consumer));
+}
+
+std::int64_t ArchiveSessionMultiplexer::Session::getRecordingPosition(std::int64_t recordingId) {
+    return multiplexer_.callAndPollForResponse(controlSessionId_, [&](std::int64_t correlationId) {
+        return multiplexer_.archiveProxy_->getRecordingPosition(recordingId, correlationId, controlSessionId_);
+    });
+}
+
+std::int64_t ArchiveSessionMultiplexer::Session::getStopPosition(std::int64_t recordingId) {
+    return multiplexer_.callAndPollForResponse(controlSessionId_, [&](std::int64_t correlationId) {
+        return multiplexer_.archiveProxy_->getStopPosition(recordingId, correlationId, controlSessionId_);
+    });
+}
+
+void ArchiveSessionMultiplexer::Session::truncateRecording(std::int64_t recordingId, std::int64_t position) {
+    multiplexer_.callAndPollForResponse(controlSessionId_, [&](std::int64_t correlationId) {
+        return multiplexer_.archiveProxy_->truncateRecording(recordingId, position, correlationId, controlSessionId_);
+    });
+}
+
+std::int64_t ArchiveSessionMultiplexer::Session::findLastMatchingRecording(std::int64_t minRecordingId,
+                                                                           const std::string& channelFragment,
+                                                                           std::int32_t streamId,
+                                                                           std::int32_t sessionId) {
+    return multiplexer_.callAndPollForResponse(controlSessionId_, [&](std::int64_t correlationId) {
+        return multiplexer_.archiveProxy_->findLastMatchingRecording(minRecordingId, channelFragment, streamId,
+                                                                     sessionId, correlationId, controlSessionId_);
+    });
+}
+
+ArchiveSessionMultiplexer::ArchiveSessionMultiplexer(const Context& ctx)
+    : ctx_(ctx), messageTimeoutNs_(ctx_.messageTimeoutNs()) {
+    ctx_.conclude();
+
+    aeron_ = ctx_.aeron();
+
+    std::int64_t subId = aeron_->addSubscription(ctx_.controlResponseChannel(), ctx_.controlResponseStreamId());
+    std::shared_ptr<Subscription> subscription;
+    while (!(subscription = aeron_->findSubscription(subId))) {
+        std::this_thread::yield();
+    }
+
+    dispatcher_ = std::make_unique<ControlResponseDispatcher>(subscription, FRAGMENT_LIMIT);
+    sessions_ = std::make_unique<ControlSessionRegistry>(*dispatcher_);
+
+    std::int64_t pubId = aeron_->addExclusivePublication(ctx_.controlRequestChannel(), ctx_.controlRequestStreamId());
+    std::shared_ptr<ExclusivePublication> publication;
+    while (!(publication = aeron_->findExclusivePublication(pubId))) {
+        std::this_thread::yield();
+    }
+
+    archiveProxy_ = std::make_unique<ArchiveProxy>(publication, ctx_.messageTimeoutNs(), DEFAULT_RETRY_ATTEMPTS);
+}
+
+std::shared_ptr<ArchiveSessionMultiplexer::Session> ArchiveSessionMultiplexer::openSession() {
+    std::int64_t correlationId = aeron_->nextCorrelationId();
+    const TimePoint deadline = Clock::now() + messageTimeoutNs_;
+
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+
+        sessions_->expectConnect(correlationId);
+        if (!archiveProxy_->connect(ctx_.controlResponseChannel(), ctx_.controlResponseStreamId(), correlationId,
+                                    aeron_->conductorAgentInvoker())) {
+            dispatcher_->cancel(correlationId);
+            throw ArchiveException("cannot connect to archive: " + ctx_.controlResponseChannel(), SOURCEINFO);
+        }
+    }
+
+    awaitConnection(correlationId, deadline);
+
+    auto response = awaitResponse(correlationId);
+    std::int64_t controlSessionId;
+
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+        controlSessionId = sessions_->onConnected(response);
+    }
+
+    return std::make_shared<Session>(*this, controlSessionId);
+}
+
+const Context& ArchiveSessionMultiplexer::context() const { return ctx_; }
+
+std::int32_t ArchiveSessionMultiplexer::sessionCount() {
+    std::unique_lock<std::mutex> lock(lock_);
+    return sessions_->sessionCount();
+}
+
+const std::shared_ptr<Subscription>& ArchiveSessionMultiplexer::subscription() const {
+    return dispatcher_->subscription();
+}
+
+std::int64_t ArchiveSessionMultiplexer::callAndPollForResponse(std::int64_t controlSessionId,
+                                                               std::function<bool(std::int64_t)>&& f) {
+    auto response = call(controlSessionId, std::move(f), 0, RecordingDescriptorConsumer());
+
+    if (response.code != codecs::ControlResponseCode::OK) {
+        throw ArchiveException("unexpected response: code=" + std::to_string(response.code), SOURCEINFO);
+    }
+
+    return response.relevantId;
+}
+
+std::int32_t ArchiveSessionMultiplexer::callAndPollForDescriptors(std::int64_t controlSessionId,
+                                                                  std::function<bool(std::int64_t)>&& f,
+                                                                  std::int32_t recordCount,
+                                                                  RecordingDescriptorConsumer&& consumer) {
+    auto response = call(controlSessionId, std::move(f), recordCount, std::move(consumer));
+
+    return recordCount - response.remainingRecordCount;
+}
+
+ControlResponseDispatcher::Response ArchiveSessionMultiplexer::call(std::int64_t controlSessionId,
+                                                                    std::function<bool(std::int64_t)>&& f,
+                                                                    std::int32_t recordCount,
+                                                                    RecordingDescriptorConsumer&& consumer) {
+    std::int64_t correlationId = aeron_->nextCorrelationId();
+
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+
+        sessions_->expectCall(controlSessionId, correlationId, recordCount, std::move(consumer));
+
+        try {
+            if (!f(correlationId)) {
+                throw ArchiveException("failed to send request: controlSessionId=" + std::to_string(controlSessionId),
+                                       SOURCEINFO);
+            }
+        } catch (...) {
+            dispatcher_->cancel(correlationId);
+            throw;
+        }
+    }
+
+    auto response = awaitResponse(correlationId);
+
+    if (response.code == codecs::ControlResponseCode::ERROR) {
+        throw ArchiveException("response for correlation id: " + std::to_string(correlationId) +
+                                   ", error: " + response.errorMessage +
+                                   ", relevant id: " + std::to_string(response.relevantId),
+                               SOURCEINFO);
+    }
+
+    return response;
+}
+
+void ArchiveSessionMultiplexer::awaitConnection(std::int64_t correlationId, const TimePoint& deadline) {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(lock_);
+
+            if (dispatcher_->subscription()->isConnected()) {
+                return;
+            }
+
+            if (Clock::now() > deadline) {
+                dispatcher_->cancel(correlationId);
+                throw ArchiveException(
+                    "failed to establish response connection on " + dispatcher_->subscription()->channel() +
+                        ", stream id: " + std::to_string(dispatcher_->subscription()->streamId()),
+                    SOURCEINFO);
+            }
+
+            aeron_->conductorAgentInvoker().invoke();
+        }
+
+        idleStrategy_.idle();
+    }
+}
+
+ControlResponseDispatcher::Response ArchiveSessionMultiplexer::awaitResponse(std::int64_t correlationId) {
+    auto deadline = Clock::now() + messageTimeoutNs_;
+    std::int32_t remainingRecordCount = -1;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(lock_);
+            std::int32_t fragments = 0;
+
+            // another waiter may have polled the response already
+            if (!dispatcher_->isComplete(correlationId)) {
+                fragments = dispatcher_->poll();
+                aeron_->conductorAgentInvoker().invoke();
+            }
+
+            if (dispatcher_->isComplete(correlationId)) {
+                return dispatcher_->take(correlationId);
+            }
+
+            const TimePoint now = Clock::now();
+
+            // a listing waits up to the timeout for every descriptor
+            if (dispatcher_->remainingRecordCount(correlationId) != remainingRecordCount) {
+                remainingRecordCount = dispatcher_->remainingRecordCount(correlationId);
+                deadline = now + messageTimeoutNs_;
+            }
+
+            if (fragments > 0) {
+                continue;
+            }
+
+            if (!dispatcher_->subscription()->isConnected()) {
+                dispatcher_->cancel(correlationId);
+                throw ArchiveException("subscription to archive is not connected", SOURCEINFO);
+            }
+
+            if (now > deadline) {
+                dispatcher_->cancel(correlationId);
+                AERON_ARCHIVE_LOG_EVENT(EventCode::TIMEOUT, -1, correlationId, 0, 0, 0);
+                throw ArchiveException("awaiting response for correlationId=" + std::to_string(correlationId),
+                                       SOURCEINFO);
+            }
+        }
+
+        idleStrategy_.idle();
+    }
+}
+
+void ArchiveSessionMultiplexer::closeSession(std::int64_t controlSessionId) {
+    std::unique_lock<std::mutex> lock(lock_);
+
+    if (sessions_->close(controlSessionId) && !archiveProxy_->closeSession(controlSessionId)) {
+        throw ArchiveException("failed to send close request: controlSessionId=" + std::to_string(controlSessionId),
+                               SOURCEINFO);
+    }
+}
+
+}  // namespace archive
+}  // namespace aeron
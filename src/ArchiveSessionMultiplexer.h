@@ -0,0 +1,160 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <unordered_set>
+
+#include <Aeron.h>
+#include <concurrent/YieldingIdleStrategy.h>
+
+#include "io_aeron_archive_codecs/SourceLocation.h"
+
+#include "ArchiveProxy.h"
+#include "Context.h"
+#include "ControlResponseDispatcher.h"
+
+namespace aeron {
+namespace archive {
+
+// The control sessions open on a shared control channel pair and the calls they register with its dispatcher. A call
+// is only registered for an open session, a session closes once. Not thread safe, the multiplexer holds its lock.
+class ControlSessionRegistry {
+public:
+    explicit ControlSessionRegistry(ControlResponseDispatcher& dispatcher);
+
+    ControlSessionRegistry(const ControlSessionRegistry&) = delete;
+    ControlSessionRegistry& operator=(const ControlSessionRegistry&) = delete;
+
+    // registers the connect request of a session whose id is only known from the response
+    void expectConnect(std::int64_t correlationId);
+    // opens the session of a connect response, throws unless it is OK
+    std::int64_t onConnected(const ControlResponseDispatcher::Response& response);
+
+    // a call without a consumer expects a single response, throws for a session which is not open
+    void expectCall(std::int64_t controlSessionId, std::int64_t correlationId, std::int32_t recordCount,
+                    RecordingDescriptorConsumer&& consumer);
+
+    // false when the session was not open
+    bool close(std::int64_t controlSessionId);
+
+    std::int32_t sessionCount() const;
+
+private:
+    ControlResponseDispatcher& dispatcher_;
+    std::unordered_set<std::int64_t> sessions_;
+};
+
+// Many logical control sessions over one control request publication and one control response subscription, so
+// a session adds no request publication or response subscription of its own. The archive still creates a response
+// publication per session, each is one more image on the shared subscription. Every session is connected with the
+// same response channel and stream id, a ControlResponseDispatcher routes responses and recording descriptors to the
+// pending call of their session by controlSessionId and correlationId.
+// Thread safe: whichever caller is waiting polls the subscription on behalf of all the others, so descriptor
+// consumers may run on the thread of another session while the multiplexer lock is held.
+// The multiplexer must outlive its sessions.
+class ArchiveSessionMultiplexer {
+    using Clock = std::chrono::high_resolution_clock;
+    using TimePoint = Clock::time_point;
+
+public:
+    class Session {
+    public:
+        Session(ArchiveSessionMultiplexer& multiplexer, std::int64_t controlSessionId);
+        // closes the session on the archive best effort, a failure to send is ignored
+        ~Session();
+
+        Session(const Session&) = delete;
+        Session& operator=(const Session&) = delete;
+
+        std::int64_t controlSessionId() const;
+
+        // closes the session on the archive, the session is no longer usable, throws when the request fails
+        void close();
+
+        std::int64_t startRecording(const std::string& channel, std::int32_t streamId,
+                                    io::aeron::archive::codecs::SourceLocation::Value sourceLocation);
+        std::int64_t extendRecording(std::int64_t recordingId, const std::string& channel, std::int32_t streamId,
+                                     io::aeron::archive::codecs::SourceLocation::Value sourceLocation);
+        void stopRecording(const std::string& channel, std::int32_t streamId);
+        void stopRecording(std::int64_t subscriptionId);
+
+        std::int64_t startReplay(std::int64_t recordingId, std::int64_t position, std::int64_t length,
+                                 const std::string& replayChannel, std::int32_t replayStreamId);
+        void stopReplay(std::int64_t replaySessionId);
+
+        std::int32_t listRecordings(std::int64_t fromRecordingId, std::int32_t recordCount,
+                                    RecordingDescriptorConsumer&& consumer);
+        std::int32_t listRecordingsForUri(std::int64_t fromRecordingId, std::int32_t recordCount,
+                                          const std::string& channelFragment, std::int32_t streamId,
+                                          RecordingDescriptorConsumer&& consumer);
+        std::int32_t listRecording(std::int64_t recordingId, RecordingDescriptorConsumer&& consumer);
+
+        std::int64_t getRecordingPosition(std::int64_t recordingId);
+        std::int64_t getStopPosition(std::int64_t recordingId);
+        void truncateRecording(std::int64_t recordingId, std::int64_t position);
+        std::int64_t findLastMatchingRecording(std::int64_t minRecordingId, const std::string& channelFragment,
+                                               std::int32_t streamId, std::int32_t sessionId);
+
+    private:
+        ArchiveSessionMultiplexer& multiplexer_;
+        const std::int64_t controlSessionId_;
+        bool isClosed_{false};
+    };
+
+    explicit ArchiveSessionMultiplexer(const Context& ctx);
+
+    ArchiveSessionMultiplexer(const ArchiveSessionMultiplexer&) = delete;
+    ArchiveSessionMultiplexer& operator=(const ArchiveSessionMultiplexer&) = delete;
+
+    // connects a new control session over the shared publication and subscription
+    std::shared_ptr<Session> openSession();
+
+    const Context& context() const;
+    std::int32_t sessionCount();
+    const std::shared_ptr<aeron::Subscription>& subscription() const;
+
+private:
+    std::int64_t callAndPollForResponse(std::int64_t controlSessionId, std::function<bool(std::int64_t)>&& f);
+    std::int32_t callAndPollForDescriptors(std::int64_t controlSessionId, std::function<bool(std::int64_t)>&& f,
+                                           std::int32_t recordCount, RecordingDescriptorConsumer&& consumer);
+    // registers and sends under the lock
+    ControlResponseDispatcher::Response call(std::int64_t controlSessionId, std::function<bool(std::int64_t)>&& f,
+                                             std::int32_t recordCount, RecordingDescriptorConsumer&& consumer);
+    // waits for the archive to connect to the response subscription, the first session waits for its response
+    // publication like AeronArchive does
+    void awaitConnection(std::int64_t correlationId, const TimePoint& deadline);
+    ControlResponseDispatcher::Response awaitResponse(std::int64_t correlationId);
+
+    // stops routing to the session and sends its close request, once
+    void closeSession(std::int64_t controlSessionId);
+
+private:
+    Context ctx_;
+    std::shared_ptr<aeron::Aeron> aeron_;
+    std::unique_ptr<ControlResponseDispatcher> dispatcher_;
+    std::unique_ptr<ArchiveProxy> archiveProxy_;
+    aeron::concurrent::YieldingIdleStrategy idleStrategy_;
+    const std::chrono::nanoseconds messageTimeoutNs_;
+
+    std::mutex lock_;
+    std::unique_ptr<ControlSessionRegistry> sessions_;
+};
+
+}  // namespace archive
+}  // namespace aeron
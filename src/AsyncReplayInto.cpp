@@ -0,0 +1,85 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AsyncReplayInto.h"
+
+namespace aeron {
+namespace archive {
+
+AsyncReplayInto::AsyncReplayInto(ReplaySessionPool::Handle&& handle, ReplayBuffer& buffer, std::int64_t stopPosition,
+                                 std::int32_t fragmentLimit)
+    : handle_(std::move(handle))
+    , buffer_(buffer)
+    , stopPosition_(stopPosition)
+    , fragmentLimit_(fragmentLimit)
+    , fragmentHandler_([this](concurrent::AtomicBuffer& buffer, util::index_t offset, util::index_t length,
+                              Header& header) { return onFragment(buffer, offset, length, header); }) {
+    buffer_.reset();
+}
+
+std::int32_t AsyncReplayInto::poll() {
+    if (isDone_) {
+        return 0;
+    }
+
+    std::int32_t fragments = handle_.controlledPoll(fragmentHandler_, fragmentLimit_);
+
+    if (!isDone_ && fragments == 0 && handle_.isDone()) {
+        complete();
+    }
+
+    if (isDone_) {
+        handle_.close();
+    }
+
+    return fragments;
+}
+
+bool AsyncReplayInto::isDone() const { return isDone_; }
+
+bool AsyncReplayInto::isBufferFull() const { return isBufferFull_; }
+
+std::int64_t AsyncReplayInto::position() const { return position_; }
+
+ReplayBuffer& AsyncReplayInto::buffer() { return buffer_; }
+
+ControlledPollAction AsyncReplayInto::onFragment(concurrent::AtomicBuffer& buffer, util::index_t offset,
+                                                 util::index_t length, Header& header) {
+    // a replay starting mid-message drops the fragments ahead of the first complete message
+    if (!buffer_.appendFragment(buffer, offset, length, header.flags(), header.position())) {
+        isBufferFull_ = true;
+        complete();
+        return ControlledPollAction::BREAK;
+    }
+
+    position_ = header.position();
+
+    // a message crossing the stop position is completed first
+    if (position_ >= stopPosition_ && !buffer_.isInMessage()) {
+        complete();
+        return ControlledPollAction::BREAK;
+    }
+
+    return ControlledPollAction::CONTINUE;
+}
+
+void AsyncReplayInto::complete() {
+    isDone_ = true;
+    buffer_.abort();
+}
+
+}  // namespace archive
+}  // namespace aeron
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "ReplayBuffer.h"
+#include "ReplaySessionPool.h"
+
+namespace aeron {
+namespace archive {
+
+// Bounded replay which reassembles messages straight into a caller provided buffer.
+// It is done once the first message ending at or after the stop position is received, the image reaches end of
+// stream or the buffer is full.
+class AsyncReplayInto {
+public:
+    AsyncReplayInto(ReplaySessionPool::Handle&& handle, ReplayBuffer& buffer, std::int64_t stopPosition,
+                    std::int32_t fragmentLimit);
+
+    AsyncReplayInto(const AsyncReplayInto&) = delete;
+    AsyncReplayInto& operator=(const AsyncReplayInto&) = delete;
+
+    std::int32_t poll();
+
+    bool isDone() const;
+    bool isBufferFull() const;
+    std::int64_t position() const;
+    ReplayBuffer& buffer();
+
+private:
+    aeron::ControlledPollAction onFragment(aeron::concurrent::AtomicBuffer& buffer, aeron::util::index_t offset,
+                                           aeron::util::index_t length, aeron::Header& header);
+    void complete();
+
+private:
+    ReplaySessionPool::Handle handle_;
+    ReplayBuffer& buffer_;
+    const std::int64_t stopPosition_;
+    const std::int32_t fragmentLimit_;
+    aeron::controlled_poll_fragment_handler_t fragmentHandler_;
+
+    std::int64_t position_{-1};
+    bool isDone_{false};
+    bool isBufferFull_{false};
+};
+
+}  // namespace archive
+}  // namespace aeron
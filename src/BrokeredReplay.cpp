@@ -0,0 +1,136 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <thread>
+
+#include "BrokeredReplay.h"
+
+namespace aeron {
+namespace archive {
+
+BrokeredReplay::BrokeredReplay(const std::shared_ptr<Aeron>& aeron, ReplaySessionPool& prefixPool,
+                               const ReplayTicket& ticket, std::int32_t fragmentLimit)
+    : prefixPool_(prefixPool)
+    , ticket_(ticket)
+    , fragmentLimit_(fragmentLimit)
+    , sharedAssembler_([this](concurrent::AtomicBuffer& buffer, util::index_t offset, util::index_t length,
+                              Header& header) { return onSharedMessage(buffer, offset, length, header); })
+    , prefixAssembler_([this](concurrent::AtomicBuffer& buffer, util::index_t offset, util::index_t length,
+                              Header& header) { onPrefixMessage(buffer, offset, length, header); })
+    , position_(ticket.position) {
+    const std::int64_t registrationId = aeron->addSubscription(ticket_.channel, ticket_.streamId);
+    while (!(subscription_ = aeron->findSubscription(registrationId))) {
+        std::this_thread::yield();
+    }
+}
+
+std::int32_t BrokeredReplay::poll(const fragment_handler_t& handler) {
+    if (isDone_) {
+        return 0;
+    }
+
+    handler_ = &handler;
+
+    if (isPrefixActive_) {
+        return pollPrefix();
+    }
+
+    if (!image_) {
+        // stream ids are reused by the broker so the image is picked by the publication session id
+        image_ = subscription_->imageBySessionId(ticket_.sessionId);
+        if (!image_) {
+            return 0;
+        }
+    }
+
+    const std::int32_t fragments = image_->controlledPoll(sharedAssembler_.handler(), fragmentLimit_);
+
+    if (!isDone_ && fragments == 0 && (image_->isEndOfStream() || image_->isClosed())) {
+        isDone_ = true;
+    }
+
+    return fragments;
+}
+
+bool BrokeredReplay::isDone() const { return isDone_; }
+
+std::int64_t BrokeredReplay::position() const { return position_; }
+
+const ReplayTicket& BrokeredReplay::ticket() const { return ticket_; }
+
+ControlledPollAction BrokeredReplay::onSharedMessage(concurrent::AtomicBuffer& buffer, util::index_t offset,
+                                                     util::index_t length, Header& header) {
+    if (isPrefixActive_) {
+        return ControlledPollAction::ABORT;
+    }
+
+    // the broker sets the recording position after the message as the reserved value
+    const std::int64_t position = header.reservedValue();
+
+    if (position <= position_) {
+        return ControlledPollAction::CONTINUE;
+    }
+
+    if (!isJoined_) {
+        isJoined_ = true;
+
+        // an image which did not join at the start of the publication may have missed part of the range
+        if (image_->joinPosition() > 0) {
+            prefixStopPosition_ = std::min(position, ticket_.stopPosition);
+            prefix_ = prefixPool_.replay(ticket_.recordingId, position_, prefixStopPosition_ - position_);
+            isPrefixActive_ = true;
+            return ControlledPollAction::ABORT;
+        }
+    }
+
+    if (position > ticket_.stopPosition) {
+        isDone_ = true;
+        return ControlledPollAction::BREAK;
+    }
+
+    (*handler_)(buffer, offset, length, header);
+    position_ = position;
+
+    if (position_ >= ticket_.stopPosition) {
+        isDone_ = true;
+        return ControlledPollAction::BREAK;
+    }
+
+    return ControlledPollAction::CONTINUE;
+}
+
+void BrokeredReplay::onPrefixMessage(concurrent::AtomicBuffer& buffer, util::index_t offset, util::index_t length,
+                                     Header& header) {
+    (*handler_)(buffer, offset, length, header);
+    position_ = header.position();
+}
+
+std::int32_t BrokeredReplay::pollPrefix() {
+    const std::int32_t fragments = prefix_.poll(prefixAssembler_.handler(), fragmentLimit_);
+
+    if (prefix_.isDone()) {
+        prefix_.close();
+        isPrefixActive_ = false;
+        position_ = std::max(position_, prefixStopPosition_);
+        isDone_ = position_ >= ticket_.stopPosition;
+    }
+
+    return fragments;
+}
+
+}  // namespace archive
+}  // namespace aeron
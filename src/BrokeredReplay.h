@@ -0,0 +1,77 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <Aeron.h>
+#include <ControlledFragmentAssembler.h>
+#include <FragmentAssembler.h>
+
+#include "ReplayBroker.h"
+#include "ReplaySessionPool.h"
+
+namespace aeron {
+namespace archive {
+
+// Consumer side of a ReplayBroker ticket. Subscribes to the shared republished stream and, when it joined
+// after the shared replay had already moved past the requested position, fetches the missed prefix with a
+// bounded replay from the pool before carrying on with the shared stream. The shared stream is held back
+// while the prefix is replayed. Messages outside the requested range are skipped.
+// Not thread safe, all calls are expected from the polling thread.
+class BrokeredReplay {
+public:
+    BrokeredReplay(const std::shared_ptr<aeron::Aeron>& aeron, ReplaySessionPool& prefixPool,
+                   const ReplayTicket& ticket, std::int32_t fragmentLimit);
+
+    BrokeredReplay(const BrokeredReplay&) = delete;
+    BrokeredReplay& operator=(const BrokeredReplay&) = delete;
+
+    std::int32_t poll(const aeron::fragment_handler_t& handler);
+
+    bool isDone() const;
+    std::int64_t position() const;
+    const ReplayTicket& ticket() const;
+
+private:
+    aeron::ControlledPollAction onSharedMessage(aeron::concurrent::AtomicBuffer& buffer,
+                                                aeron::util::index_t offset, aeron::util::index_t length,
+                                                aeron::Header& header);
+    void onPrefixMessage(aeron::concurrent::AtomicBuffer& buffer, aeron::util::index_t offset,
+                         aeron::util::index_t length, aeron::Header& header);
+    std::int32_t pollPrefix();
+
+private:
+    ReplaySessionPool& prefixPool_;
+    const ReplayTicket ticket_;
+    const std::int32_t fragmentLimit_;
+
+    std::shared_ptr<aeron::Subscription> subscription_;
+    std::shared_ptr<aeron::Image> image_;
+    aeron::ControlledFragmentAssembler sharedAssembler_;
+    aeron::FragmentAssembler prefixAssembler_;
+    const aeron::fragment_handler_t* handler_{nullptr};
+
+    ReplaySessionPool::Handle prefix_;
+    std::int64_t prefixStopPosition_{-1};
+    bool isPrefixActive_{false};
+    bool isJoined_{false};
+
+    std::int64_t position_;
+    bool isDone_{false};
+};
+
+}  // namespace archive
+}  // namespace aeron
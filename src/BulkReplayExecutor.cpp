@@ -0,0 +1,250 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <thread>
+
+#include <FragmentAssembler.h>
+
+#include "ArchiveException.h"
+#include "BulkReplayExecutor.h"
+
+namespace {
+
+const std::int32_t FRAGMENT_LIMIT = 10;
+const double MEGABYTE = 1024.0 * 1024.0;
+const std::int64_t NULL_POSITION = -1;
+
+using Clock = std::chrono::high_resolution_clock;
+
+}  // namespace
+
+namespace aeron {
+namespace archive {
+
+double BulkReplayStats::megabytesPerSecond() const {
+    return duration.count() > 0 ? (bytes / MEGABYTE) / (duration.count() / 1e9) : 0.0;
+}
+
+BulkReplayExecutor::BulkReplayExecutor(const Context& ctx, const std::string& replayChannel,
+                                       std::int32_t firstReplayStreamId, std::int32_t workerCount,
+                                       std::int32_t maxConcurrentReplays)
+    : ctx_(ctx)
+    , replayChannel_(replayChannel)
+    , firstReplayStreamId_(firstReplayStreamId)
+    , workerCount_(workerCount)
+    , permits_(maxConcurrentReplays) {
+    if (workerCount_ <= 0 || maxConcurrentReplays <= 0) {
+        throw util::IllegalArgumentException("worker count and max concurrent replays must be positive", SOURCEINFO);
+    }
+
+    // workers share one Aeron client but open their own archive sessions
+    ctx_.conclude();
+    archive_ = AeronArchive::connect(ctx_);
+
+    for (std::int32_t i = 0; i < workerCount_; ++i) {
+        queues_.push_back(std::make_unique<WorkQueue>());
+    }
+}
+
+BulkReplayExecutor& BulkReplayExecutor::cpuAffinity(const std::vector<std::int32_t>& cpus) {
+    cpus_ = cpus;
+    return *this;
+}
+
+void BulkReplayExecutor::add(const ReplayTask& task) {
+    WorkQueue& queue = *queues_[nextQueue_];
+    nextQueue_ = (nextQueue_ + 1) % workerCount_;
+
+    std::unique_lock<std::mutex> lock(queue.lock);
+    queue.tasks.push_back(task);
+}
+
+std::int32_t BulkReplayExecutor::addRecordingsForUri(std::int64_t fromRecordingId, std::int32_t recordCount,
+                                                     const std::string& channelFragment, std::int32_t streamId) {
+    std::int32_t added = 0;
+
+    archive_->listRecordingsForUri(
+        fromRecordingId, recordCount, channelFragment, streamId,
+        [&](std::int64_t controlSessionId, std::int64_t correlationId, std::int64_t recordingId,
+            std::int64_t startTimestamp, std::int64_t stopTimestamp, std::int64_t startPosition,
+            std::int64_t stopPosition, std::int32_t initialTermId, std::int32_t segmentFileLength,
+            std::int32_t termBufferLength, std::int32_t mtuLength, std::int32_t sessionId, std::int32_t streamId,
+            const std::string& strippedChannel, const std::string& originalChannel,
+            const std::string& sourceIdentity) {
+            // an active recording has no stop position and would never complete
+            if (stopPosition != NULL_POSITION && stopPosition > startPosition) {
+                add(ReplayTask{recordingId, startPosition, stopPosition - startPosition});
+                ++added;
+            }
+        });
+
+    return added;
+}
+
+BulkReplayStats BulkReplayExecutor::run(ReplayFragmentHandler&& handler) {
+    isFailed_ = false;
+    failure_ = nullptr;
+    replays_ = 0;
+    messages_ = 0;
+    bytes_ = 0;
+
+    auto start = Clock::now();
+
+    std::vector<std::thread> workers;
+    for (std::int32_t i = 0; i < workerCount_; ++i) {
+        workers.emplace_back([this, i, &handler] { runWorker(i, handler); });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    if (failure_) {
+        std::rethrow_exception(failure_);
+    }
+
+    return BulkReplayStats{replays_, messages_, bytes_,
+                           std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start)};
+}
+
+void BulkReplayExecutor::runWorker(std::int32_t workerId, const ReplayFragmentHandler& handler) {
+    try {
+        pinToCpu(workerId);
+
+        auto archive = AeronArchive::connect(ctx_);
+        ReplaySessionPool replayPool(archive, replayChannel_, firstReplayStreamId_ + workerId, 1);
+
+        ReplayTask task;
+        while (!isFailed_ && nextTask(workerId, task)) {
+            acquirePermit();
+            try {
+                replay(workerId, replayPool, task, handler);
+            } catch (...) {
+                releasePermit();
+                throw;
+            }
+            releasePermit();
+        }
+    } catch (...) {
+        std::unique_lock<std::mutex> lock(failureLock_);
+        if (!failure_) {
+            failure_ = std::current_exception();
+        }
+        isFailed_ = true;
+    }
+}
+
+bool BulkReplayExecutor::nextTask(std::int32_t workerId, ReplayTask& task) {
+    {
+        WorkQueue& own = *queues_[workerId];
+        std::unique_lock<std::mutex> lock(own.lock);
+        if (!own.tasks.empty()) {
+            task = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+
+    for (std::int32_t i = 1; i < workerCount_; ++i) {
+        WorkQueue& victim = *queues_[(workerId + i) % workerCount_];
+        std::unique_lock<std::mutex> lock(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void BulkReplayExecutor::replay(std::int32_t workerId, ReplaySessionPool& replayPool, const ReplayTask& task,
+                                const ReplayFragmentHandler& handler) {
+    std::int64_t messages = 0;
+    std::int64_t bytes = 0;
+
+    FragmentAssembler fragmentAssembler(
+        [&](concurrent::AtomicBuffer& buffer, util::index_t offset, util::index_t length, Header& header) {
+            handler(workerId, task, buffer, offset, length, header);
+            ++messages;
+            bytes += length;
+        });
+    auto fragmentHandler = fragmentAssembler.handler();
+
+    const std::chrono::nanoseconds timeout(ctx_.messageTimeoutNs());
+    auto deadline = Clock::now() + timeout;
+    concurrent::YieldingIdleStrategy idleStrategy;
+
+    auto handle = replayPool.replay(task.recordingId, task.position, task.length);
+
+    while (!handle.isDone() && !isFailed_) {
+        if (handle.poll(fragmentHandler, FRAGMENT_LIMIT) > 0) {
+            deadline = Clock::now() + timeout;
+            continue;
+        }
+
+        if (Clock::now() > deadline) {
+            throw ArchiveException("no progress replaying recordingId=" + std::to_string(task.recordingId),
+                                   SOURCEINFO);
+        }
+
+        idleStrategy.idle();
+    }
+
+    replays_.fetch_add(1, std::memory_order_relaxed);
+    messages_.fetch_add(messages, std::memory_order_relaxed);
+    bytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void BulkReplayExecutor::acquirePermit() {
+    std::unique_lock<std::mutex> lock(permitLock_);
+    permitCondition_.wait(lock, [this] { return permits_ > 0; });
+    --permits_;
+}
+
+void BulkReplayExecutor::releasePermit() {
+    {
+        std::unique_lock<std::mutex> lock(permitLock_);
+        ++permits_;
+    }
+    permitCondition_.notify_one();
+}
+
+void BulkReplayExecutor::pinToCpu(std::int32_t workerId) {
+    if (cpus_.empty()) {
+        return;
+    }
+
+#if defined(__linux__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpus_[workerId % cpus_.size()], &cpuSet);
+
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0) {
+        throw ArchiveException("failed to pin worker " + std::to_string(workerId) + " to cpu " +
+                                   std::to_string(cpus_[workerId % cpus_.size()]),
+                               SOURCEINFO);
+    }
+#endif
+}
+
+}  // namespace archive
+}  // namespace aeron
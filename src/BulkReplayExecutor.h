@@ -0,0 +1,116 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+#include <Aeron.h>
+
+#include "AeronArchive.h"
+#include "Context.h"
+#include "ReplaySessionPool.h"
+
+namespace aeron {
+namespace archive {
+
+struct ReplayTask {
+    std::int64_t recordingId;
+    std::int64_t position;
+    std::int64_t length;
+};
+
+struct BulkReplayStats {
+    std::int64_t replays;
+    std::int64_t messages;
+    std::int64_t bytes;
+    std::chrono::nanoseconds duration;
+
+    double megabytesPerSecond() const;
+};
+
+// Replays a batch of recordings on a number of worker threads. Every worker has its own archive session and
+// replay stream, takes tasks from its own queue and steals from the others when it runs dry.
+// The number of replays running on the archive at the same time is capped.
+class BulkReplayExecutor {
+public:
+    using ReplayFragmentHandler =
+        std::function<void(std::int32_t workerId, const ReplayTask& task, aeron::concurrent::AtomicBuffer& buffer,
+                           aeron::util::index_t offset, aeron::util::index_t length, aeron::Header& header)>;
+
+    BulkReplayExecutor(const Context& ctx, const std::string& replayChannel, std::int32_t firstReplayStreamId,
+                       std::int32_t workerCount, std::int32_t maxConcurrentReplays);
+
+    BulkReplayExecutor(const BulkReplayExecutor&) = delete;
+    BulkReplayExecutor& operator=(const BulkReplayExecutor&) = delete;
+
+    // workers are pinned round robin to the given CPUs, an empty list leaves them unpinned
+    BulkReplayExecutor& cpuAffinity(const std::vector<std::int32_t>& cpus);
+
+    void add(const ReplayTask& task);
+
+    // queues every stopped recording matching the channel fragment and stream id, returns the number queued
+    std::int32_t addRecordingsForUri(std::int64_t fromRecordingId, std::int32_t recordCount,
+                                     const std::string& channelFragment, std::int32_t streamId);
+
+    // blocks until all queued tasks are replayed and rethrows the first failure of a worker
+    BulkReplayStats run(ReplayFragmentHandler&& handler);
+
+private:
+    struct WorkQueue {
+        std::mutex lock;
+        std::deque<ReplayTask> tasks;
+    };
+
+    void runWorker(std::int32_t workerId, const ReplayFragmentHandler& handler);
+    bool nextTask(std::int32_t workerId, ReplayTask& task);
+    void replay(std::int32_t workerId, ReplaySessionPool& replayPool, const ReplayTask& task,
+                const ReplayFragmentHandler& handler);
+    void acquirePermit();
+    void releasePermit();
+    void pinToCpu(std::int32_t workerId);
+
+private:
+    Context ctx_;
+    std::shared_ptr<AeronArchive> archive_;
+    const std::string replayChannel_;
+    const std::int32_t firstReplayStreamId_;
+    const std::int32_t workerCount_;
+    std::vector<std::int32_t> cpus_;
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::int32_t nextQueue_{0};
+
+    std::mutex permitLock_;
+    std::condition_variable permitCondition_;
+    std::int32_t permits_;
+
+    std::atomic<bool> isFailed_{false};
+    std::mutex failureLock_;
+    std::exception_ptr failure_;
+
+    std::atomic<std::int64_t> replays_{0};
+    std::atomic<std::int64_t> messages_{0};
+    std::atomic<std::int64_t> bytes_{0};
+};
+
+}  // namespace archive
+}  // namespace aeron
@@ -111,6 +111,11 @@ Context& Context::aeron(const std::shared_ptr<aeron::Aeron>& value) {
     return *this;
 }
 
+Context& Context::lockTiming(bool value) {
+    lockTiming_ = value;
+    return *this;
+}
+
 Context& Context::controlRequestChannel(const std::string& value) {
     ChannelUri uri = ChannelUri::parse(value);
     uri.put(TERM_LENGTH_PARAM_NAME, std::to_string(cfg_.controlTermBufferLength));
@@ -134,6 +139,7 @@ std::int32_t Context::controlMtuLength() const { return cfg_.controlMtuLength; }
 
 const std::string& Context::aeronDirectoryName() const { return aeronDirectoryName_; }
 const std::shared_ptr<aeron::Aeron>& Context::aeron() const { return aeron_; }
+bool Context::lockTiming() const { return lockTiming_; }
 const std::string& Context::controlRequestChannel() const { return controlRequestChannel_; }
 
 }  // namespace archive
@@ -51,6 +51,8 @@ public:
 
     Context& aeronDirectoryName(const std::string& value);
     Context& aeron(const std::shared_ptr<aeron::Aeron>& value);
+    // times the waits for and holds of the client lock, off by default as it costs two clock reads per call
+    Context& lockTiming(bool value);
 
     // getters
     std::int64_t messageTimeoutNs() const;
@@ -68,6 +70,7 @@ public:
 
     const std::string& aeronDirectoryName() const;
     const std::shared_ptr<aeron::Aeron>& aeron() const;
+    bool lockTiming() const;
 
     // TODO: ownsAeronClient, lock
     // TODO: idle strategy - it will require a generic version of this class
@@ -79,6 +82,7 @@ private:
     std::shared_ptr<aeron::Context> aeronContext_;
     std::shared_ptr<aeron::Aeron> aeron_;
     std::string controlRequestChannel_;
+    bool lockTiming_{false};
 };
 
 }  // namespace archive
@@ -0,0 +1,212 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "io_aeron_archive_codecs/ControlResponse.h"
+#include "io_aeron_archive_codecs/RecordingDescriptor.h"
+
+#include "ArchiveException.h"
+#include "ControlResponseDispatcher.h"
+#include "EventLog.h"
+
+namespace codecs = io::aeron::archive::codecs;
+
+namespace aeron {
+namespace archive {
+
+constexpr std::int64_t ControlResponseDispatcher::ANY_SESSION;
+constexpr std::size_t ControlResponseDispatcher::MAX_UNCLAIMED_ERRORS;
+
+ControlResponseDispatcher::ControlResponseDispatcher(const std::shared_ptr<Subscription>& subscription,
+                                                     std::int32_t fragmentLimit)
+    : subscription_(subscription)
+    , fragmentLimit_(fragmentLimit)
+    , fragmentAssembler_([this](concurrent::AtomicBuffer& buffer, util::index_t offset, util::index_t length,
+                                Header& header) { onFragment(buffer, offset, length, header); }) {}
+
+const std::shared_ptr<Subscription>& ControlResponseDispatcher::subscription() const { return subscription_; }
+
+void ControlResponseDispatcher::expectResponse(std::int64_t controlSessionId, std::int64_t correlationId) {
+    PendingCall& call = calls_[correlationId];
+    call.controlSessionId = controlSessionId;
+}
+
+void ControlResponseDispatcher::expectDescriptors(std::int64_t controlSessionId, std::int64_t correlationId,
+                                                  std::int32_t recordCount, RecordingDescriptorConsumer&& consumer) {
+    PendingCall& call = calls_[correlationId];
+    call.controlSessionId = controlSessionId;
+    call.isListing = true;
+    call.consumer = std::move(consumer);
+    call.response.remainingRecordCount = recordCount;
+}
+
+void ControlResponseDispatcher::cancel(std::int64_t correlationId) { calls_.erase(correlationId); }
+
+bool ControlResponseDispatcher::isComplete(std::int64_t correlationId) const {
+    auto it = calls_.find(correlationId);
+    return it != calls_.end() && it->second.isComplete;
+}
+
+std::int32_t ControlResponseDispatcher::remainingRecordCount(std::int64_t correlationId) const {
+    auto it = calls_.find(correlationId);
+    return it != calls_.end() ? it->second.response.remainingRecordCount : -1;
+}
+
+ControlResponseDispatcher::Response ControlResponseDispatcher::take(std::int64_t correlationId) {
+    auto it = calls_.find(correlationId);
+    if (it == calls_.end() || !it->second.isComplete) {
+        throw ArchiveException("no completed call for correlationId=" + std::to_string(correlationId), SOURCEINFO);
+    }
+
+    Response response = std::move(it->second.response);
+    calls_.erase(it);
+    return response;
+}
+
+boost::optional<ControlResponseDispatcher::Response> ControlResponseDispatcher::takeError(
+    std::int64_t controlSessionId) {
+    auto it = std::find_if(unclaimedErrors_.begin(), unclaimedErrors_.end(),
+                           [=](const Response& error) { return error.controlSessionId == controlSessionId; });
+    if (it == unclaimedErrors_.end()) {
+        return {};
+    }
+
+    Response error = std::move(*it);
+    unclaimedErrors_.erase(it);
+    return error;
+}
+
+std::int32_t ControlResponseDispatcher::pendingCount() const { return static_cast<std::int32_t>(calls_.size()); }
+
+std::int32_t ControlResponseDispatcher::poll() {
+    return subscription_->poll(fragmentAssembler_.handler(), fragmentLimit_);
+}
+
+void ControlResponseDispatcher::onFragment(concurrent::AtomicBuffer& buffer, util::index_t offset,
+                                           util::index_t length, Header& header) {
+    codecs::MessageHeader hdr;
+    hdr.wrap((char*)buffer.buffer(), offset, 0, buffer.capacity());
+
+    const std::uint16_t templateId = hdr.templateId();
+
+    if (templateId == codecs::ControlResponse::sbeTemplateId()) {
+        codecs::ControlResponse msg;
+        msg.wrapForDecode((char*)buffer.buffer(), offset + hdr.encodedLength(), hdr.blockLength(), hdr.version(),
+                          buffer.capacity());
+
+        const std::int64_t controlSessionId = msg.controlSessionId();
+        const std::int64_t correlationId = msg.correlationId();
+        const auto code = msg.code();
+
+        AERON_ARCHIVE_LOG_EVENT(EventCode::CONTROL_RESPONSE, controlSessionId, correlationId, msg.relevantId(), code,
+                                templateId);
+
+        PendingCall* call = find(controlSessionId, correlationId);
+        Response* response = call ? &call->response : nullptr;
+
+        if (!response && code == codecs::ControlResponseCode::ERROR) {
+            if (unclaimedErrors_.size() == MAX_UNCLAIMED_ERRORS) {
+                unclaimedErrors_.pop_front();
+            }
+            unclaimedErrors_.emplace_back();
+            response = &unclaimedErrors_.back();
+        }
+
+        if (response) {
+            response->controlSessionId = controlSessionId;
+            response->correlationId = correlationId;
+            response->relevantId = msg.relevantId();
+            response->code = code;
+            if (code == codecs::ControlResponseCode::ERROR) {
+                response->errorMessage = msg.getErrorMessageAsString();
+            }
+        }
+
+        // a listing ends early with RECORDING_UNKNOWN when fewer recordings are found
+        if (call) {
+            call->isComplete = true;
+        }
+    } else if (templateId == codecs::RecordingDescriptor::sbeTemplateId()) {
+        codecs::RecordingDescriptor msg;
+        msg.wrapForDecode((char*)buffer.buffer(), offset + hdr.encodedLength(), hdr.blockLength(), hdr.version(),
+                          buffer.capacity());
+
+        PendingCall* call = find(msg.controlSessionId(), msg.correlationId());
+        if (!call || !call->isListing) {
+            return;
+        }
+
+        // var data is read in schema order
+        const std::string strippedChannel = msg.getStrippedChannelAsString();
+        const std::string originalChannel = msg.getOriginalChannelAsString();
+        const std::string sourceIdentity = msg.getSourceIdentityAsString();
+
+        // the consumer may belong to another caller than the one polling, its failure ends only its own listing
+        try {
+            call->consumer(msg.controlSessionId(), msg.correlationId(), msg.recordingId(), msg.startTimestamp(),
+                           msg.stopTimestamp(), msg.startPosition(), msg.stopPosition(), msg.initialTermId(),
+                           msg.segmentFileLength(), msg.termBufferLength(), msg.mtuLength(), msg.sessionId(),
+                           msg.streamId(), strippedChannel, originalChannel, sourceIdentity);
+        } catch (const std::exception& e) {
+            failListing(*call, msg.controlSessionId(), msg.correlationId(), msg.recordingId(), e.what());
+            return;
+        } catch (...) {
+            failListing(*call, msg.controlSessionId(), msg.correlationId(), msg.recordingId(), "unknown exception");
+            return;
+        }
+
+        Response& response = call->response;
+        AERON_ARCHIVE_LOG_EVENT(EventCode::RECORDING_DESCRIPTOR, msg.controlSessionId(), msg.correlationId(),
+                                msg.recordingId(), response.remainingRecordCount - 1, 0);
+
+        if (--response.remainingRecordCount == 0) {
+            response.controlSessionId = msg.controlSessionId();
+            response.correlationId = msg.correlationId();
+            response.code = codecs::ControlResponseCode::OK;
+            call->isComplete = true;
+        }
+    } else {
+        throw ArchiveException("unknown template id: " + std::to_string(templateId), SOURCEINFO);
+    }
+}
+
+void ControlResponseDispatcher::failListing(PendingCall& call, std::int64_t controlSessionId,
+                                            std::int64_t correlationId, std::int64_t recordingId,
+                                            const std::string& reason) {
+    Response& response = call.response;
+    response.controlSessionId = controlSessionId;
+    response.correlationId = correlationId;
+    response.relevantId = recordingId;
+    response.code = codecs::ControlResponseCode::ERROR;
+    response.errorMessage = "recording descriptor consumer failed: " + reason;
+    // the rest of the listing is dropped as it arrives
+    call.isComplete = true;
+}
+
+ControlResponseDispatcher::PendingCall* ControlResponseDispatcher::find(std::int64_t controlSessionId,
+                                                                        std::int64_t correlationId) {
+    auto it = calls_.find(correlationId);
+    if (it == calls_.end() || it->second.isComplete) {
+        return nullptr;
+    }
+
+    PendingCall& call = it->second;
+    return call.controlSessionId == ANY_SESSION || call.controlSessionId == controlSessionId ? &call : nullptr;
+}
+
+}  // namespace archive
+}  // namespace aeron
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <deque>
+#include <unordered_map>
+
+#include <boost/optional.hpp>
+
+#include <Aeron.h>
+#include <FragmentAssembler.h>
+
+#include "io_aeron_archive_codecs/ControlResponseCode.h"
+
+#include "RecordingDescriptorPoller.h"
+
+namespace aeron {
+namespace archive {
+
+// Decodes every message of a control response subscription once and routes it by template id, control session id
+// and correlation id to the call waiting for it. A response completes its call, descriptors go to the consumer of
+// their listing until the requested count is reached or a response ends it early. Calls are registered before their
+// request is sent so nothing read in between is lost. Error responses which complete no call (e.g. for a call that
+// already timed out) are kept, up to a bound, for takeError(), any other unclaimed message is dropped. A descriptor
+// consumer which throws completes its own listing with an ERROR response, the exception does not reach the poller.
+// Not thread safe, callers serialise access.
+class ControlResponseDispatcher {
+public:
+    struct Response {
+        std::int64_t controlSessionId{-1};
+        std::int64_t correlationId{-1};
+        std::int64_t relevantId{-1};
+        io::aeron::archive::codecs::ControlResponseCode::Value code{
+            io::aeron::archive::codecs::ControlResponseCode::NULL_VALUE};
+        std::string errorMessage;
+        // listings only, descriptors still expected when the listing ended
+        std::int32_t remainingRecordCount{0};
+    };
+
+    // the session of a connect is only known from its response
+    static constexpr std::int64_t ANY_SESSION = -1;
+    static constexpr std::size_t MAX_UNCLAIMED_ERRORS = 64;
+
+    ControlResponseDispatcher(const std::shared_ptr<aeron::Subscription>& subscription, std::int32_t fragmentLimit);
+
+    ControlResponseDispatcher(const ControlResponseDispatcher&) = delete;
+    ControlResponseDispatcher& operator=(const ControlResponseDispatcher&) = delete;
+
+    const std::shared_ptr<aeron::Subscription>& subscription() const;
+
+    void expectResponse(std::int64_t controlSessionId, std::int64_t correlationId);
+    void expectDescriptors(std::int64_t controlSessionId, std::int64_t correlationId, std::int32_t recordCount,
+                           RecordingDescriptorConsumer&& consumer);
+    // forgets a call, its response is dropped when it arrives
+    void cancel(std::int64_t correlationId);
+
+    bool isComplete(std::int64_t correlationId) const;
+    // -1 for an unknown call
+    std::int32_t remainingRecordCount(std::int64_t correlationId) const;
+    // removes a completed call and returns its response
+    Response take(std::int64_t correlationId);
+    // the oldest error response of the session which completed no call
+    boost::optional<Response> takeError(std::int64_t controlSessionId);
+
+    std::int32_t pendingCount() const;
+
+    std::int32_t poll();
+
+    // decodes one assembled message, public so a response can be fed without a subscription
+    void onFragment(aeron::concurrent::AtomicBuffer& buffer, aeron::util::index_t offset, aeron::util::index_t length,
+                    aeron::Header& header);
+
+private:
+    struct PendingCall {
+        std::int64_t controlSessionId{ANY_SESSION};
+        bool isComplete{false};
+        bool isListing{false};
+        RecordingDescriptorConsumer consumer;
+        Response response;
+    };
+
+    PendingCall* find(std::int64_t controlSessionId, std::int64_t correlationId);
+    // completes a listing whose consumer threw with an error response for the recording it failed on
+    void failListing(PendingCall& call, std::int64_t controlSessionId, std::int64_t correlationId,
+                     std::int64_t recordingId, const std::string& reason);
+
+private:
+    std::shared_ptr<aeron::Subscription> subscription_;
+    const std::int32_t fragmentLimit_;
+    aeron::FragmentAssembler fragmentAssembler_;
+
+    std::unordered_map<std::int64_t, PendingCall> calls_;
+    std::deque<Response> unclaimedErrors_;
+};
+
+}  // namespace archive
+}  // namespace aeron
@@ -19,6 +19,7 @@
 
 #include "ArchiveException.h"
 #include "ControlResponsePoller.h"
+#include "EventLog.h"
 
 namespace codecs = io::aeron::archive::codecs;
 
@@ -81,7 +82,20 @@ ControlledPollAction ControlResponsePoller::onFragment(concurrent::AtomicBuffer&
         } else {
             errorMessage_ = "";
         }
-    } else if (templateId != codecs::RecordingDescriptor::sbeTemplateId()) {
+
+        AERON_ARCHIVE_LOG_EVENT(EventCode::CONTROL_RESPONSE, controlSessionId_, correlationId_, relevantId_, code_,
+                                templateId);
+    } else if (templateId == codecs::RecordingDescriptor::sbeTemplateId()) {
+        // not a response, reported under its own template id instead of being consumed unnoticed
+        codecs::RecordingDescriptor msg;
+        msg.wrapForDecode((char*)buffer.buffer(), offset + hdr.encodedLength(), hdr.blockLength(), hdr.version(),
+                          buffer.capacity());
+
+        controlSessionId_ = msg.controlSessionId();
+        correlationId_ = msg.correlationId();
+        relevantId_ = msg.recordingId();
+        templateId_ = templateId;
+    } else {
         throw ArchiveException("unknown template id: " + std::to_string(templateId), SOURCEINFO);
     }
 
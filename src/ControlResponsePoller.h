@@ -24,6 +24,9 @@
 namespace aeron {
 namespace archive {
 
+// Polls one message at a time from a control response subscription. A recording descriptor polled here is reported
+// with its template id and recording id as the relevant id, callers which also list recordings should use a
+// ControlResponseDispatcher so descriptors reach their listing.
 class ControlResponsePoller {
 public:
     ControlResponsePoller(const std::shared_ptr<aeron::Subscription>& subscription, std::int32_t fragmentLimit);
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace aeron {
+namespace archive {
+
+// Type ids of every Aeron counter this client adds, declared as one block so they neither collide with each other nor
+// with Aeron's own ranges: 0-99 for the media driver, 100-199 for the archive and 200-299 for the cluster.
+constexpr std::int32_t COUNTER_TYPE_ID_BASE = 3000;
+
+// ArchiveCounters, one of each per control session
+constexpr std::int32_t REQUESTS_SENT_COUNTER_TYPE_ID = COUNTER_TYPE_ID_BASE;
+constexpr std::int32_t RESPONSES_RECEIVED_COUNTER_TYPE_ID = COUNTER_TYPE_ID_BASE + 1;
+constexpr std::int32_t ERRORS_COUNTER_TYPE_ID = COUNTER_TYPE_ID_BASE + 2;
+constexpr std::int32_t TIMEOUTS_COUNTER_TYPE_ID = COUNTER_TYPE_ID_BASE + 3;
+constexpr std::int32_t OFFER_RETRIES_COUNTER_TYPE_ID = COUNTER_TYPE_ID_BASE + 4;
+constexpr std::int32_t BACK_PRESSURE_EVENTS_COUNTER_TYPE_ID = COUNTER_TYPE_ID_BASE + 5;
+constexpr std::int32_t IN_FLIGHT_COUNTER_TYPE_ID = COUNTER_TYPE_ID_BASE + 6;
+
+// DutyCycleTracker, one of each per polling loop of a control session
+constexpr std::int32_t DUTY_CYCLE_ITERATIONS_COUNTER_TYPE_ID = COUNTER_TYPE_ID_BASE + 10;
+constexpr std::int32_t DUTY_CYCLE_WORK_CYCLES_COUNTER_TYPE_ID = COUNTER_TYPE_ID_BASE + 11;
+constexpr std::int32_t DUTY_CYCLE_MAX_CYCLE_NS_COUNTER_TYPE_ID = COUNTER_TYPE_ID_BASE + 12;
+constexpr std::int32_t DUTY_CYCLE_INVOKER_NS_COUNTER_TYPE_ID = COUNTER_TYPE_ID_BASE + 13;
+
+}  // namespace archive
+}  // namespace aeron
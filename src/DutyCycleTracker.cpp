@@ -0,0 +1,134 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <thread>
+
+#include "DutyCycleTracker.h"
+
+namespace {
+
+#pragma pack(push, 4)
+struct DutyCycleKey {
+    std::int64_t controlSessionId;
+    std::int32_t loopId;
+};
+#pragma pack(pop)
+
+}  // namespace
+
+namespace aeron {
+namespace archive {
+
+constexpr std::int32_t DutyCycleTracker::ITERATIONS_TYPE_ID;
+constexpr std::int32_t DutyCycleTracker::WORK_CYCLES_TYPE_ID;
+constexpr std::int32_t DutyCycleTracker::MAX_CYCLE_NS_TYPE_ID;
+constexpr std::int32_t DutyCycleTracker::INVOKER_NS_TYPE_ID;
+constexpr std::int64_t DutyCycleTracker::INVOKE_SAMPLE_INTERVAL;
+
+DutyCycleTracker::Scope::Scope(DutyCycleTracker& tracker)
+    : tracker_(tracker) {}
+
+DutyCycleTracker::Scope::~Scope() { tracker_.end(); }
+
+DutyCycleTracker::DutyCycleTracker(std::int32_t loopId, const std::string& name)
+    : loopId_(loopId)
+    , name_(name) {}
+
+void DutyCycleTracker::attach(Aeron& aeron, std::int64_t controlSessionId) {
+    iterationsCounter_ = addCounter(aeron, ITERATIONS_TYPE_ID, controlSessionId, "iterations");
+    workCyclesCounter_ = addCounter(aeron, WORK_CYCLES_TYPE_ID, controlSessionId, "work cycles");
+    maxCycleNsCounter_ = addCounter(aeron, MAX_CYCLE_NS_TYPE_ID, controlSessionId, "max cycle ns");
+    invokerNsCounter_ = addCounter(aeron, INVOKER_NS_TYPE_ID, controlSessionId, "invoker ns");
+
+    end();
+}
+
+DutyCycleTracker::TimePoint DutyCycleTracker::beginCycle() {
+    const TimePoint now = Clock::now();
+
+    closeCycle(now);
+    cycleStart_ = now;
+    isCycleOpen_ = true;
+    ++iterations_;
+
+    return now;
+}
+
+void DutyCycleTracker::onWork() { ++workCycles_; }
+
+void DutyCycleTracker::beginInvoke() {
+    // closed by the start of the next cycle, the other cycles cost a single clock read
+    if ((iterations_ & (INVOKE_SAMPLE_INTERVAL - 1)) == 0) {
+        invokeStart_ = Clock::now();
+        isInvoking_ = true;
+    }
+}
+
+void DutyCycleTracker::end() {
+    if (isCycleOpen_) {
+        closeCycle(Clock::now());
+        isCycleOpen_ = false;
+    }
+
+    if (iterationsCounter_) {
+        iterationsCounter_->setOrdered(iterations_);
+        workCyclesCounter_->setOrdered(workCycles_);
+        maxCycleNsCounter_->setOrdered(maxCycleNs_);
+        invokerNsCounter_->setOrdered(invokerNs_);
+    }
+}
+
+std::int64_t DutyCycleTracker::iterations() const { return iterations_; }
+
+std::int64_t DutyCycleTracker::workCycles() const { return workCycles_; }
+
+std::int64_t DutyCycleTracker::maxCycleNs() const { return maxCycleNs_; }
+
+std::int64_t DutyCycleTracker::invokerNs() const { return invokerNs_; }
+
+void DutyCycleTracker::closeCycle(const TimePoint& now) {
+    if (isInvoking_) {
+        invokerNs_ += std::chrono::duration_cast<std::chrono::nanoseconds>(now - invokeStart_).count() *
+                      INVOKE_SAMPLE_INTERVAL;
+        isInvoking_ = false;
+    }
+
+    if (isCycleOpen_) {
+        const std::int64_t cycleNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now - cycleStart_).count();
+        if (cycleNs > maxCycleNs_) {
+            maxCycleNs_ = cycleNs;
+        }
+    }
+}
+
+std::shared_ptr<Counter> DutyCycleTracker::addCounter(Aeron& aeron, std::int32_t typeId,
+                                                      std::int64_t controlSessionId, const std::string& name) {
+    const DutyCycleKey key{controlSessionId, loopId_};
+    const std::string label =
+        "archive client " + name_ + " " + name + ": controlSessionId=" + std::to_string(controlSessionId);
+
+    std::int64_t counterId =
+        aeron.addCounter(typeId, reinterpret_cast<const std::uint8_t*>(&key), sizeof(key), label);
+    std::shared_ptr<Counter> counter;
+    while (!(counter = aeron.findCounter(counterId))) {
+        std::this_thread::yield();
+    }
+
+    return counter;
+}
+
+}  // namespace archive
+}  // namespace aeron
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+
+#include <Aeron.h>
+
+#include "CounterTypes.h"
+
+namespace aeron {
+namespace archive {
+
+// Duty cycle of one polling loop: how many times it spun, how many spins did work, the longest spin and the
+// time spent in the Aeron client conductor. A cycle reads the clock once at its start, which also ends the cycle
+// before it, and the loop uses that value for its deadline checks. Only one invoke in INVOKE_SAMPLE_INTERVAL is
+// timed, with a clock read of its own, so the invoker time is an estimate. The totals are plain fields published
+// to Aeron counters when a loop exits, once counters are attached.
+class DutyCycleTracker {
+public:
+    using Clock = std::chrono::high_resolution_clock;
+    using TimePoint = Clock::time_point;
+
+    static constexpr std::int32_t ITERATIONS_TYPE_ID = DUTY_CYCLE_ITERATIONS_COUNTER_TYPE_ID;
+    static constexpr std::int32_t WORK_CYCLES_TYPE_ID = DUTY_CYCLE_WORK_CYCLES_COUNTER_TYPE_ID;
+    static constexpr std::int32_t MAX_CYCLE_NS_TYPE_ID = DUTY_CYCLE_MAX_CYCLE_NS_COUNTER_TYPE_ID;
+    static constexpr std::int32_t INVOKER_NS_TYPE_ID = DUTY_CYCLE_INVOKER_NS_COUNTER_TYPE_ID;
+    // a power of two
+    static constexpr std::int64_t INVOKE_SAMPLE_INTERVAL = 64;
+
+    // ends the loop (and publishes) however the scope is left
+    class Scope {
+    public:
+        explicit Scope(DutyCycleTracker& tracker);
+        ~Scope();
+
+    private:
+        DutyCycleTracker& tracker_;
+    };
+
+    DutyCycleTracker(std::int32_t loopId, const std::string& name);
+
+    DutyCycleTracker(const DutyCycleTracker&) = delete;
+    DutyCycleTracker& operator=(const DutyCycleTracker&) = delete;
+
+    void attach(aeron::Aeron& aeron, std::int64_t controlSessionId);
+
+    // starts a cycle and returns the time it started at
+    TimePoint beginCycle();
+    void onWork();
+    // times the invoke of a sampled cycle only
+    void beginInvoke();
+    void end();
+
+    std::int64_t iterations() const;
+    std::int64_t workCycles() const;
+    std::int64_t maxCycleNs() const;
+    std::int64_t invokerNs() const;
+
+private:
+    void closeCycle(const TimePoint& now);
+    std::shared_ptr<aeron::Counter> addCounter(aeron::Aeron& aeron, std::int32_t typeId, std::int64_t controlSessionId,
+                                               const std::string& name);
+
+private:
+    const std::int32_t loopId_;
+    const std::string name_;
+
+    std::int64_t iterations_{0};
+    std::int64_t workCycles_{0};
+    std::int64_t maxCycleNs_{0};
+    std::int64_t invokerNs_{0};
+
+    TimePoint cycleStart_;
+    TimePoint invokeStart_;
+    bool isCycleOpen_{false};
+    bool isInvoking_{false};
+
+    std::shared_ptr<aeron::Counter> iterationsCounter_;
+    std::shared_ptr<aeron::Counter> workCyclesCounter_;
+    std::shared_ptr<aeron::Counter> maxCycleNsCounter_;
+    std::shared_ptr<aeron::Counter> invokerNsCounter_;
+};
+
+}  // namespace archive
+}  // namespace aeron
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+#include <concurrent/ringbuffer/ManyToOneRingBuffer.h>
+#include <concurrent/ringbuffer/RingBufferDescriptor.h>
+#include <util/MemoryMappedFile.h>
+
+#include "ArchiveException.h"
+#include "EventLog.h"
+
+namespace {
+
+struct EventLogFile {
+    EventLogFile(const std::string& fileName, std::int32_t capacity)
+        : file(aeron::util::MemoryMappedFile::createNew(
+              fileName.c_str(), 0, capacity + aeron::concurrent::ringbuffer::RingBufferDescriptor::TRAILER_LENGTH))
+        , buffer(file->getMemoryPtr(), static_cast<aeron::util::index_t>(file->getMemorySize()))
+        , ringBuffer(buffer) {}
+
+    aeron::util::MemoryMappedFile::ptr_t file;
+    aeron::concurrent::AtomicBuffer buffer;
+    aeron::concurrent::ringbuffer::ManyToOneRingBuffer ringBuffer;
+};
+
+// never released so a concurrent log() cannot see it go away
+std::atomic<EventLogFile*> eventLogFile{nullptr};
+std::atomic<std::int64_t> dropped{0};
+std::mutex enableLock;
+
+std::int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+}  // namespace
+
+namespace aeron {
+namespace archive {
+
+void EventLog::enable(const std::string& fileName, std::int32_t capacity) {
+    std::unique_lock<std::mutex> lock(enableLock);
+
+    if (eventLogFile.load(std::memory_order_acquire)) {
+        throw ArchiveException("event log already enabled", SOURCEINFO);
+    }
+
+    eventLogFile.store(new EventLogFile(fileName, capacity), std::memory_order_release);
+}
+
+bool EventLog::isEnabled() { return eventLogFile.load(std::memory_order_acquire) != nullptr; }
+
+std::int64_t EventLog::droppedCount() { return dropped.load(std::memory_order_relaxed); }
+
+void EventLog::log(EventCode code, std::int64_t arg1, std::int64_t arg2, std::int64_t arg3, std::int32_t arg4,
+                   std::int32_t arg5) {
+    EventLogFile* logFile = eventLogFile.load(std::memory_order_acquire);
+    if (!logFile) {
+        return;
+    }
+
+    EventRecord record{nowNs(), arg1, arg2, arg3, arg4, arg5};
+    concurrent::AtomicBuffer src(reinterpret_cast<std::uint8_t*>(&record), sizeof(record));
+
+    if (!logFile->ringBuffer.write(static_cast<std::int32_t>(code), src, 0, sizeof(record))) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::string EventLog::format(std::int32_t code, const concurrent::AtomicBuffer& buffer, util::index_t offset,
+                             util::index_t length) {
+    if (length < static_cast<util::index_t>(sizeof(EventRecord))) {
+        return "malformed event: code=" + std::to_string(code) + ", length=" + std::to_string(length);
+    }
+
+    EventRecord record;
+    buffer.getBytes(offset, reinterpret_cast<std::uint8_t*>(&record), sizeof(record));
+
+    std::string text = std::to_string(record.timestampNs) + " ";
+
+    switch (static_cast<EventCode>(code)) {
+        case EventCode::REQUEST_SENT:
+            return text + "REQUEST_SENT controlSessionId=" + std::to_string(record.arg2) +
+                   " correlationId=" + std::to_string(record.arg3) + " templateId=" + std::to_string(record.arg4) +
+                   " length=" + std::to_string(record.arg5) + " attempts=" + std::to_string(record.arg1);
+        case EventCode::CONTROL_RESPONSE:
+            return text + "CONTROL_RESPONSE controlSessionId=" + std::to_string(record.arg1) +
+                   " correlationId=" + std::to_string(record.arg2) + " relevantId=" + std::to_string(record.arg3) +
+                   " code=" + std::to_string(record.arg4);
+        case EventCode::RECORDING_DESCRIPTOR:
+            return text + "RECORDING_DESCRIPTOR controlSessionId=" + std::to_string(record.arg1) +
+                   " correlationId=" + std::to_string(record.arg2) + " recordingId=" + std::to_string(record.arg3) +
+                   " remaining=" + std::to_string(record.arg4);
+        case EventCode::RECORDING_STARTED:
+            return text + "RECORDING_STARTED recordingId=" + std::to_string(record.arg1) +
+                   " startPosition=" + std::to_string(record.arg2) + " sessionId=" + std::to_string(record.arg4) +
+                   " streamId=" + std::to_string(record.arg5);
+        case EventCode::RECORDING_PROGRESS:
+            return text + "RECORDING_PROGRESS recordingId=" + std::to_string(record.arg1) +
+                   " startPosition=" + std::to_string(record.arg2) + " position=" + std::to_string(record.arg3);
+        case EventCode::RECORDING_STOPPED:
+            return text + "RECORDING_STOPPED recordingId=" + std::to_string(record.arg1) +
+                   " startPosition=" + std::to_string(record.arg2) + " stopPosition=" + std::to_string(record.arg3);
+        case EventCode::TIMEOUT:
+            return text + "TIMEOUT controlSessionId=" + std::to_string(record.arg1) +
+                   " correlationId=" + std::to_string(record.arg2);
+    }
+
+    return text + "UNKNOWN code=" + std::to_string(code);
+}
+
+}  // namespace archive
+}  // namespace aeron
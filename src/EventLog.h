@@ -0,0 +1,79 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <concurrent/AtomicBuffer.h>
+
+namespace aeron {
+namespace archive {
+
+enum class EventCode : std::int32_t {
+    REQUEST_SENT = 1,
+    CONTROL_RESPONSE = 2,
+    RECORDING_DESCRIPTOR = 3,
+    RECORDING_STARTED = 4,
+    RECORDING_PROGRESS = 5,
+    RECORDING_STOPPED = 6,
+    TIMEOUT = 7
+};
+
+// fixed size binary record, the meaning of the arguments depends on the event code (see EventLog::format)
+struct EventRecord {
+    std::int64_t timestampNs;
+    std::int64_t arg1;
+    std::int64_t arg2;
+    std::int64_t arg3;
+    std::int32_t arg4;
+    std::int32_t arg5;
+};
+
+// Process wide binary log of client internals written into a many-to-one ring buffer in a memory mapped file,
+// so it can be read by another process (see the EventLogReader sample). Logging is compiled in with
+// -DAERON_ARCHIVE_EVENT_LOG (CMake option EVENT_LOG_BUILD) and does nothing until the log is enabled.
+// A record that does not fit because the reader is behind is dropped and counted.
+class EventLog {
+public:
+    // creates the file, the capacity has to be a power of 2; can be enabled once per process
+    static void enable(const std::string& fileName, std::int32_t capacity);
+    static bool isEnabled();
+    static std::int64_t droppedCount();
+
+    static void log(EventCode code, std::int64_t arg1, std::int64_t arg2, std::int64_t arg3, std::int32_t arg4,
+                    std::int32_t arg5);
+
+    static std::string format(std::int32_t code, const aeron::concurrent::AtomicBuffer& buffer,
+                              aeron::util::index_t offset, aeron::util::index_t length);
+};
+
+}  // namespace archive
+}  // namespace aeron
+
+#if defined(AERON_ARCHIVE_EVENT_LOG)
+#define AERON_ARCHIVE_LOG_EVENT(code, arg1, arg2, arg3, arg4, arg5) \
+    ::aeron::archive::EventLog::log((code), (arg1), (arg2), (arg3), (arg4), (arg5))
+#else
+// the arguments are still type checked but never evaluated
+#define AERON_ARCHIVE_LOG_EVENT(code, arg1, arg2, arg3, arg4, arg5)                          \
+    do {                                                                                     \
+        if (false) {                                                                         \
+            ::aeron::archive::EventLog::log((code), (arg1), (arg2), (arg3), (arg4), (arg5)); \
+        }                                                                                    \
+    } while (false)
+#endif
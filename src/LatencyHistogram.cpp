@@ -0,0 +1,167 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "LatencyHistogram.h"
+
+namespace {
+
+const std::int32_t SUB_BUCKET_COUNT = 1 << aeron::archive::LatencyHistogram::SUB_BUCKET_BITS;
+const std::int32_t SUB_BUCKET_HALF_COUNT = SUB_BUCKET_COUNT / 2;
+const std::int64_t MAX_VALUE = (std::int64_t{1} << aeron::archive::LatencyHistogram::MAX_VALUE_BITS) - 1;
+
+std::int32_t highestBit(std::uint64_t value) { return 63 - __builtin_clzll(value); }
+
+}  // namespace
+
+namespace aeron {
+namespace archive {
+
+constexpr std::int32_t LatencyHistogram::SUB_BUCKET_BITS;
+constexpr std::int32_t LatencyHistogram::MAX_VALUE_BITS;
+constexpr std::int32_t LatencyHistogram::BUCKET_COUNT;
+
+double LatencySnapshot::mean() const { return totalCount > 0 ? static_cast<double>(sum) / totalCount : 0.0; }
+
+std::int64_t LatencySnapshot::valueAtPercentile(double percentile) const {
+    if (totalCount == 0) {
+        return 0;
+    }
+
+    const double clamped = std::min(std::max(percentile, 0.0), 100.0);
+    const std::int64_t target =
+        std::max<std::int64_t>(1, static_cast<std::int64_t>(std::ceil(clamped / 100.0 * totalCount)));
+
+    std::int64_t seen = 0;
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= target) {
+            return std::min(LatencyHistogram::highestEquivalentValue(static_cast<std::int32_t>(i)), maxValue);
+        }
+    }
+
+    return maxValue;
+}
+
+LatencyHistogram::LatencyHistogram()
+    : minValue_(std::numeric_limits<std::int64_t>::max()) {
+    for (auto& count : counts_) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::record(std::int64_t value) {
+    value = std::min(std::max<std::int64_t>(value, 0), MAX_VALUE);
+
+    counts_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    totalCount_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+
+    std::int64_t max = maxValue_.load(std::memory_order_relaxed);
+    while (value > max && !maxValue_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+
+    std::int64_t min = minValue_.load(std::memory_order_relaxed);
+    while (value < min && !minValue_.compare_exchange_weak(min, value, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::recordCorrected(std::int64_t value, std::int64_t expectedInterval) {
+    record(value);
+
+    if (expectedInterval <= 0) {
+        return;
+    }
+
+    for (std::int64_t missing = value - expectedInterval; missing >= expectedInterval; missing -= expectedInterval) {
+        record(missing);
+    }
+}
+
+LatencySnapshot LatencyHistogram::snapshot() const {
+    LatencySnapshot snapshot{std::vector<std::int64_t>(BUCKET_COUNT), 0, 0, 0, 0};
+
+    for (std::int32_t i = 0; i < BUCKET_COUNT; ++i) {
+        snapshot.counts[i] = counts_[i].load(std::memory_order_relaxed);
+        snapshot.totalCount += snapshot.counts[i];
+    }
+
+    snapshot.sum = sum_.load(std::memory_order_relaxed);
+    snapshot.maxValue = maxValue_.load(std::memory_order_relaxed);
+    snapshot.minValue = snapshot.totalCount > 0 ? minValue_.load(std::memory_order_relaxed) : 0;
+
+    return snapshot;
+}
+
+LatencySnapshot LatencyHistogram::snapshotAndReset() {
+    LatencySnapshot snapshot{std::vector<std::int64_t>(BUCKET_COUNT), 0, 0, 0, 0};
+
+    // values recorded while this runs land either in this snapshot or in the next one
+    for (std::int32_t i = 0; i < BUCKET_COUNT; ++i) {
+        snapshot.counts[i] = counts_[i].exchange(0, std::memory_order_relaxed);
+        snapshot.totalCount += snapshot.counts[i];
+    }
+
+    totalCount_.store(0, std::memory_order_relaxed);
+    snapshot.sum = sum_.exchange(0, std::memory_order_relaxed);
+    snapshot.maxValue = maxValue_.exchange(0, std::memory_order_relaxed);
+    const std::int64_t minValue = minValue_.exchange(std::numeric_limits<std::int64_t>::max(), std::memory_order_relaxed);
+    snapshot.minValue = snapshot.totalCount > 0 ? minValue : 0;
+
+    return snapshot;
+}
+
+void LatencyHistogram::reset() { snapshotAndReset(); }
+
+std::int32_t LatencyHistogram::bucketIndex(std::int64_t value) {
+    if (value < SUB_BUCKET_COUNT) {
+        return static_cast<std::int32_t>(std::max<std::int64_t>(value, 0));
+    }
+
+    // value >> shift lands in the upper half of the sub buckets
+    const std::int32_t shift = highestBit(static_cast<std::uint64_t>(std::min(value, MAX_VALUE))) -
+                               (SUB_BUCKET_BITS - 1);
+    const std::int64_t subBucket = (std::min(value, MAX_VALUE) >> shift) - SUB_BUCKET_HALF_COUNT;
+
+    return SUB_BUCKET_COUNT + (shift - 1) * SUB_BUCKET_HALF_COUNT + static_cast<std::int32_t>(subBucket);
+}
+
+std::int64_t LatencyHistogram::lowestEquivalentValue(std::int32_t index) {
+    if (index < SUB_BUCKET_COUNT) {
+        return index;
+    }
+
+    const std::int32_t shift = (index - SUB_BUCKET_COUNT) / SUB_BUCKET_HALF_COUNT + 1;
+    const std::int64_t subBucket = (index - SUB_BUCKET_COUNT) % SUB_BUCKET_HALF_COUNT + SUB_BUCKET_HALF_COUNT;
+
+    return subBucket << shift;
+}
+
+std::int64_t LatencyHistogram::highestEquivalentValue(std::int32_t index) {
+    if (index < SUB_BUCKET_COUNT) {
+        return index;
+    }
+
+    const std::int32_t shift = (index - SUB_BUCKET_COUNT) / SUB_BUCKET_HALF_COUNT + 1;
+
+    return lowestEquivalentValue(index) + (std::int64_t{1} << shift) - 1;
+}
+
+}  // namespace archive
+}  // namespace aeron
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace aeron {
+namespace archive {
+
+struct LatencySnapshot {
+    std::vector<std::int64_t> counts;
+    std::int64_t totalCount;
+    std::int64_t minValue;
+    std::int64_t maxValue;
+    std::int64_t sum;
+
+    double mean() const;
+    // highest value equivalent to the value at the given percentile (0..100), 0 if empty
+    std::int64_t valueAtPercentile(double percentile) const;
+};
+
+// Fixed memory, lock-free latency recorder with log-linear buckets in the style of HdrHistogram.
+// Values (nanoseconds) are kept with a relative error below 1/64 up to 2^44, larger values are clamped.
+// Recording is a handful of relaxed atomic adds, a snapshot is not atomic across buckets.
+class LatencyHistogram {
+public:
+    static constexpr std::int32_t SUB_BUCKET_BITS = 7;
+    static constexpr std::int32_t MAX_VALUE_BITS = 44;
+    static constexpr std::int32_t BUCKET_COUNT =
+        (1 << SUB_BUCKET_BITS) + (MAX_VALUE_BITS - SUB_BUCKET_BITS) * (1 << (SUB_BUCKET_BITS - 1));
+
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(std::int64_t value);
+    // records the value and, for a value longer than the expected interval between samples, the samples a stalled
+    // fixed rate sender would have taken meanwhile (coordinated omission correction)
+    void recordCorrected(std::int64_t value, std::int64_t expectedInterval);
+
+    LatencySnapshot snapshot() const;
+    LatencySnapshot snapshotAndReset();
+    void reset();
+
+    static std::int32_t bucketIndex(std::int64_t value);
+    static std::int64_t lowestEquivalentValue(std::int32_t index);
+    static std::int64_t highestEquivalentValue(std::int32_t index);
+
+private:
+    std::array<std::atomic<std::int64_t>, BUCKET_COUNT> counts_;
+    std::atomic<std::int64_t> totalCount_{0};
+    std::atomic<std::int64_t> minValue_;
+    std::atomic<std::int64_t> maxValue_{0};
+    std::atomic<std::int64_t> sum_{0};
+};
+
+}  // namespace archive
+}  // namespace aeron
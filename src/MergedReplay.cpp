@@ -0,0 +1,156 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include "ArchiveException.h"
+#include "MergedReplay.h"
+
+namespace {
+
+const std::int32_t FRAGMENT_LIMIT = 10;
+const std::int32_t MIN_MESSAGE_LENGTH = 32;
+
+}  // namespace
+
+namespace aeron {
+namespace archive {
+
+MergedReplay::Stream::Stream(util::index_t windowLength, std::int32_t maxMessages)
+    : window(windowLength, maxMessages) {}
+
+MergedReplay::MergedReplay(const std::shared_ptr<AeronArchive>& archive, const std::string& replayChannel,
+                           std::int32_t replayStreamId, util::index_t windowLength, TimestampExtractor&& extractor)
+    : windowLength_(windowLength)
+    , extractor_(std::move(extractor))
+    , multiplexer_(archive, replayChannel, replayStreamId, std::numeric_limits<std::int32_t>::max(), FRAGMENT_LIMIT,
+                   [this](std::int64_t replayId, std::int64_t position) { onReplayComplete(replayId); },
+                   // replays are never queued under an unbounded cap, they start or throw from add()
+                   nullptr) {}
+
+std::int32_t MergedReplay::add(std::int64_t recordingId, std::int64_t position, std::int64_t length) {
+    const std::int32_t streamIndex = static_cast<std::int32_t>(streams_.size());
+    auto stream = std::make_unique<Stream>(windowLength_, windowLength_ / MIN_MESSAGE_LENGTH);
+
+    // the stream is only counted once its replay has started, one which failed to start would starve the merge
+    std::int64_t replayId = multiplexer_.replay(
+        recordingId, position, length,
+        [this, streamIndex](concurrent::AtomicBuffer& buffer, util::index_t offset, util::index_t length,
+                            Header& header) { return onMessage(streamIndex, buffer, offset, length); });
+
+    streams_.push_back(std::move(stream));
+    ++starvedCount_;
+    streamIndexByReplayId_.emplace(replayId, streamIndex);
+
+    return streamIndex;
+}
+
+std::int32_t MergedReplay::poll(const MessageHandler& handler, std::int32_t messageLimit) {
+    std::int32_t workCount = multiplexer_.poll();
+    std::int32_t emitted = 0;
+
+    // the smallest head is only known to be the next message once no live stream is empty
+    while (emitted < messageLimit && starvedCount_ == 0 && !heads_.empty()) {
+        const std::int32_t streamIndex = popHead();
+        Stream& stream = *streams_[streamIndex];
+
+        handler(streamIndex, stream.window.buffer(), stream.window.headOffset(), stream.window.headLength());
+        stream.window.pop();
+        ++emitted;
+
+        if (!stream.window.isEmpty()) {
+            pushHead(streamIndex);
+        } else if (!stream.isDone) {
+            ++starvedCount_;
+        }
+    }
+
+    return workCount + emitted;
+}
+
+bool MergedReplay::isDone() const {
+    return std::all_of(streams_.begin(), streams_.end(), [](const std::unique_ptr<Stream>& stream) {
+        return stream->isDone && stream->window.isEmpty();
+    });
+}
+
+std::int32_t MergedReplay::streamCount() const { return static_cast<std::int32_t>(streams_.size()); }
+
+ControlledPollAction MergedReplay::onMessage(std::int32_t streamIndex, concurrent::AtomicBuffer& buffer,
+                                             util::index_t offset, util::index_t length) {
+    Stream& stream = *streams_[streamIndex];
+
+    if (length > stream.window.capacity()) {
+        throw ArchiveException("message of " + std::to_string(length) + " bytes does not fit a window of " +
+                                   std::to_string(stream.window.capacity()),
+                               SOURCEINFO);
+    }
+
+    const bool wasEmpty = stream.window.isEmpty();
+
+    if (!stream.window.offer(extractor_(buffer, offset, length), buffer, offset, length)) {
+        // the window is full, the stream waits until the merge catches up
+        return ControlledPollAction::ABORT;
+    }
+
+    if (wasEmpty) {
+        pushHead(streamIndex);
+        --starvedCount_;
+    }
+
+    return ControlledPollAction::CONTINUE;
+}
+
+void MergedReplay::onReplayComplete(std::int64_t replayId) {
+    auto it = streamIndexByReplayId_.find(replayId);
+    if (it == streamIndexByReplayId_.end()) {
+        return;
+    }
+
+    Stream& stream = *streams_[it->second];
+    stream.isDone = true;
+
+    if (stream.window.isEmpty()) {
+        --starvedCount_;
+    }
+
+    streamIndexByReplayId_.erase(it);
+}
+
+bool MergedReplay::isBefore(std::int32_t lhs, std::int32_t rhs) const {
+    const std::int64_t lhsTimestamp = streams_[lhs]->window.headTimestamp();
+    const std::int64_t rhsTimestamp = streams_[rhs]->window.headTimestamp();
+
+    // ties are broken by stream index to keep the merge deterministic
+    return lhsTimestamp < rhsTimestamp || (lhsTimestamp == rhsTimestamp && lhs < rhs);
+}
+
+void MergedReplay::pushHead(std::int32_t streamIndex) {
+    heads_.push_back(streamIndex);
+    std::push_heap(heads_.begin(), heads_.end(), [this](std::int32_t lhs, std::int32_t rhs) { return isBefore(rhs, lhs); });
+}
+
+std::int32_t MergedReplay::popHead() {
+    std::pop_heap(heads_.begin(), heads_.end(), [this](std::int32_t lhs, std::int32_t rhs) { return isBefore(rhs, lhs); });
+
+    const std::int32_t streamIndex = heads_.back();
+    heads_.pop_back();
+    return streamIndex;
+}
+
+}  // namespace archive
+}  // namespace aeron
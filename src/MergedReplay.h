@@ -0,0 +1,83 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "AeronArchive.h"
+#include "MessageWindow.h"
+#include "ReplayMultiplexer.h"
+
+namespace aeron {
+namespace archive {
+
+// Replays several recordings at the same time and delivers their messages in a single order given by
+// a user extracted timestamp (or sequence). Every stream buffers a bounded window, a stream whose window
+// is full is back pressured while the others catch up. Messages are only released once every stream
+// which has not ended has at least one message buffered.
+// Not thread safe, all calls are expected from the polling thread.
+class MergedReplay {
+public:
+    using TimestampExtractor = std::function<std::int64_t(const aeron::concurrent::AtomicBuffer& buffer,
+                                                          aeron::util::index_t offset, aeron::util::index_t length)>;
+    using MessageHandler = std::function<void(std::int32_t streamIndex, aeron::concurrent::AtomicBuffer& buffer,
+                                              aeron::util::index_t offset, aeron::util::index_t length)>;
+
+    MergedReplay(const std::shared_ptr<AeronArchive>& archive, const std::string& replayChannel,
+                 std::int32_t replayStreamId, aeron::util::index_t windowLength, TimestampExtractor&& extractor);
+
+    MergedReplay(const MergedReplay&) = delete;
+    MergedReplay& operator=(const MergedReplay&) = delete;
+
+    // starts the replay of a recording, returns the index of the stream passed to the message handler
+    std::int32_t add(std::int64_t recordingId, std::int64_t position, std::int64_t length);
+
+    std::int32_t poll(const MessageHandler& handler, std::int32_t messageLimit);
+
+    bool isDone() const;
+    std::int32_t streamCount() const;
+
+private:
+    struct Stream {
+        Stream(aeron::util::index_t windowLength, std::int32_t maxMessages);
+
+        MessageWindow window;
+        bool isDone{false};
+    };
+
+    aeron::ControlledPollAction onMessage(std::int32_t streamIndex, aeron::concurrent::AtomicBuffer& buffer,
+                                          aeron::util::index_t offset, aeron::util::index_t length);
+    void onReplayComplete(std::int64_t replayId);
+
+    bool isBefore(std::int32_t lhs, std::int32_t rhs) const;
+    void pushHead(std::int32_t streamIndex);
+    std::int32_t popHead();
+
+private:
+    const aeron::util::index_t windowLength_;
+    TimestampExtractor extractor_;
+    ReplayMultiplexer multiplexer_;
+
+    std::vector<std::unique_ptr<Stream>> streams_;
+    std::unordered_map<std::int64_t, std::int32_t> streamIndexByReplayId_;
+    std::vector<std::int32_t> heads_;
+    std::int32_t starvedCount_{0};
+};
+
+}  // namespace archive
+}  // namespace aeron
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "MessageWindow.h"
+
+namespace aeron {
+namespace archive {
+
+MessageWindow::MessageWindow(util::index_t capacity, std::int32_t maxMessages)
+    : bytes_(capacity)
+    , buffer_(&bytes_[0], capacity)
+    , entries_(std::max(1, maxMessages)) {}
+
+bool MessageWindow::offer(std::int64_t timestamp, const concurrent::AtomicBuffer& buffer, util::index_t offset,
+                          util::index_t length) {
+    if (size_ == static_cast<std::int32_t>(entries_.size())) {
+        return false;
+    }
+
+    // empty messages still take a byte so the write offset never catches up with the head unnoticed
+    const util::index_t reserved = std::max<util::index_t>(length, 1);
+    util::index_t writeAt;
+
+    if (size_ == 0) {
+        if (reserved > capacity()) {
+            return false;
+        }
+        writeAt = 0;
+    } else {
+        const util::index_t headOffset = entries_[head_].offset;
+
+        if (writeOffset_ > headOffset) {
+            if (writeOffset_ + reserved <= capacity()) {
+                writeAt = writeOffset_;
+            } else if (reserved <= headOffset) {
+                writeAt = 0;
+            } else {
+                return false;
+            }
+        } else if (writeOffset_ + reserved <= headOffset) {
+            writeAt = writeOffset_;
+        } else {
+            return false;
+        }
+    }
+
+    buffer_.putBytes(writeAt, buffer, offset, length);
+
+    entries_[(head_ + size_) % entries_.size()] = Entry{timestamp, writeAt, length};
+    ++size_;
+    writeOffset_ = writeAt + reserved;
+
+    return true;
+}
+
+void MessageWindow::pop() {
+    head_ = (head_ + 1) % static_cast<std::int32_t>(entries_.size());
+
+    if (--size_ == 0) {
+        head_ = 0;
+        writeOffset_ = 0;
+    }
+}
+
+bool MessageWindow::isEmpty() const { return size_ == 0; }
+
+std::int32_t MessageWindow::size() const { return size_; }
+
+util::index_t MessageWindow::capacity() const { return buffer_.capacity(); }
+
+std::int64_t MessageWindow::headTimestamp() const { return entries_[head_].timestamp; }
+
+util::index_t MessageWindow::headOffset() const { return entries_[head_].offset; }
+
+util::index_t MessageWindow::headLength() const { return entries_[head_].length; }
+
+concurrent::AtomicBuffer& MessageWindow::buffer() { return buffer_; }
+
+}  // namespace archive
+}  // namespace aeron
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <concurrent/AtomicBuffer.h>
+
+namespace aeron {
+namespace archive {
+
+// Fixed size window of messages buffered from one replayed stream
+class MessageWindow {
+public:
+    MessageWindow(aeron::util::index_t capacity, std::int32_t maxMessages);
+
+    MessageWindow(const MessageWindow&) = delete;
+    MessageWindow& operator=(const MessageWindow&) = delete;
+
+    bool offer(std::int64_t timestamp, const aeron::concurrent::AtomicBuffer& buffer, aeron::util::index_t offset,
+               aeron::util::index_t length);
+    void pop();
+
+    bool isEmpty() const;
+    std::int32_t size() const;
+    aeron::util::index_t capacity() const;
+    std::int64_t headTimestamp() const;
+    aeron::util::index_t headOffset() const;
+    aeron::util::index_t headLength() const;
+    aeron::concurrent::AtomicBuffer& buffer();
+
+private:
+    struct Entry {
+        std::int64_t timestamp;
+        aeron::util::index_t offset;
+        aeron::util::index_t length;
+    };
+
+    std::vector<std::uint8_t> bytes_;
+    aeron::concurrent::AtomicBuffer buffer_;
+    std::vector<Entry> entries_;
+    std::int32_t head_{0};
+    std::int32_t size_{0};
+    aeron::util::index_t writeOffset_{0};
+};
+
+}  // namespace archive
+}  // namespace aeron
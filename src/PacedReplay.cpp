@@ -0,0 +1,100 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ArchiveException.h"
+#include "PacedReplay.h"
+
+namespace {
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+}  // namespace
+
+namespace aeron {
+namespace archive {
+
+double PacingDrift::meanDriftNs() const { return messages > 0 ? static_cast<double>(totalDriftNs) / messages : 0.0; }
+
+PacedReplay::PacedReplay(const std::shared_ptr<Subscription>& subscription, double speed,
+                         std::chrono::nanoseconds spinThreshold, std::int32_t fragmentLimit,
+                         TimestampExtractor&& extractor)
+    : subscription_(subscription)
+    , speed_(speed)
+    , spinThreshold_(spinThreshold)
+    , fragmentLimit_(fragmentLimit)
+    , extractor_(std::move(extractor))
+    , fragmentAssembler_([this](concurrent::AtomicBuffer& buffer, util::index_t offset, util::index_t length,
+                                Header& header) { return onMessage(buffer, offset, length, header); }) {
+    if (!(speed_ > 0.0)) {
+        throw util::IllegalArgumentException("speed must be positive: " + std::to_string(speed_), SOURCEINFO);
+    }
+}
+
+std::int32_t PacedReplay::poll(const fragment_handler_t& handler) {
+    handler_ = &handler;
+    return subscription_->controlledPoll(fragmentAssembler_.handler(), fragmentLimit_);
+}
+
+const PacingDrift& PacedReplay::drift() const { return drift_; }
+
+void PacedReplay::resetDrift() { drift_ = PacingDrift{0, 0, 0, 0}; }
+
+ControlledPollAction PacedReplay::onMessage(concurrent::AtomicBuffer& buffer, util::index_t offset,
+                                            util::index_t length, Header& header) {
+    const std::int64_t timestamp = extractor_(buffer, offset, length);
+    Clock::time_point now = Clock::now();
+
+    if (!isStarted_) {
+        isStarted_ = true;
+        startTime_ = now;
+        startTimestamp_ = timestamp;
+    }
+
+    const Clock::time_point dueTime =
+        startTime_ + std::chrono::nanoseconds(static_cast<std::int64_t>((timestamp - startTimestamp_) / speed_));
+
+    if (dueTime - now > spinThreshold_) {
+        // not due yet, the message is offered again by a later poll
+        return ControlledPollAction::ABORT;
+    }
+
+    while (now < dueTime) {
+        cpuRelax();
+        now = Clock::now();
+    }
+
+    // taken at release so the time spent in the handler does not count as drift
+    const std::int64_t driftNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now - dueTime).count();
+    ++drift_.messages;
+    drift_.totalDriftNs += driftNs;
+    if (driftNs > drift_.maxDriftNs) {
+        drift_.maxDriftNs = driftNs;
+    }
+    if (driftNs > spinThreshold_.count()) {
+        ++drift_.lateMessages;
+    }
+
+    (*handler_)(buffer, offset, length, header);
+
+    return ControlledPollAction::CONTINUE;
+}
+
+}  // namespace archive
+}  // namespace aeron
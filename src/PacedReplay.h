@@ -0,0 +1,79 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+
+#include <Aeron.h>
+#include <ControlledFragmentAssembler.h>
+
+namespace aeron {
+namespace archive {
+
+struct PacingDrift {
+    std::int64_t messages;
+    std::int64_t lateMessages;
+    std::int64_t totalDriftNs;
+    std::int64_t maxDriftNs;
+
+    double meanDriftNs() const;
+};
+
+// Re-emits replayed messages with their original inter-arrival gaps scaled by a speed factor
+// (2.0 plays twice as fast). Gaps longer than the spin threshold are waited out across poll() calls,
+// shorter ones are spun on so a message is released as close as possible to its due time.
+// Not thread safe, all calls are expected from the polling thread.
+class PacedReplay {
+    using Clock = std::chrono::steady_clock;
+
+public:
+    // timestamps are in nanoseconds
+    using TimestampExtractor = std::function<std::int64_t(const aeron::concurrent::AtomicBuffer& buffer,
+                                                          aeron::util::index_t offset, aeron::util::index_t length)>;
+
+    PacedReplay(const std::shared_ptr<aeron::Subscription>& subscription, double speed,
+                std::chrono::nanoseconds spinThreshold, std::int32_t fragmentLimit, TimestampExtractor&& extractor);
+
+    PacedReplay(const PacedReplay&) = delete;
+    PacedReplay& operator=(const PacedReplay&) = delete;
+
+    std::int32_t poll(const aeron::fragment_handler_t& handler);
+
+    const PacingDrift& drift() const;
+    void resetDrift();
+
+private:
+    aeron::ControlledPollAction onMessage(aeron::concurrent::AtomicBuffer& buffer, aeron::util::index_t offset,
+                                          aeron::util::index_t length, aeron::Header& header);
+
+private:
+    std::shared_ptr<aeron::Subscription> subscription_;
+    const double speed_;
+    const std::chrono::nanoseconds spinThreshold_;
+    const std::int32_t fragmentLimit_;
+    TimestampExtractor extractor_;
+    aeron::ControlledFragmentAssembler fragmentAssembler_;
+
+    const aeron::fragment_handler_t* handler_{nullptr};
+    bool isStarted_{false};
+    Clock::time_point startTime_;
+    std::int64_t startTimestamp_{0};
+    PacingDrift drift_{0, 0, 0, 0};
+};
+
+}  // namespace archive
+}  // namespace aeron
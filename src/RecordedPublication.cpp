@@ -0,0 +1,99 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ArchiveException.h"
+#include "RecordedPublication.h"
+
+namespace {
+
+const std::int64_t NULL_POSITION = -1;
+
+std::int64_t validateMaxRecordingLag(std::int64_t maxRecordingLag) {
+    if (maxRecordingLag <= 0) {
+        throw aeron::util::IllegalArgumentException(
+            "max recording lag must be positive: " + std::to_string(maxRecordingLag), SOURCEINFO);
+    }
+
+    return maxRecordingLag;
+}
+
+}  // namespace
+
+namespace aeron {
+namespace archive {
+
+constexpr std::int64_t RecordedPublication::RECORDING_BACK_PRESSURED;
+
+RecordedPublication::RecordedPublication(const std::shared_ptr<AeronArchive>& archive, const std::string& channel,
+                                         std::int32_t streamId, std::int64_t maxRecordingLag)
+    : maxRecordingLag_(validateMaxRecordingLag(maxRecordingLag))
+    , publication_(archive->addRecordedExclusivePublication(channel, streamId))
+    , ackTracker_(archive, publication_->sessionId()) {
+    cachedRecordedPosition_ = ackTracker_.recordedPosition();
+}
+
+std::int64_t RecordedPublication::offer(const concurrent::AtomicBuffer& buffer, util::index_t offset,
+                                        util::index_t length) {
+    if (isRecordingLagging()) {
+        return RECORDING_BACK_PRESSURED;
+    }
+
+    return publication_->offer(buffer, offset, length);
+}
+
+std::int64_t RecordedPublication::offer(const concurrent::AtomicBuffer& buffer) {
+    return offer(buffer, 0, buffer.capacity());
+}
+
+std::int64_t RecordedPublication::tryClaim(util::index_t length, concurrent::logbuffer::BufferClaim& bufferClaim) {
+    if (isRecordingLagging()) {
+        return RECORDING_BACK_PRESSURED;
+    }
+
+    return publication_->tryClaim(length, bufferClaim);
+}
+
+std::int64_t RecordedPublication::position() const { return publication_->position(); }
+
+std::int64_t RecordedPublication::recordedPosition() {
+    cachedRecordedPosition_ = ackTracker_.recordedPosition();
+    return cachedRecordedPosition_;
+}
+
+std::int64_t RecordedPublication::maxRecordingLag() const { return maxRecordingLag_; }
+
+bool RecordedPublication::isRecording() const { return ackTracker_.stopPosition() == NULL_POSITION; }
+
+const std::shared_ptr<ExclusivePublication>& RecordedPublication::publication() const { return publication_; }
+
+RecordingAckTracker& RecordedPublication::ackTracker() { return ackTracker_; }
+
+bool RecordedPublication::isRecordingLagging() {
+    const std::int64_t position = publication_->position();
+
+    if (position - cachedRecordedPosition_ <= maxRecordingLag_) {
+        return false;
+    }
+
+    // only go to the counter when the cached value is not enough to let the offer through, the stop position of
+    // a recording which is no longer active is left to recordedPosition() off the offer path
+    const bool isActive = ackTracker_.readCounter(cachedRecordedPosition_);
+
+    return isActive && position - cachedRecordedPosition_ > maxRecordingLag_;
+}
+
+}  // namespace archive
+}  // namespace aeron
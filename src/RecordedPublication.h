@@ -0,0 +1,66 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <Aeron.h>
+
+#include "AeronArchive.h"
+#include "RecordingAckTracker.h"
+
+namespace aeron {
+namespace archive {
+
+// Recorded exclusive publication which pushes back on the producer once the publication runs further ahead
+// of what the archive has recorded than the given window. The recorded position is cached and the counter is
+// only read again when the cached value says the window is exceeded. Offers never wait on the archive, once the
+// counter is no longer active there is nothing left to protect and offers go straight to the publication.
+class RecordedPublication {
+public:
+    // result of offer/tryClaim when the recording lags by more than the window, distinct from Aeron's codes
+    static constexpr std::int64_t RECORDING_BACK_PRESSURED = -6;
+
+    RecordedPublication(const std::shared_ptr<AeronArchive>& archive, const std::string& channel,
+                        std::int32_t streamId, std::int64_t maxRecordingLag);
+
+    RecordedPublication(const RecordedPublication&) = delete;
+    RecordedPublication& operator=(const RecordedPublication&) = delete;
+
+    std::int64_t offer(const aeron::concurrent::AtomicBuffer& buffer, aeron::util::index_t offset,
+                       aeron::util::index_t length);
+    std::int64_t offer(const aeron::concurrent::AtomicBuffer& buffer);
+    std::int64_t tryClaim(aeron::util::index_t length, aeron::concurrent::logbuffer::BufferClaim& bufferClaim);
+
+    std::int64_t position() const;
+    std::int64_t recordedPosition();
+    std::int64_t maxRecordingLag() const;
+    bool isRecording() const;
+
+    const std::shared_ptr<aeron::ExclusivePublication>& publication() const;
+    RecordingAckTracker& ackTracker();
+
+private:
+    bool isRecordingLagging();
+
+private:
+    const std::int64_t maxRecordingLag_;
+    std::shared_ptr<aeron::ExclusivePublication> publication_;
+    RecordingAckTracker ackTracker_;
+    std::int64_t cachedRecordedPosition_{0};
+};
+
+}  // namespace archive
+}  // namespace aeron
@@ -0,0 +1,189 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "ArchiveException.h"
+#include "RecordingAckTracker.h"
+#include "RecordingPos.h"
+
+namespace {
+
+const std::int64_t NULL_POSITION = -1;
+
+using Clock = std::chrono::high_resolution_clock;
+
+}  // namespace
+
+namespace aeron {
+namespace archive {
+
+bool RecordingAckTracker::WaiterAfter::operator()(const Waiter& lhs, const Waiter& rhs) const {
+    return lhs.position > rhs.position || (lhs.position == rhs.position && lhs.sequence > rhs.sequence);
+}
+
+RecordingAckTracker::RecordingAckTracker(const std::shared_ptr<AeronArchive>& archive, std::int32_t sessionId)
+    : archive_(archive)
+    , aeron_(archive->context().aeron())
+    , messageTimeoutNs_(archive->context().messageTimeoutNs()) {
+    auto& countersReader = aeron_->countersReader();
+
+    const auto deadline = Clock::now() + messageTimeoutNs_;
+    concurrent::YieldingIdleStrategy idleStrategy;
+
+    while ((counterId_ = RecordingPos::findCounterIdBySession(countersReader, sessionId)) < 0) {
+        if (Clock::now() > deadline) {
+            throw ArchiveException("no recording found for sessionId=" + std::to_string(sessionId), SOURCEINFO);
+        }
+
+        idleStrategy.idle();
+    }
+
+    recordingId_ = RecordingPos::getRecordingId(countersReader, counterId_);
+}
+
+bool RecordingAckTracker::awaitRecorded(std::int64_t position, std::chrono::nanoseconds timeout) {
+    const auto deadline = Clock::now() + timeout;
+    concurrent::YieldingIdleStrategy idleStrategy;
+
+    std::int64_t recordedPosition;
+    while (true) {
+        const bool isActive = readRecordedPosition(recordedPosition);
+        if (recordedPosition >= position) {
+            return true;
+        }
+
+        if (!isActive) {
+            throw ArchiveException("recordingId=" + std::to_string(recordingId_) + " stopped at " +
+                                       std::to_string(recordedPosition) + " before position " +
+                                       std::to_string(position),
+                                   SOURCEINFO);
+        }
+
+        if (Clock::now() > deadline) {
+            return false;
+        }
+
+        idleStrategy.idle();
+    }
+}
+
+void RecordingAckTracker::onRecorded(std::int64_t position, OnRecorded&& callback) {
+    std::unique_lock<std::mutex> lock(lock_);
+
+    waiters_.push_back(Waiter{position, nextSequence_++, std::move(callback)});
+    std::push_heap(waiters_.begin(), waiters_.end(), WaiterAfter());
+}
+
+std::int32_t RecordingAckTracker::poll() {
+    std::vector<Waiter> due;
+    std::int64_t recordedPosition;
+    bool isActive;
+
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+        if (waiters_.empty()) {
+            return 0;
+        }
+
+        // a single counter read releases the whole group of waiters below it
+        isActive = readRecordedPosition(recordedPosition);
+
+        while (!waiters_.empty() && (!isActive || waiters_.front().position <= recordedPosition)) {
+            std::pop_heap(waiters_.begin(), waiters_.end(), WaiterAfter());
+            due.push_back(std::move(waiters_.back()));
+            waiters_.pop_back();
+        }
+    }
+
+    for (auto& waiter : due) {
+        waiter.callback(waiter.position, waiter.position <= recordedPosition);
+    }
+
+    return static_cast<std::int32_t>(due.size());
+}
+
+std::int64_t RecordingAckTracker::recordingId() const { return recordingId_; }
+
+std::int32_t RecordingAckTracker::counterId() const { return counterId_; }
+
+std::int64_t RecordingAckTracker::recordedPosition() {
+    std::int64_t position;
+    readRecordedPosition(position);
+    return position;
+}
+
+std::int64_t RecordingAckTracker::stopPosition() const { return stopPosition_.load(std::memory_order_acquire); }
+
+std::int32_t RecordingAckTracker::pendingCount() {
+    std::unique_lock<std::mutex> lock(lock_);
+    return static_cast<std::int32_t>(waiters_.size());
+}
+
+bool RecordingAckTracker::readCounter(std::int64_t& position) {
+    const std::int64_t knownStopPosition = stopPosition_.load(std::memory_order_acquire);
+    if (knownStopPosition != NULL_POSITION) {
+        position = knownStopPosition;
+        return false;
+    }
+
+    auto& countersReader = aeron_->countersReader();
+
+    // the value is read before the check so it belongs to this recording if the counter is still active
+    const std::int64_t value = countersReader.getCounterValue(counterId_);
+    if (RecordingPos::isActive(countersReader, counterId_, recordingId_)) {
+        lastRecordedPosition_.store(value, std::memory_order_relaxed);
+        position = value;
+        return true;
+    }
+
+    position = lastRecordedPosition_.load(std::memory_order_relaxed);
+    return false;
+}
+
+bool RecordingAckTracker::readRecordedPosition(std::int64_t& position) {
+    if (readCounter(position)) {
+        return true;
+    }
+
+    if (stopPosition_.load(std::memory_order_acquire) != NULL_POSITION) {
+        return false;
+    }
+
+    // the control round trip is made at most once per message timeout, by the one thread claiming it
+    const std::int64_t nowNs =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    std::int64_t nextQueryNs = nextStopPositionQueryNs_.load(std::memory_order_relaxed);
+    if (nowNs < nextQueryNs || !nextStopPositionQueryNs_.compare_exchange_strong(
+                                   nextQueryNs, nowNs + messageTimeoutNs_.count(), std::memory_order_relaxed)) {
+        position = lastRecordedPosition_.load(std::memory_order_relaxed);
+        return true;
+    }
+
+    const std::int64_t stopPosition = archive_->getStopPosition(recordingId_);
+    if (stopPosition == NULL_POSITION) {
+        // the catalog has not caught up with the counter being freed yet
+        position = lastRecordedPosition_.load(std::memory_order_relaxed);
+        return true;
+    }
+
+    stopPosition_.store(stopPosition, std::memory_order_release);
+    position = stopPosition;
+    return false;
+}
+
+}  // namespace archive
+}  // namespace aeron
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include <Aeron.h>
+
+#include "AeronArchive.h"
+
+namespace aeron {
+namespace archive {
+
+// Tells when positions of a recorded publication are durably recorded by following the RecordingPos counter
+// of the recording of its session. Waiters are kept in a min-heap by position and poll() reads the counter once
+// to release every waiter at or below it. A waiter still pending when the recording stops short of its position
+// is released with isRecorded false. Waiters may be added and awaited from any thread.
+class RecordingAckTracker {
+public:
+    using OnRecorded = std::function<void(std::int64_t position, bool isRecorded)>;
+
+    // waits up to the message timeout for the recording of the session to start
+    RecordingAckTracker(const std::shared_ptr<AeronArchive>& archive, std::int32_t sessionId);
+
+    RecordingAckTracker(const RecordingAckTracker&) = delete;
+    RecordingAckTracker& operator=(const RecordingAckTracker&) = delete;
+
+    // returns false if the position is not recorded within the timeout, throws if the recording stops before it
+    bool awaitRecorded(std::int64_t position, std::chrono::nanoseconds timeout);
+
+    void onRecorded(std::int64_t position, OnRecorded&& callback);
+
+    // releases due waiters, returns the number released
+    std::int32_t poll();
+
+    std::int64_t recordingId() const;
+    std::int32_t counterId() const;
+    std::int64_t recordedPosition();
+    // reads only the counter and never queries the archive, returns false once the recording is no longer active
+    // with the last position seen or the stop position if already known
+    bool readCounter(std::int64_t& position);
+    // NULL_POSITION (-1) while the recording is active
+    std::int64_t stopPosition() const;
+    std::int32_t pendingCount();
+
+private:
+    struct Waiter {
+        std::int64_t position;
+        std::int64_t sequence;
+        OnRecorded callback;
+    };
+
+    struct WaiterAfter {
+        bool operator()(const Waiter& lhs, const Waiter& rhs) const;
+    };
+
+    // returns false once the recording is no longer active
+    bool readRecordedPosition(std::int64_t& position);
+
+private:
+    std::shared_ptr<AeronArchive> archive_;
+    std::shared_ptr<aeron::Aeron> aeron_;
+    const std::chrono::nanoseconds messageTimeoutNs_;
+    std::int32_t counterId_{-1};
+    std::int64_t recordingId_{-1};
+    std::atomic<std::int64_t> lastRecordedPosition_{0};
+    std::atomic<std::int64_t> stopPosition_{-1};
+    // clock time in ns before which the archive is not asked for the stop position again
+    std::atomic<std::int64_t> nextStopPositionQueryNs_{0};
+
+    std::mutex lock_;
+    std::vector<Waiter> waiters_;
+    std::int64_t nextSequence_{0};
+};
+
+}  // namespace archive
+}  // namespace aeron
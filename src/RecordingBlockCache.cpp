@@ -0,0 +1,391 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include "ArchiveException.h"
+#include "RecordingBlockCache.h"
+
+namespace {
+
+constexpr std::int32_t FRAME_ALIGNMENT = 32;
+// the longest message of a publication is an eighth of its term
+constexpr std::int32_t MAX_MESSAGE_TERM_FRACTION = 8;
+constexpr std::int64_t NULL_POSITION = -1;
+
+bool isPowerOfTwo(std::int32_t value) { return value > 0 && (value & (value - 1)) == 0; }
+
+std::int32_t validateBlockLength(std::int32_t blockLength) {
+    if (!isPowerOfTwo(blockLength) || blockLength < FRAME_ALIGNMENT) {
+        throw aeron::util::IllegalArgumentException("block length must be a power of two: " +
+                                                        std::to_string(blockLength),
+                                                    SOURCEINFO);
+    }
+
+    return blockLength;
+}
+
+// the arena is addressed by index_t offsets, it has to stay below 2 GiB
+std::int32_t validateSetCount(std::int32_t slotLength, std::int32_t blockCount, std::int32_t ways) {
+    const std::int64_t setCount = std::max<std::int64_t>(1, (static_cast<std::int64_t>(blockCount) + ways - 1) / ways);
+
+    if (setCount * ways * slotLength > std::numeric_limits<aeron::util::index_t>::max()) {
+        throw aeron::util::IllegalArgumentException("cache of " + std::to_string(blockCount) + " blocks of " +
+                                                        std::to_string(slotLength) + " bytes exceeds 2 GiB",
+                                                    SOURCEINFO);
+    }
+
+    return static_cast<std::int32_t>(setCount);
+}
+
+aeron::archive::RecordingBlockCache::Source archiveSource(const std::shared_ptr<aeron::archive::AeronArchive>& archive,
+                                                          aeron::archive::ReplaySessionPool& replayPool) {
+    using aeron::archive::RecordingBlockCache;
+
+    RecordingBlockCache::Source source;
+
+    source.recordingBounds = [archive](std::int64_t recordingId) {
+        RecordingBlockCache::RecordingBounds bounds{NULL_POSITION, NULL_POSITION, 0};
+        std::int32_t count = archive->listRecording(
+            recordingId,
+            [&](std::int64_t controlSessionId, std::int64_t correlationId, std::int64_t recordingId,
+                std::int64_t startTimestamp, std::int64_t stopTimestamp, std::int64_t startPosition,
+                std::int64_t stopPosition, std::int32_t initialTermId, std::int32_t segmentFileLength,
+                std::int32_t termBufferLength, std::int32_t mtuLength, std::int32_t sessionId, std::int32_t streamId,
+                const std::string& strippedChannel, const std::string& originalChannel,
+                const std::string& sourceIdentity) {
+                bounds = RecordingBlockCache::RecordingBounds{startPosition, stopPosition, termBufferLength};
+            });
+
+        if (count == 0) {
+            throw aeron::archive::ArchiveException("unknown recordingId=" + std::to_string(recordingId), SOURCEINFO);
+        }
+
+        return bounds;
+    };
+
+    source.recordingPosition = [archive](std::int64_t recordingId) {
+        return archive->getRecordingPosition(recordingId);
+    };
+
+    source.replayInto = [&replayPool](std::int64_t recordingId, std::int64_t position, std::int64_t length,
+                                      std::int64_t stopPosition, aeron::archive::ReplayBuffer& buffer) {
+        replayPool.replayInto(recordingId, position, length, stopPosition, buffer);
+    };
+
+    return source;
+}
+
+}  // namespace
+
+namespace aeron {
+namespace archive {
+
+constexpr std::int32_t RecordingBlockCache::WAYS;
+
+RecordingBlockCache::RecordingBlockCache(const std::shared_ptr<AeronArchive>& archive, ReplaySessionPool& replayPool,
+                                         std::int32_t blockLength, std::int32_t blockCount)
+    : RecordingBlockCache(archiveSource(archive, replayPool), blockLength, blockCount) {}
+
+RecordingBlockCache::RecordingBlockCache(Source&& source, std::int32_t blockLength, std::int32_t blockCount)
+    : source_(std::move(source))
+    , blockLength_(validateBlockLength(blockLength))
+    , slotLength_(blockLength_ + blockLength_ / MAX_MESSAGE_TERM_FRACTION)
+    , maxMessagesPerBlock_(slotLength_ / FRAME_ALIGNMENT)
+    , setCount_(validateSetCount(slotLength_, blockCount, WAYS))
+    , slots_(new SlotMetadata[setCount_ * WAYS])
+    , data_(static_cast<std::size_t>(setCount_) * WAYS * slotLength_)
+    , messages_(static_cast<std::size_t>(setCount_) * WAYS * maxMessagesPerBlock_)
+    , dataBuffer_(&data_[0], static_cast<util::index_t>(data_.size()))
+    , clockHands_(setCount_, 0)
+    , fillBytes_(slotLength_)
+    , fillBuffer_(&fillBytes_[0], slotLength_, maxMessagesPerBlock_) {}
+
+bool RecordingBlockCache::read(std::int64_t recordingId, std::int64_t position, std::int64_t length,
+                               ReplayBuffer& buffer) {
+    const std::int64_t end = position + length;
+    const std::int64_t firstBlockPosition = position & ~static_cast<std::int64_t>(blockLength_ - 1);
+    std::int64_t leadingPosition = NULL_POSITION;
+
+    if (firstBlockPosition > 0 && length > 0) {
+        // a message ending in the range may have begun in the block before, it ends where the first message
+        // beginning in the first block begins
+        readBlock(recordingId, firstBlockPosition, position, position, buffer, leadingPosition);
+
+        if (leadingPosition > position) {
+            std::int64_t previousLeadingPosition;
+            if (readBlock(recordingId, firstBlockPosition - blockLength_, position, end, buffer,
+                          previousLeadingPosition) == ReadResult::FULL) {
+                return false;
+            }
+        }
+    }
+
+    for (std::int64_t blockPosition = firstBlockPosition; blockPosition < end; blockPosition += blockLength_) {
+        if (readBlock(recordingId, blockPosition, position, end, buffer, leadingPosition) == ReadResult::FULL) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void RecordingBlockCache::invalidate(std::int64_t recordingId) {
+    std::unique_lock<std::mutex> lock(fillLock_);
+
+    boundsByRecordingId_.erase(recordingId);
+
+    for (std::int32_t slot = 0, size = setCount_ * WAYS; slot < size; ++slot) {
+        if (slots_[slot].recordingId.load(std::memory_order_relaxed) == recordingId) {
+            storeSlot(slot, -1, -1, NULL_POSITION);
+        }
+    }
+}
+
+std::int32_t RecordingBlockCache::blockLength() const { return blockLength_; }
+
+std::int32_t RecordingBlockCache::blockCount() const { return setCount_ * WAYS; }
+
+std::int64_t RecordingBlockCache::hits() const { return hits_.load(std::memory_order_relaxed); }
+
+std::int64_t RecordingBlockCache::misses() const { return misses_.load(std::memory_order_relaxed); }
+
+std::int64_t RecordingBlockCache::evictions() const { return evictions_.load(std::memory_order_relaxed); }
+
+RecordingBlockCache::ReadResult RecordingBlockCache::readBlock(std::int64_t recordingId, std::int64_t blockPosition,
+                                                               std::int64_t from, std::int64_t to,
+                                                               ReplayBuffer& buffer, std::int64_t& leadingPosition) {
+    ReadResult result = readCached(recordingId, blockPosition, from, to, buffer, leadingPosition);
+
+    if (result == ReadResult::MISS) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        result = readFilled(recordingId, blockPosition, from, to, buffer, leadingPosition);
+    } else {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return result;
+}
+
+RecordingBlockCache::ReadResult RecordingBlockCache::readCached(std::int64_t recordingId, std::int64_t blockPosition,
+                                                                std::int64_t from, std::int64_t to,
+                                                                ReplayBuffer& buffer, std::int64_t& leadingPosition) {
+    const std::int32_t slot = findSlot(recordingId, blockPosition);
+    if (slot < 0) {
+        return ReadResult::MISS;
+    }
+
+    SlotMetadata& metadata = slots_[slot];
+    const util::index_t initialLimit = buffer.limit();
+    const std::size_t initialMessageCount = buffer.messages().size();
+
+    const std::int64_t version = metadata.version.load(std::memory_order_acquire);
+    if ((version & 1) != 0 || metadata.recordingId.load(std::memory_order_relaxed) != recordingId ||
+        metadata.blockPosition.load(std::memory_order_relaxed) != blockPosition) {
+        return ReadResult::MISS;
+    }
+
+    const std::int32_t dataLength = metadata.dataLength.load(std::memory_order_relaxed);
+    const std::int32_t messageCount = metadata.messageCount.load(std::memory_order_relaxed);
+    const std::int64_t slotLeadingPosition = metadata.leadingPosition.load(std::memory_order_relaxed);
+
+    bool isComplete = dataLength <= slotLength_ && messageCount <= maxMessagesPerBlock_ &&
+                      copyMessages(dataBuffer_, slot * slotLength_, &messages_[slot * maxMessagesPerBlock_],
+                                   messageCount, dataLength, from, to, buffer);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (metadata.version.load(std::memory_order_relaxed) != version) {
+        // overwritten while copying
+        buffer.truncate(initialLimit, initialMessageCount);
+        return ReadResult::MISS;
+    }
+
+    metadata.isReferenced.store(true, std::memory_order_relaxed);
+    leadingPosition = slotLeadingPosition;
+
+    return isComplete ? ReadResult::HIT : ReadResult::FULL;
+}
+
+RecordingBlockCache::ReadResult RecordingBlockCache::readFilled(std::int64_t recordingId, std::int64_t blockPosition,
+                                                                std::int64_t from, std::int64_t to,
+                                                                ReplayBuffer& buffer, std::int64_t& leadingPosition) {
+    std::unique_lock<std::mutex> lock(fillLock_);
+
+    // the block could have been filled while waiting for the lock
+    ReadResult result = readCached(recordingId, blockPosition, from, to, buffer, leadingPosition);
+    if (result != ReadResult::MISS) {
+        return result;
+    }
+
+    RecordingBounds bounds = recordingBounds(recordingId);
+    if (blockLength_ % bounds.termBufferLength != 0) {
+        throw ArchiveException("block length " + std::to_string(blockLength_) +
+                                   " is not a multiple of term length " + std::to_string(bounds.termBufferLength) +
+                                   " of recordingId=" + std::to_string(recordingId),
+                               SOURCEINFO);
+    }
+
+    std::int64_t limit = bounds.stopPosition;
+    if (limit == NULL_POSITION) {
+        limit = source_.recordingPosition(recordingId);
+    }
+
+    const std::int64_t blockEnd = blockPosition + blockLength_;
+    const std::int64_t replayFrom = std::max(blockPosition, bounds.startPosition);
+    // the replay runs past the block end until the message crossing it is complete
+    const std::int64_t replayTo = std::min(blockEnd + bounds.termBufferLength, limit);
+
+    fillBuffer_.reset();
+    if (replayFrom < blockEnd && replayTo > replayFrom) {
+        source_.replayInto(recordingId, replayFrom, replayTo - replayFrom, blockEnd, fillBuffer_);
+    }
+
+    // the tail of a message begun in the block before was dropped
+    leadingPosition = fillBuffer_.skippedPosition() != NULL_POSITION ? fillBuffer_.skippedPosition() : replayFrom;
+
+    const auto& messages = fillBuffer_.messages();
+
+    // a block still being recorded is served but not kept
+    if (bounds.stopPosition != NULL_POSITION || (!messages.empty() && messages.back().position >= blockEnd)) {
+        const std::int32_t set = setIndex(recordingId, blockPosition);
+        const std::int32_t slot = evictSlot(set);
+
+        storeSlot(slot, recordingId, blockPosition, leadingPosition);
+    }
+
+    return copyMessages(fillBuffer_.buffer(), 0, messages.data(), static_cast<std::int32_t>(messages.size()),
+                        fillBuffer_.limit(), from, to, buffer)
+               ? ReadResult::HIT
+               : ReadResult::FULL;
+}
+
+std::int32_t RecordingBlockCache::setIndex(std::int64_t recordingId, std::int64_t blockPosition) const {
+    std::uint64_t hash = static_cast<std::uint64_t>(recordingId) * 0x9E3779B97F4A7C15ULL;
+    hash ^= static_cast<std::uint64_t>(blockPosition / blockLength_) + 0x7F4A7C159E3779B9ULL + (hash << 6) + (hash >> 2);
+
+    return static_cast<std::int32_t>(hash % static_cast<std::uint64_t>(setCount_));
+}
+
+std::int32_t RecordingBlockCache::findSlot(std::int64_t recordingId, std::int64_t blockPosition) const {
+    const std::int32_t first = setIndex(recordingId, blockPosition) * WAYS;
+
+    for (std::int32_t slot = first; slot < first + WAYS; ++slot) {
+        if (slots_[slot].blockPosition.load(std::memory_order_relaxed) == blockPosition &&
+            slots_[slot].recordingId.load(std::memory_order_relaxed) == recordingId) {
+            return slot;
+        }
+    }
+
+    return -1;
+}
+
+std::int32_t RecordingBlockCache::evictSlot(std::int32_t set) {
+    const std::int32_t first = set * WAYS;
+    std::int32_t& hand = clockHands_[set];
+
+    while (true) {
+        const std::int32_t slot = first + hand;
+        hand = (hand + 1) % WAYS;
+
+        SlotMetadata& metadata = slots_[slot];
+        if (metadata.recordingId.load(std::memory_order_relaxed) == -1) {
+            return slot;
+        }
+
+        if (!metadata.isReferenced.exchange(false, std::memory_order_relaxed)) {
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+            return slot;
+        }
+    }
+}
+
+void RecordingBlockCache::storeSlot(std::int32_t slot, std::int64_t recordingId, std::int64_t blockPosition,
+                                    std::int64_t leadingPosition) {
+    SlotMetadata& metadata = slots_[slot];
+    const std::int64_t version = metadata.version.load(std::memory_order_relaxed);
+
+    metadata.version.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    metadata.recordingId.store(recordingId, std::memory_order_relaxed);
+    metadata.blockPosition.store(blockPosition, std::memory_order_relaxed);
+    metadata.leadingPosition.store(leadingPosition, std::memory_order_relaxed);
+    metadata.isReferenced.store(false, std::memory_order_relaxed);
+
+    if (recordingId != -1) {
+        const auto& messages = fillBuffer_.messages();
+
+        dataBuffer_.putBytes(slot * slotLength_, fillBuffer_.buffer(), 0, fillBuffer_.limit());
+        std::copy(messages.begin(), messages.end(), messages_.begin() + slot * maxMessagesPerBlock_);
+
+        metadata.dataLength.store(fillBuffer_.limit(), std::memory_order_relaxed);
+        metadata.messageCount.store(static_cast<std::int32_t>(messages.size()), std::memory_order_relaxed);
+    } else {
+        metadata.dataLength.store(0, std::memory_order_relaxed);
+        metadata.messageCount.store(0, std::memory_order_relaxed);
+    }
+
+    metadata.version.store(version + 2, std::memory_order_release);
+}
+
+RecordingBlockCache::RecordingBounds RecordingBlockCache::recordingBounds(std::int64_t recordingId) {
+    auto it = boundsByRecordingId_.find(recordingId);
+    if (it != boundsByRecordingId_.end()) {
+        return it->second;
+    }
+
+    RecordingBounds bounds = source_.recordingBounds(recordingId);
+
+    // the stop position of an active recording has to be queried again on every fill
+    if (bounds.stopPosition != NULL_POSITION) {
+        boundsByRecordingId_.emplace(recordingId, bounds);
+    }
+
+    return bounds;
+}
+
+bool RecordingBlockCache::copyMessages(const concurrent::AtomicBuffer& src, util::index_t baseOffset,
+                                       const MessageBoundary* messages, std::int32_t messageCount,
+                                       std::int32_t dataLength, std::int64_t from, std::int64_t to,
+                                       ReplayBuffer& buffer) {
+    for (std::int32_t i = 0; i < messageCount; ++i) {
+        const MessageBoundary message = messages[i];
+
+        if (message.position <= from) {
+            continue;
+        }
+
+        if (message.position > to) {
+            break;
+        }
+
+        // a slot being overwritten may hand out a torn boundary, it is discarded by the version check
+        if (message.offset < 0 || message.length < 0 || message.offset + message.length > dataLength) {
+            return true;
+        }
+
+        if (!buffer.append(src, baseOffset + message.offset, message.length) || !buffer.commit(message.position)) {
+            buffer.abort();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}  // namespace archive
+}  // namespace aeron
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "AeronArchive.h"
+#include "ReplayBuffer.h"
+#include "ReplaySessionPool.h"
+
+namespace aeron {
+namespace archive {
+
+// Read-through cache of recorded blocks keyed by (recordingId, block position). Blocks are aligned to a multiple
+// of the recording term length so they always start on a frame boundary. A block holds the messages which begin
+// within it, a message crossing the block end is kept whole in the block it began in and dropped from the next one.
+// Each slot has room for such a message, at most an eighth of a term long. The cache is a fixed arena organised
+// as a set-associative table with CLOCK eviction within a set. Lookups are lock-free (each slot is guarded by
+// a sequence lock), misses are filled one at a time by bounded replays.
+class RecordingBlockCache {
+public:
+    static constexpr std::int32_t WAYS = 8;
+
+    // the stop position is -1 while the recording is active
+    struct RecordingBounds {
+        std::int64_t startPosition;
+        std::int64_t stopPosition;
+        std::int32_t termBufferLength;
+    };
+
+    // what blocks are filled from, the archive and bounded replays of the pool unless given
+    struct Source {
+        std::function<RecordingBounds(std::int64_t recordingId)> recordingBounds;
+        std::function<std::int64_t(std::int64_t recordingId)> recordingPosition;
+        // ends with the first message ending at or after the stop position
+        std::function<void(std::int64_t recordingId, std::int64_t position, std::int64_t length,
+                           std::int64_t stopPosition, ReplayBuffer& buffer)>
+            replayInto;
+    };
+
+    RecordingBlockCache(const std::shared_ptr<AeronArchive>& archive, ReplaySessionPool& replayPool,
+                        std::int32_t blockLength, std::int32_t blockCount);
+    RecordingBlockCache(Source&& source, std::int32_t blockLength, std::int32_t blockCount);
+
+    RecordingBlockCache(const RecordingBlockCache&) = delete;
+    RecordingBlockCache& operator=(const RecordingBlockCache&) = delete;
+
+    // appends messages whose frames end within (position, position + length] to the buffer,
+    // returns false if the buffer ran out of space
+    bool read(std::int64_t recordingId, std::int64_t position, std::int64_t length, ReplayBuffer& buffer);
+
+    void invalidate(std::int64_t recordingId);
+
+    std::int32_t blockLength() const;
+    std::int32_t blockCount() const;
+    std::int64_t hits() const;
+    std::int64_t misses() const;
+    std::int64_t evictions() const;
+
+private:
+    struct alignas(64) SlotMetadata {
+        std::atomic<std::int64_t> version{0};
+        std::atomic<std::int64_t> recordingId{-1};
+        std::atomic<std::int64_t> blockPosition{-1};
+        // where the first message beginning in the block begins, past the tail of one begun in the block before
+        std::atomic<std::int64_t> leadingPosition{-1};
+        std::atomic<std::int32_t> dataLength{0};
+        std::atomic<std::int32_t> messageCount{0};
+        std::atomic<bool> isReferenced{false};
+    };
+
+    enum class ReadResult { MISS, HIT, FULL };
+
+    ReadResult readBlock(std::int64_t recordingId, std::int64_t blockPosition, std::int64_t from, std::int64_t to,
+                         ReplayBuffer& buffer, std::int64_t& leadingPosition);
+    ReadResult readCached(std::int64_t recordingId, std::int64_t blockPosition, std::int64_t from, std::int64_t to,
+                          ReplayBuffer& buffer, std::int64_t& leadingPosition);
+    ReadResult readFilled(std::int64_t recordingId, std::int64_t blockPosition, std::int64_t from, std::int64_t to,
+                          ReplayBuffer& buffer, std::int64_t& leadingPosition);
+
+    std::int32_t setIndex(std::int64_t recordingId, std::int64_t blockPosition) const;
+    std::int32_t findSlot(std::int64_t recordingId, std::int64_t blockPosition) const;
+    std::int32_t evictSlot(std::int32_t set);
+    void storeSlot(std::int32_t slot, std::int64_t recordingId, std::int64_t blockPosition,
+                   std::int64_t leadingPosition);
+    RecordingBounds recordingBounds(std::int64_t recordingId);
+
+    static bool copyMessages(const aeron::concurrent::AtomicBuffer& src, aeron::util::index_t baseOffset,
+                             const MessageBoundary* messages, std::int32_t messageCount, std::int32_t dataLength,
+                             std::int64_t from, std::int64_t to, ReplayBuffer& buffer);
+
+private:
+    Source source_;
+    const std::int32_t blockLength_;
+    const std::int32_t slotLength_;
+    const std::int32_t maxMessagesPerBlock_;
+    const std::int32_t setCount_;
+
+    std::unique_ptr<SlotMetadata[]> slots_;
+    std::vector<std::uint8_t> data_;
+    std::vector<MessageBoundary> messages_;
+    aeron::concurrent::AtomicBuffer dataBuffer_;
+
+    std::atomic<std::int64_t> hits_{0};
+    std::atomic<std::int64_t> misses_{0};
+    std::atomic<std::int64_t> evictions_{0};
+
+    std::mutex fillLock_;
+    std::vector<std::int32_t> clockHands_;
+    std::vector<std::uint8_t> fillBytes_;
+    ReplayBuffer fillBuffer_;
+    std::unordered_map<std::int64_t, RecordingBounds> boundsByRecordingId_;
+};
+
+}  // namespace archive
+}  // namespace aeron
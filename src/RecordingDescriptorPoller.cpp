@@ -18,6 +18,7 @@
 #include "io_aeron_archive_codecs/RecordingDescriptor.h"
 
 #include "ArchiveException.h"
+#include "EventLog.h"
 #include "RecordingDescriptorPoller.h"
 
 namespace codecs = io::aeron::archive::codecs;
@@ -89,6 +90,9 @@ ControlledPollAction RecordingDescriptorPoller::onFragment(concurrent::AtomicBuf
                       msg.termBufferLength(), msg.mtuLength(), msg.sessionId(), msg.streamId(), msg.getStrippedChannelAsString(),
                       msg.getOriginalChannelAsString(), msg.getSourceIdentityAsString());
 
+            AERON_ARCHIVE_LOG_EVENT(EventCode::RECORDING_DESCRIPTOR, controlSessionId_, correlationId_,
+                                    msg.recordingId(), remainingRecordCount_ - 1, 0);
+
             if (--remainingRecordCount_ == 0) {
                 isDispatchComplete_ = true;
                 return ControlledPollAction::BREAK;
@@ -19,6 +19,7 @@
 #include "io_aeron_archive_codecs/RecordingStopped.h"
 
 #include "ArchiveException.h"
+#include "EventLog.h"
 #include "RecordingEventsAdapter.h"
 
 namespace codecs = io::aeron::archive::codecs;
@@ -52,6 +53,9 @@ void RecordingEventsAdapter::fragmentHandler(aeron::AtomicBuffer& buffer, aeron:
         msg.wrapForDecode((char*)buffer.buffer(), offset + hdr.encodedLength(), hdr.blockLength(), hdr.version(),
                           buffer.capacity());
 
+        AERON_ARCHIVE_LOG_EVENT(EventCode::RECORDING_STARTED, msg.recordingId(), msg.startPosition(), 0,
+                                msg.sessionId(), msg.streamId());
+
         onStart_(msg.recordingId(), msg.startPosition(), msg.sessionId(), msg.streamId(), msg.getChannelAsString(),
                  msg.getSourceIdentityAsString());
     } else if (templateId == codecs::RecordingProgress::sbeTemplateId()) {
@@ -59,12 +63,18 @@ void RecordingEventsAdapter::fragmentHandler(aeron::AtomicBuffer& buffer, aeron:
         msg.wrapForDecode((char*)buffer.buffer(), offset + hdr.encodedLength(), hdr.blockLength(), hdr.version(),
                           buffer.capacity());
 
+        AERON_ARCHIVE_LOG_EVENT(EventCode::RECORDING_PROGRESS, msg.recordingId(), msg.startPosition(),
+                                msg.position(), 0, 0);
+
         onProgress_(msg.recordingId(), msg.startPosition(), msg.position());
     } else if (templateId == codecs::RecordingStopped::sbeTemplateId()) {
         codecs::RecordingStopped msg;
         msg.wrapForDecode((char*)buffer.buffer(), offset + hdr.encodedLength(), hdr.blockLength(), hdr.version(),
                           buffer.capacity());
 
+        AERON_ARCHIVE_LOG_EVENT(EventCode::RECORDING_STOPPED, msg.recordingId(), msg.startPosition(),
+                                msg.stopPosition(), 0, 0);
+
         onStop_(msg.recordingId(), msg.startPosition(), msg.stopPosition());
     } else {
         throw ArchiveException("unknown template id: " + std::to_string(templateId), SOURCEINFO);
@@ -0,0 +1,249 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <thread>
+
+#include "ArchiveException.h"
+#include "ReplayBroker.h"
+
+namespace {
+
+const std::int32_t FRAGMENT_LIMIT = 10;
+
+}  // namespace
+
+namespace aeron {
+namespace archive {
+
+ReplayBroker::ReplayBroker(const std::shared_ptr<AeronArchive>& archive, const std::string& replayChannel,
+                           std::int32_t replayStreamId, const std::string& publicationChannel,
+                           std::int32_t firstPublicationStreamId, std::int32_t maxSharedReplays)
+    : archive_(archive)
+    , aeron_(archive->context().aeron())
+    , replayChannel_(replayChannel)
+    , replayStreamId_(replayStreamId)
+    , publicationChannel_(publicationChannel)
+    , multiplexer_(archive, replayChannel, replayStreamId, maxSharedReplays, FRAGMENT_LIMIT,
+                   [this](std::int64_t replayId, std::int64_t position) { onReplayComplete(replayId); },
+                   // shared replays are started by the broker and adopted, never queued
+                   nullptr) {
+    if (maxSharedReplays <= 0) {
+        throw util::IllegalArgumentException(
+            "max shared replays must be positive: " + std::to_string(maxSharedReplays), SOURCEINFO);
+    }
+
+    for (std::int32_t i = maxSharedReplays - 1; i >= 0; --i) {
+        freeStreamIds_.push_back(firstPublicationStreamId + i);
+    }
+}
+
+ReplayTicket ReplayBroker::request(std::int64_t recordingId, std::int64_t position, std::int64_t length) {
+    const std::int64_t stopPosition = replayStopPosition(position, length);
+    std::int32_t streamId;
+
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+
+        SharedReplay* replay = findJoinable(recordingId, position, stopPosition);
+        if (replay) {
+            ++coalescedCount_;
+            ++replay->refCount;
+            return ticketOf(*replay, position, stopPosition);
+        }
+
+        streamId = reserveStreamId(recordingId);
+        multiplexer_.expectAdoption();
+    }
+
+    try {
+        return startSharedReplay(recordingId, position, length, streamId);
+    } catch (...) {
+        std::unique_lock<std::mutex> lock(lock_);
+        multiplexer_.abandonAdoption();
+        freeStreamIds_.push_back(streamId);
+        throw;
+    }
+}
+
+void ReplayBroker::release(const ReplayTicket& ticket) {
+    std::int64_t replaySessionId;
+
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+
+        auto it = replaysById_.find(ticket.replayId);
+        if (it == replaysById_.end() || --it->second->refCount > 0) {
+            return;
+        }
+
+        if (!closeSharedReplay(ticket.replayId, replaySessionId)) {
+            return;
+        }
+    }
+
+    try {
+        archive_->stopReplay(replaySessionId);
+    } catch (const ArchiveException&) {
+        // the replay may have ended on the archive side already
+    }
+}
+
+std::int32_t ReplayBroker::poll() {
+    std::unique_lock<std::mutex> lock(lock_);
+    return multiplexer_.poll();
+}
+
+std::int32_t ReplayBroker::sharedReplayCount() {
+    std::unique_lock<std::mutex> lock(lock_);
+    return static_cast<std::int32_t>(replaysById_.size());
+}
+
+std::int64_t ReplayBroker::coalescedCount() {
+    std::unique_lock<std::mutex> lock(lock_);
+    return coalescedCount_;
+}
+
+ReplayBroker::SharedReplay* ReplayBroker::findJoinable(std::int64_t recordingId, std::int64_t position,
+                                                       std::int64_t stopPosition) {
+    for (auto& entry : replaysById_) {
+        SharedReplay& replay = *entry.second;
+
+        // a late joiner catches up on the prefix it missed with its own bounded replay
+        if (replay.recordingId == recordingId && !replay.isComplete && replay.startPosition <= position &&
+            replay.stopPosition >= stopPosition) {
+            return &replay;
+        }
+    }
+
+    return nullptr;
+}
+
+std::int32_t ReplayBroker::reserveStreamId(std::int64_t recordingId) {
+    if (freeStreamIds_.empty()) {
+        throw ArchiveException("no free publication stream id for a shared replay of recordingId=" +
+                                   std::to_string(recordingId),
+                               SOURCEINFO);
+    }
+
+    const std::int32_t streamId = freeStreamIds_.back();
+    freeStreamIds_.pop_back();
+
+    return streamId;
+}
+
+ReplayTicket ReplayBroker::startSharedReplay(std::int64_t recordingId, std::int64_t position, std::int64_t length,
+                                             std::int32_t streamId) {
+    const std::int64_t stopPosition = replayStopPosition(position, length);
+
+    const std::int64_t registrationId = aeron_->addExclusivePublication(publicationChannel_, streamId);
+    std::shared_ptr<ExclusivePublication> publication;
+    while (!(publication = aeron_->findExclusivePublication(registrationId))) {
+        std::this_thread::yield();
+    }
+
+    const std::int64_t replaySessionId =
+        archive_->startReplay(recordingId, position, length, replayChannel_, replayStreamId_);
+
+    std::unique_lock<std::mutex> lock(lock_);
+
+    // another request may have started a replay covering this one in the meantime
+    SharedReplay* joinable = findJoinable(recordingId, position, stopPosition);
+    if (joinable) {
+        ++coalescedCount_;
+        ++joinable->refCount;
+        multiplexer_.abandonAdoption();
+        freeStreamIds_.push_back(streamId);
+        ReplayTicket ticket = ticketOf(*joinable, position, stopPosition);
+        lock.unlock();
+
+        try {
+            archive_->stopReplay(replaySessionId);
+        } catch (const ArchiveException&) {
+            // the replay may have ended on the archive side already
+        }
+
+        return ticket;
+    }
+
+    auto replay = std::make_unique<SharedReplay>(
+        SharedReplay{-1, recordingId, position, stopPosition, streamId, std::move(publication), 1, false});
+    SharedReplay* sharedReplay = replay.get();
+
+    sharedReplay->replayId = multiplexer_.adopt(
+        replaySessionId, recordingId, position, length,
+        [this, sharedReplay](concurrent::AtomicBuffer& buffer, util::index_t offset, util::index_t length,
+                             Header& header) { return republish(*sharedReplay, buffer, offset, length, header); });
+
+    replaysById_.emplace(sharedReplay->replayId, std::move(replay));
+
+    return ticketOf(*sharedReplay, position, stopPosition);
+}
+
+ControlledPollAction ReplayBroker::republish(SharedReplay& replay, concurrent::AtomicBuffer& buffer,
+                                             util::index_t offset, util::index_t length, Header& header) {
+    // the header is the one of the last fragment so its position is the position after the message
+    const std::int64_t position = header.position();
+
+    const std::int64_t result = replay.publication->offer(
+        buffer, offset, length,
+        [position](concurrent::AtomicBuffer& termBuffer, util::index_t termOffset, util::index_t frameLength) {
+            return position;
+        });
+
+    if (result > 0) {
+        return ControlledPollAction::CONTINUE;
+    }
+
+    if (result == PUBLICATION_CLOSED || result == MAX_POSITION_EXCEEDED) {
+        throw ArchiveException("failed to republish replay of recordingId=" + std::to_string(replay.recordingId) +
+                                   ", result=" + std::to_string(result),
+                               SOURCEINFO);
+    }
+
+    // not connected yet or back pressured, the message is offered again on the next poll
+    return ControlledPollAction::ABORT;
+}
+
+void ReplayBroker::onReplayComplete(std::int64_t replayId) {
+    auto it = replaysById_.find(replayId);
+    if (it != replaysById_.end()) {
+        // the publication is kept until released so subscribers can drain it
+        it->second->isComplete = true;
+    }
+}
+
+bool ReplayBroker::closeSharedReplay(std::int64_t replayId, std::int64_t& replaySessionId) {
+    auto it = replaysById_.find(replayId);
+    if (it == replaysById_.end()) {
+        return false;
+    }
+
+    const bool isRunning = !it->second->isComplete && multiplexer_.detach(replayId, replaySessionId);
+
+    freeStreamIds_.push_back(it->second->streamId);
+    replaysById_.erase(it);
+
+    return isRunning;
+}
+
+ReplayTicket ReplayBroker::ticketOf(const SharedReplay& replay, std::int64_t position,
+                                    std::int64_t stopPosition) const {
+    return ReplayTicket{replay.replayId,   replay.recordingId, position, stopPosition, publicationChannel_,
+                        replay.streamId, replay.publication->sessionId()};
+}
+
+}  // namespace archive
+}  // namespace aeron
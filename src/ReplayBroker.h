@@ -0,0 +1,106 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <Aeron.h>
+
+#include "AeronArchive.h"
+#include "ReplayMultiplexer.h"
+
+namespace aeron {
+namespace archive {
+
+// Where a brokered replay is republished. Messages carry the recording position after the message
+// as the reserved value of their frames.
+struct ReplayTicket {
+    std::int64_t replayId;
+    std::int64_t recordingId;
+    std::int64_t position;
+    std::int64_t stopPosition;
+    std::string channel;
+    std::int32_t streamId;
+    std::int32_t sessionId;
+};
+
+// Coalesces concurrent replay requests of the same recording into one archive replay. A request which falls
+// within the range of a running shared replay joins it, otherwise a new shared replay is started and
+// republished on its own exclusive publication (typically IPC). The shared replay runs at the pace of its
+// slowest subscriber and is stopped once every ticket is released.
+// request/release may be called from any thread, poll is expected from a single broker thread.
+class ReplayBroker {
+public:
+    ReplayBroker(const std::shared_ptr<AeronArchive>& archive, const std::string& replayChannel,
+                 std::int32_t replayStreamId, const std::string& publicationChannel,
+                 std::int32_t firstPublicationStreamId, std::int32_t maxSharedReplays);
+
+    ReplayBroker(const ReplayBroker&) = delete;
+    ReplayBroker& operator=(const ReplayBroker&) = delete;
+
+    ReplayTicket request(std::int64_t recordingId, std::int64_t position, std::int64_t length);
+    void release(const ReplayTicket& ticket);
+
+    std::int32_t poll();
+
+    std::int32_t sharedReplayCount();
+    std::int64_t coalescedCount();
+
+private:
+    struct SharedReplay {
+        std::int64_t replayId;
+        std::int64_t recordingId;
+        std::int64_t startPosition;
+        std::int64_t stopPosition;
+        std::int32_t streamId;
+        std::shared_ptr<aeron::ExclusivePublication> publication;
+        std::int32_t refCount;
+        bool isComplete;
+    };
+
+    SharedReplay* findJoinable(std::int64_t recordingId, std::int64_t position, std::int64_t stopPosition);
+    std::int32_t reserveStreamId(std::int64_t recordingId);
+    // called without the lock held, the control round trip does not stall poll()
+    ReplayTicket startSharedReplay(std::int64_t recordingId, std::int64_t position, std::int64_t length,
+                                   std::int32_t streamId);
+    aeron::ControlledPollAction republish(SharedReplay& replay, aeron::concurrent::AtomicBuffer& buffer,
+                                          aeron::util::index_t offset, aeron::util::index_t length,
+                                          aeron::Header& header);
+    void onReplayComplete(std::int64_t replayId);
+    // called with the lock held, true when the replay still runs and has to be stopped once the lock is released
+    bool closeSharedReplay(std::int64_t replayId, std::int64_t& replaySessionId);
+    ReplayTicket ticketOf(const SharedReplay& replay, std::int64_t position, std::int64_t stopPosition) const;
+
+private:
+    std::shared_ptr<AeronArchive> archive_;
+    std::shared_ptr<aeron::Aeron> aeron_;
+    const std::string replayChannel_;
+    const std::int32_t replayStreamId_;
+    const std::string publicationChannel_;
+
+    std::mutex lock_;
+    ReplayMultiplexer multiplexer_;
+    std::unordered_map<std::int64_t, std::unique_ptr<SharedReplay>> replaysById_;
+    std::vector<std::int32_t> freeStreamIds_;
+    std::int64_t coalescedCount_{0};
+};
+
+}  // namespace archive
+}  // namespace aeron
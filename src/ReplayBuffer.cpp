@@ -0,0 +1,115 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <concurrent/logbuffer/FrameDescriptor.h>
+
+#include "ReplayBuffer.h"
+
+namespace aeron {
+namespace archive {
+
+ReplayBuffer::ReplayBuffer(std::uint8_t* buffer, util::index_t capacity, std::size_t maxMessages)
+    : buffer_(buffer, capacity)
+    , maxMessages_(maxMessages) {
+    messages_.reserve(maxMessages_);
+}
+
+void ReplayBuffer::reset() {
+    limit_ = 0;
+    messageOffset_ = 0;
+    isInMessage_ = false;
+    skippedPosition_ = -1;
+    messages_.clear();
+}
+
+void ReplayBuffer::truncate(util::index_t limit, std::size_t messageCount) {
+    limit_ = limit;
+    messageOffset_ = limit;
+    messages_.resize(messageCount);
+}
+
+bool ReplayBuffer::append(const concurrent::AtomicBuffer& src, util::index_t offset, util::index_t length) {
+    if (length > buffer_.capacity() - limit_) {
+        return false;
+    }
+
+    buffer_.putBytes(limit_, src, offset, length);
+    limit_ += length;
+
+    return true;
+}
+
+bool ReplayBuffer::commit(std::int64_t position) {
+    if (messages_.size() >= maxMessages_) {
+        abort();
+        return false;
+    }
+
+    messages_.push_back(MessageBoundary{messageOffset_, limit_ - messageOffset_, position});
+    messageOffset_ = limit_;
+
+    return true;
+}
+
+void ReplayBuffer::abort() {
+    limit_ = messageOffset_;
+    isInMessage_ = false;
+}
+
+bool ReplayBuffer::appendFragment(const concurrent::AtomicBuffer& src, util::index_t offset, util::index_t length,
+                                  std::uint8_t flags, std::int64_t position) {
+    if (flags & concurrent::logbuffer::FrameDescriptor::BEGIN_FRAG) {
+        // drop the leftover of a message which has not been completed
+        abort();
+        isInMessage_ = true;
+    } else if (!isInMessage_) {
+        if (limit_ == 0 && messages_.empty()) {
+            skippedPosition_ = position;
+        }
+        return true;
+    }
+
+    if (!append(src, offset, length)) {
+        abort();
+        return false;
+    }
+
+    if (flags & concurrent::logbuffer::FrameDescriptor::END_FRAG) {
+        isInMessage_ = false;
+        return commit(position);
+    }
+
+    return true;
+}
+
+bool ReplayBuffer::isInMessage() const { return isInMessage_; }
+
+std::int64_t ReplayBuffer::skippedPosition() const { return skippedPosition_; }
+
+concurrent::AtomicBuffer& ReplayBuffer::buffer() { return buffer_; }
+
+const concurrent::AtomicBuffer& ReplayBuffer::buffer() const { return buffer_; }
+
+util::index_t ReplayBuffer::capacity() const { return buffer_.capacity(); }
+
+util::index_t ReplayBuffer::limit() const { return limit_; }
+
+std::size_t ReplayBuffer::maxMessages() const { return maxMessages_; }
+
+const std::vector<MessageBoundary>& ReplayBuffer::messages() const { return messages_; }
+
+}  // namespace archive
+}  // namespace aeron
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <concurrent/AtomicBuffer.h>
+
+namespace aeron {
+namespace archive {
+
+// position is the recording position right after the last frame of the message
+struct MessageBoundary {
+    aeron::util::index_t offset;
+    aeron::util::index_t length;
+    std::int64_t position;
+};
+
+// Caller owned storage for replayed messages: payloads are laid out back to back in the buffer
+// and their boundaries are kept in a preallocated vector.
+class ReplayBuffer {
+public:
+    ReplayBuffer(std::uint8_t* buffer, aeron::util::index_t capacity, std::size_t maxMessages);
+
+    ReplayBuffer(const ReplayBuffer&) = delete;
+    ReplayBuffer& operator=(const ReplayBuffer&) = delete;
+
+    void reset();
+    void truncate(aeron::util::index_t limit, std::size_t messageCount);
+
+    // fragments of a message are appended one by one, the message becomes visible once committed
+    bool append(const aeron::concurrent::AtomicBuffer& src, aeron::util::index_t offset, aeron::util::index_t length);
+    bool commit(std::int64_t position);
+    void abort();
+
+    // appends a replayed fragment by its frame flags, committing the message on its last fragment. Fragments ahead
+    // of the first BEGIN_FRAG belong to a message which started before the replay and are dropped.
+    // false when the message does not fit, in which case it is aborted
+    bool appendFragment(const aeron::concurrent::AtomicBuffer& src, aeron::util::index_t offset,
+                        aeron::util::index_t length, std::uint8_t flags, std::int64_t position);
+    bool isInMessage() const;
+    // end position of the fragments dropped ahead of the first message, -1 when none were
+    std::int64_t skippedPosition() const;
+
+    aeron::concurrent::AtomicBuffer& buffer();
+    const aeron::concurrent::AtomicBuffer& buffer() const;
+    aeron::util::index_t capacity() const;
+    aeron::util::index_t limit() const;
+    std::size_t maxMessages() const;
+    const std::vector<MessageBoundary>& messages() const;
+
+private:
+    aeron::concurrent::AtomicBuffer buffer_;
+    std::size_t maxMessages_;
+    aeron::util::index_t limit_{0};
+    aeron::util::index_t messageOffset_{0};
+    bool isInMessage_{false};
+    std::int64_t skippedPosition_{-1};
+    std::vector<MessageBoundary> messages_;
+};
+
+}  // namespace archive
+}  // namespace aeron
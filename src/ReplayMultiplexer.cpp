@@ -0,0 +1,282 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <thread>
+
+#include "ArchiveException.h"
+#include "ReplayMultiplexer.h"
+
+namespace {
+
+const std::int64_t NULL_LENGTH = -1;
+
+std::int64_t stopPositionOf(std::int64_t position, std::int64_t length) {
+    if (length == NULL_LENGTH || length >= std::numeric_limits<std::int64_t>::max() - position) {
+        return std::numeric_limits<std::int64_t>::max();
+    }
+
+    return position + length;
+}
+
+}  // namespace
+
+namespace aeron {
+namespace archive {
+
+ReplayMultiplexer::ReplayMultiplexer(const std::shared_ptr<AeronArchive>& archive, const std::string& replayChannel,
+                                     std::int32_t replayStreamId, std::int32_t maxActiveReplays,
+                                     std::int32_t fragmentLimit, OnReplayComplete&& onComplete,
+                                     OnReplayFailed&& onFailed)
+    : archive_(archive)
+    , replayChannel_(replayChannel)
+    , replayStreamId_(replayStreamId)
+    , maxActiveReplays_(maxActiveReplays)
+    , fragmentLimit_(fragmentLimit)
+    , onComplete_(std::move(onComplete))
+    , onFailed_(std::move(onFailed))
+    , fragmentAssembler_([this](concurrent::AtomicBuffer& buffer, util::index_t offset, util::index_t length,
+                                Header& header) { return onFragment(buffer, offset, length, header); }) {
+    if (maxActiveReplays_ <= 0) {
+        throw util::IllegalArgumentException(
+            "max active replays must be positive: " + std::to_string(maxActiveReplays_), SOURCEINFO);
+    }
+
+    auto aeron = archive_->context().aeron();
+
+    std::int64_t subId = aeron->addSubscription(replayChannel_, replayStreamId_, defaultOnAvailableImageHandler,
+                                                [this](Image& image) { onUnavailableImage(image); });
+    while (!(subscription_ = aeron->findSubscription(subId))) {
+        std::this_thread::yield();
+    }
+}
+
+std::int64_t ReplayMultiplexer::replay(std::int64_t recordingId, std::int64_t position, std::int64_t length,
+                                       ReplayConsumer&& consumer) {
+    const std::int64_t stopPosition = stopPositionOf(position, length);
+
+    std::int64_t replayId = nextReplayId_++;
+    pending_.push_back(Replay{replayId, recordingId, position, length, stopPosition, -1, std::move(consumer),
+                              ReplayImageTracker(stopPosition)});
+
+    startPendingReplays(replayId);
+
+    return replayId;
+}
+
+void ReplayMultiplexer::expectAdoption() { ++expectedAdoptions_; }
+
+void ReplayMultiplexer::abandonAdoption() { --expectedAdoptions_; }
+
+std::int64_t ReplayMultiplexer::adopt(std::int64_t replaySessionId, std::int64_t recordingId, std::int64_t position,
+                                      std::int64_t length, ReplayConsumer&& consumer) {
+    const std::int64_t stopPosition = stopPositionOf(position, length);
+
+    --expectedAdoptions_;
+
+    std::int64_t replayId = nextReplayId_++;
+    activeBySessionId_.emplace(static_cast<std::int32_t>(replaySessionId),
+                               Replay{replayId, recordingId, position, length, stopPosition, replaySessionId,
+                                      std::move(consumer), ReplayImageTracker(stopPosition)});
+
+    return replayId;
+}
+
+void ReplayMultiplexer::cancel(std::int64_t replayId) {
+    std::int64_t replaySessionId;
+    if (!detach(replayId, replaySessionId)) {
+        return;
+    }
+
+    try {
+        archive_->stopReplay(replaySessionId);
+    } catch (const ArchiveException&) {
+        // the replay may have ended on the archive side already
+    }
+}
+
+bool ReplayMultiplexer::detach(std::int64_t replayId, std::int64_t& replaySessionId) {
+    auto pendingIt = std::find_if(pending_.begin(), pending_.end(),
+                                  [replayId](const Replay& replay) { return replay.replayId == replayId; });
+    if (pendingIt != pending_.end()) {
+        pending_.erase(pendingIt);
+        return false;
+    }
+
+    for (auto it = activeBySessionId_.begin(); it != activeBySessionId_.end(); ++it) {
+        if (it->second.replayId == replayId) {
+            replaySessionId = it->second.replaySessionId;
+            activeBySessionId_.erase(it);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::int32_t ReplayMultiplexer::poll() {
+    std::int32_t workCount = startPendingReplays(-1);
+
+    if (activeBySessionId_.empty()) {
+        return workCount;
+    }
+
+    std::int32_t fragments = subscription_->controlledPoll(fragmentAssembler_.handler(), fragmentLimit_);
+
+    if (fragments == 0) {
+        checkForEndOfStreams();
+    }
+
+    for (std::int32_t sessionId : completed_) {
+        complete(sessionId);
+    }
+    completed_.clear();
+
+    return workCount + fragments;
+}
+
+bool ReplayMultiplexer::isActive(std::int64_t replayId) const {
+    auto isSameReplay = [replayId](const Replay& replay) { return replay.replayId == replayId; };
+
+    return std::any_of(pending_.begin(), pending_.end(), isSameReplay) ||
+           std::any_of(activeBySessionId_.begin(), activeBySessionId_.end(),
+                       [&](const std::pair<const std::int32_t, Replay>& entry) { return isSameReplay(entry.second); });
+}
+
+std::int32_t ReplayMultiplexer::activeCount() const { return static_cast<std::int32_t>(activeBySessionId_.size()); }
+
+std::int32_t ReplayMultiplexer::pendingCount() const { return static_cast<std::int32_t>(pending_.size()); }
+
+const std::shared_ptr<Subscription>& ReplayMultiplexer::subscription() const { return subscription_; }
+
+ControlledPollAction ReplayMultiplexer::onFragment(concurrent::AtomicBuffer& buffer, util::index_t offset,
+                                                   util::index_t length, Header& header) {
+    auto it = activeBySessionId_.find(header.sessionId());
+    if (it == activeBySessionId_.end()) {
+        // either the image of a replay about to be adopted or a lingering one of a cancelled or completed replay
+        return expectedAdoptions_ > 0 ? ControlledPollAction::ABORT : ControlledPollAction::CONTINUE;
+    }
+
+    ControlledPollAction action = it->second.consumer(buffer, offset, length, header);
+
+    if (action != ControlledPollAction::ABORT && header.position() >= it->second.stopPosition) {
+        completed_.push_back(header.sessionId());
+        return ControlledPollAction::BREAK;
+    }
+
+    return action;
+}
+
+std::int32_t ReplayMultiplexer::startPendingReplays(std::int64_t callerReplayId) {
+    std::int32_t started = 0;
+    std::exception_ptr callerFailure;
+
+    while (!pending_.empty() && static_cast<std::int32_t>(activeBySessionId_.size()) < maxActiveReplays_) {
+        Replay replay = std::move(pending_.front());
+        pending_.pop_front();
+
+        try {
+            replay.replaySessionId = archive_->startReplay(replay.recordingId, replay.position, replay.length,
+                                                           replayChannel_, replayStreamId_);
+        } catch (const std::exception& e) {
+            // a replay which cannot start must not hold up the ones queued behind it
+            if (replay.replayId == callerReplayId) {
+                callerFailure = std::current_exception();
+            } else if (onFailed_) {
+                onFailed_(replay.replayId, e.what());
+            }
+            continue;
+        }
+
+        // the session id of a replay image is the lower half of the replay session id
+        std::int32_t sessionId = static_cast<std::int32_t>(replay.replaySessionId);
+        activeBySessionId_.emplace(sessionId, std::move(replay));
+        ++started;
+    }
+
+    if (callerFailure) {
+        std::rethrow_exception(callerFailure);
+    }
+
+    return started;
+}
+
+void ReplayMultiplexer::checkForEndOfStreams() {
+    for (auto& entry : activeBySessionId_) {
+        ReplayImageTracker& tracker = entry.second.tracker;
+
+        auto image = subscription_->imageBySessionId(entry.first);
+        if (image) {
+            tracker.onImage(image->isEndOfStream() || image->isClosed(), image->position());
+        } else {
+            // an image which went away, even before it was polled, ends the replay and frees its place
+            tracker.onNoImage(hasImageGoneAway(entry.first));
+        }
+
+        if (tracker.isDone()) {
+            completed_.push_back(entry.first);
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(goneLock_);
+    if (expectedAdoptions_ == 0) {
+        // images of cancelled or completed replays are of no interest, a replay about to be adopted may be
+        goneSessionIds_.erase(std::remove_if(goneSessionIds_.begin(), goneSessionIds_.end(),
+                                             [this](std::int32_t sessionId) {
+                                                 return activeBySessionId_.find(sessionId) ==
+                                                        activeBySessionId_.end();
+                                             }),
+                              goneSessionIds_.end());
+    }
+}
+
+void ReplayMultiplexer::complete(std::int32_t sessionId) {
+    auto it = activeBySessionId_.find(sessionId);
+    if (it == activeBySessionId_.end()) {
+        return;
+    }
+
+    std::int64_t replayId = it->second.replayId;
+    auto image = subscription_->imageBySessionId(sessionId);
+    std::int64_t position = image ? image->position() : it->second.position;
+
+    activeBySessionId_.erase(it);
+
+    {
+        std::unique_lock<std::mutex> lock(goneLock_);
+        goneSessionIds_.erase(std::remove(goneSessionIds_.begin(), goneSessionIds_.end(), sessionId),
+                              goneSessionIds_.end());
+    }
+
+    if (onComplete_) {
+        onComplete_(replayId, position);
+    }
+}
+
+void ReplayMultiplexer::onUnavailableImage(Image& image) {
+    std::unique_lock<std::mutex> lock(goneLock_);
+    goneSessionIds_.push_back(image.sessionId());
+}
+
+bool ReplayMultiplexer::hasImageGoneAway(std::int32_t sessionId) {
+    std::unique_lock<std::mutex> lock(goneLock_);
+    return std::find(goneSessionIds_.begin(), goneSessionIds_.end(), sessionId) != goneSessionIds_.end();
+}
+
+}  // namespace archive
+}  // namespace aeron
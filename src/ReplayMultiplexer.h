@@ -0,0 +1,121 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <Aeron.h>
+#include <ControlledFragmentAssembler.h>
+
+#include "AeronArchive.h"
+#include "ReplaySessionPool.h"
+
+namespace aeron {
+namespace archive {
+
+// Runs many replays over a single replay channel and stream id. Reassembled messages are routed to the consumer
+// of their replay by the image session id. The number of replays running on the archive at the same time is
+// capped, the rest wait in a queue and are started from poll() as running ones complete. A queued replay which fails
+// to start is dropped and reported to the failure handler, the queue carries on with the next one. A length of -1
+// replays until the recording stops (or live).
+// Not thread safe, all calls are expected from the polling thread.
+class ReplayMultiplexer {
+public:
+    using ReplayConsumer =
+        std::function<aeron::ControlledPollAction(aeron::concurrent::AtomicBuffer& buffer, aeron::util::index_t offset,
+                                                  aeron::util::index_t length, aeron::Header& header)>;
+    using OnReplayComplete = std::function<void(std::int64_t replayId, std::int64_t position)>;
+    using OnReplayFailed = std::function<void(std::int64_t replayId, const std::string& errorMessage)>;
+
+    ReplayMultiplexer(const std::shared_ptr<AeronArchive>& archive, const std::string& replayChannel,
+                      std::int32_t replayStreamId, std::int32_t maxActiveReplays, std::int32_t fragmentLimit,
+                      OnReplayComplete&& onComplete, OnReplayFailed&& onFailed);
+
+    ReplayMultiplexer(const ReplayMultiplexer&) = delete;
+    ReplayMultiplexer& operator=(const ReplayMultiplexer&) = delete;
+
+    // a replay of the caller which fails to start right away is thrown rather than reported
+    std::int64_t replay(std::int64_t recordingId, std::int64_t position, std::int64_t length,
+                        ReplayConsumer&& consumer);
+    // takes over a replay the caller started on the replay channel and stream id, it is not subject to the cap on
+    // active replays. Between expectAdoption() and adopt() or abandonAdoption() fragments of unknown sessions are
+    // held back instead of dropped, the image of the replay being started may already be polled.
+    void expectAdoption();
+    void abandonAdoption();
+    std::int64_t adopt(std::int64_t replaySessionId, std::int64_t recordingId, std::int64_t position,
+                       std::int64_t length, ReplayConsumer&& consumer);
+    void cancel(std::int64_t replayId);
+    // forgets a replay without stopping it on the archive, for callers which stop it themselves outside their lock.
+    // false when it was not started, otherwise the replay session id to stop it with
+    bool detach(std::int64_t replayId, std::int64_t& replaySessionId);
+
+    std::int32_t poll();
+
+    bool isActive(std::int64_t replayId) const;
+    std::int32_t activeCount() const;
+    std::int32_t pendingCount() const;
+    const std::shared_ptr<aeron::Subscription>& subscription() const;
+
+private:
+    struct Replay {
+        std::int64_t replayId;
+        std::int64_t recordingId;
+        std::int64_t position;
+        std::int64_t length;
+        std::int64_t stopPosition;
+        std::int64_t replaySessionId;
+        ReplayConsumer consumer;
+        ReplayImageTracker tracker;
+    };
+
+    aeron::ControlledPollAction onFragment(aeron::concurrent::AtomicBuffer& buffer, aeron::util::index_t offset,
+                                           aeron::util::index_t length, aeron::Header& header);
+    std::int32_t startPendingReplays(std::int64_t callerReplayId);
+    void checkForEndOfStreams();
+    void complete(std::int32_t sessionId);
+    void onUnavailableImage(aeron::Image& image);
+    bool hasImageGoneAway(std::int32_t sessionId);
+
+private:
+    std::shared_ptr<AeronArchive> archive_;
+    const std::string replayChannel_;
+    const std::int32_t replayStreamId_;
+    const std::int32_t maxActiveReplays_;
+    const std::int32_t fragmentLimit_;
+    OnReplayComplete onComplete_;
+    OnReplayFailed onFailed_;
+
+    // written by the unavailable image handler from the conductor, declared ahead of the subscription which is
+    // released first
+    std::mutex goneLock_;
+    std::vector<std::int32_t> goneSessionIds_;
+
+    std::shared_ptr<aeron::Subscription> subscription_;
+    aeron::ControlledFragmentAssembler fragmentAssembler_;
+
+    std::int64_t nextReplayId_{0};
+    std::int32_t expectedAdoptions_{0};
+    std::deque<Replay> pending_;
+    std::unordered_map<std::int32_t, Replay> activeBySessionId_;
+    std::vector<std::int32_t> completed_;
+};
+
+}  // namespace archive
+}  // namespace aeron
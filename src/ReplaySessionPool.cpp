@@ -0,0 +1,301 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <limits>
+#include <thread>
+
+#include "ArchiveException.h"
+#include "AsyncReplayInto.h"
+#include "ReplaySessionPool.h"
+
+namespace {
+
+const std::int32_t FRAGMENT_LIMIT = 10;
+const std::int64_t NULL_LENGTH = -1;
+const std::int64_t NULL_SESSION_ID = std::numeric_limits<std::int64_t>::min();
+
+}  // namespace
+
+namespace aeron {
+namespace archive {
+
+std::int64_t replayStopPosition(std::int64_t position, std::int64_t length) {
+    if (length == NULL_LENGTH || length >= std::numeric_limits<std::int64_t>::max() - position) {
+        return std::numeric_limits<std::int64_t>::max();
+    }
+
+    return position + length;
+}
+
+ReplayImageTracker::ReplayImageTracker(std::int64_t stopPosition) : stopPosition_(stopPosition) {}
+
+void ReplayImageTracker::onImage(bool isEnded, std::int64_t position) {
+    wasImageSeen_ = true;
+    isDone_ = isDone_ || isEnded || position >= stopPosition_;
+}
+
+void ReplayImageTracker::onNoImage(bool hasGoneAway) { isDone_ = isDone_ || wasImageSeen_ || hasGoneAway; }
+
+bool ReplayImageTracker::wasImageSeen() const { return wasImageSeen_; }
+
+bool ReplayImageTracker::isDone() const { return isDone_; }
+
+ReplaySessionPool::Handle::Handle(ReplaySessionPool* pool, std::int32_t slotIndex, std::int64_t replaySessionId,
+                                  std::int64_t stopPosition)
+    : pool_(pool)
+    , slotIndex_(slotIndex)
+    , replaySessionId_(replaySessionId)
+    , tracker_(stopPosition) {}
+
+ReplaySessionPool::Handle::~Handle() { close(); }
+
+ReplaySessionPool::Handle::Handle(Handle&& other) noexcept
+    : pool_(other.pool_)
+    , slotIndex_(other.slotIndex_)
+    , replaySessionId_(other.replaySessionId_)
+    , image_(std::move(other.image_))
+    , tracker_(other.tracker_) {
+    other.pool_ = nullptr;
+    other.slotIndex_ = -1;
+}
+
+ReplaySessionPool::Handle& ReplaySessionPool::Handle::operator=(Handle&& other) noexcept {
+    if (this != &other) {
+        close();
+
+        pool_ = other.pool_;
+        slotIndex_ = other.slotIndex_;
+        replaySessionId_ = other.replaySessionId_;
+        image_ = std::move(other.image_);
+        tracker_ = other.tracker_;
+
+        other.pool_ = nullptr;
+        other.slotIndex_ = -1;
+    }
+
+    return *this;
+}
+
+std::int64_t ReplaySessionPool::Handle::replaySessionId() const { return replaySessionId_; }
+
+std::int32_t ReplaySessionPool::Handle::replayStreamId() const { return pool_->slots_[slotIndex_].streamId; }
+
+const std::shared_ptr<Subscription>& ReplaySessionPool::Handle::subscription() const {
+    return pool_->slots_[slotIndex_].subscription;
+}
+
+std::shared_ptr<Image> ReplaySessionPool::Handle::image() {
+    if (!image_ && pool_) {
+        // the session id of a replay image is the lower half of the replay session id
+        image_ = subscription()->imageBySessionId(static_cast<std::int32_t>(replaySessionId_));
+    }
+
+    return image_;
+}
+
+std::int32_t ReplaySessionPool::Handle::poll(const fragment_handler_t& handler, std::int32_t fragmentLimit) {
+    auto img = image();
+    return img ? img->poll(handler, fragmentLimit) : 0;
+}
+
+std::int32_t ReplaySessionPool::Handle::controlledPoll(const controlled_poll_fragment_handler_t& handler,
+                                                       std::int32_t fragmentLimit) {
+    auto img = image();
+    return img ? img->controlledPoll(handler, fragmentLimit) : 0;
+}
+
+bool ReplaySessionPool::Handle::isDone() {
+    if (!tracker_.isDone() && pool_) {
+        auto img = image();
+        if (img) {
+            tracker_.onImage(img->isEndOfStream() || img->isClosed(), img->position());
+        } else {
+            tracker_.onNoImage(pool_->hasImageGoneAway(slotIndex_, static_cast<std::int32_t>(replaySessionId_)));
+        }
+    }
+
+    return tracker_.isDone();
+}
+
+void ReplaySessionPool::Handle::close() {
+    if (!pool_) {
+        return;
+    }
+
+    if (!isDone()) {
+        try {
+            pool_->archive_->stopReplay(replaySessionId_);
+        } catch (const ArchiveException&) {
+            // the replay may have ended on the archive side already
+        }
+    }
+
+    pool_->releaseSlot(slotIndex_);
+
+    image_.reset();
+    pool_ = nullptr;
+    slotIndex_ = -1;
+}
+
+ReplaySessionPool::ReplaySessionPool(const std::shared_ptr<AeronArchive>& archive, const std::string& replayChannel,
+                                     std::int32_t firstReplayStreamId, std::int32_t poolSize)
+    : archive_(archive)
+    , replayChannel_(replayChannel) {
+    if (poolSize <= 0) {
+        throw util::IllegalArgumentException("pool size must be positive: " + std::to_string(poolSize), SOURCEINFO);
+    }
+
+    auto aeron = archive_->context().aeron();
+
+    // sized up front, the unavailable image handlers write to it from the conductor
+    goneSessionIds_.assign(poolSize, NULL_SESSION_ID);
+
+    std::vector<std::int64_t> registrationIds;
+    for (std::int32_t i = 0; i < poolSize; ++i) {
+        registrationIds.push_back(aeron->addSubscription(replayChannel_, firstReplayStreamId + i,
+                                                         defaultOnAvailableImageHandler,
+                                                         [this, i](Image& image) { onUnavailableImage(i, image); }));
+    }
+
+    for (std::int32_t i = 0; i < poolSize; ++i) {
+        std::shared_ptr<Subscription> subscription;
+        while (!(subscription = aeron->findSubscription(registrationIds[i]))) {
+            std::this_thread::yield();
+        }
+
+        slots_.push_back(Slot{subscription, firstReplayStreamId + i});
+        freeSlots_.push_back(poolSize - 1 - i);
+    }
+}
+
+ReplaySessionPool::Handle ReplaySessionPool::replay(std::int64_t recordingId, std::int64_t position,
+                                                    std::int64_t length) {
+    std::int32_t slotIndex = acquireSlot();
+    if (slotIndex < 0) {
+        throw ArchiveException("no free replay slot in pool of " + std::to_string(slots_.size()), SOURCEINFO);
+    }
+
+    return startReplay(slotIndex, recordingId, position, length);
+}
+
+bool ReplaySessionPool::tryReplay(std::int64_t recordingId, std::int64_t position, std::int64_t length,
+                                  Handle& handle) {
+    std::int32_t slotIndex = acquireSlot();
+    if (slotIndex < 0) {
+        return false;
+    }
+
+    handle = startReplay(slotIndex, recordingId, position, length);
+    return true;
+}
+
+util::index_t ReplaySessionPool::replayInto(std::int64_t recordingId, std::int64_t position, std::int64_t length,
+                                            ReplayBuffer& buffer) {
+    return replayInto(recordingId, position, length, replayStopPosition(position, length), buffer);
+}
+
+util::index_t ReplaySessionPool::replayInto(std::int64_t recordingId, std::int64_t position, std::int64_t length,
+                                            std::int64_t stopPosition, ReplayBuffer& buffer) {
+    using Clock = std::chrono::high_resolution_clock;
+
+    auto replay = asyncReplayInto(recordingId, position, length, stopPosition, buffer);
+
+    const std::chrono::nanoseconds timeout(archive_->context().messageTimeoutNs());
+    auto deadline = Clock::now() + timeout;
+    concurrent::YieldingIdleStrategy idleStrategy;
+
+    while (!replay->isDone()) {
+        if (replay->poll() > 0) {
+            deadline = Clock::now() + timeout;
+            continue;
+        }
+
+        if (Clock::now() > deadline) {
+            throw ArchiveException("awaiting replay of recordingId=" + std::to_string(recordingId) +
+                                       ", position=" + std::to_string(replay->position()),
+                                   SOURCEINFO);
+        }
+
+        idleStrategy.idle();
+    }
+
+    return buffer.limit();
+}
+
+std::unique_ptr<AsyncReplayInto> ReplaySessionPool::asyncReplayInto(std::int64_t recordingId, std::int64_t position,
+                                                                    std::int64_t length, ReplayBuffer& buffer) {
+    return asyncReplayInto(recordingId, position, length, replayStopPosition(position, length), buffer);
+}
+
+std::unique_ptr<AsyncReplayInto> ReplaySessionPool::asyncReplayInto(std::int64_t recordingId, std::int64_t position,
+                                                                    std::int64_t length, std::int64_t stopPosition,
+                                                                    ReplayBuffer& buffer) {
+    return std::make_unique<AsyncReplayInto>(replay(recordingId, position, length), buffer, stopPosition,
+                                             FRAGMENT_LIMIT);
+}
+
+const std::string& ReplaySessionPool::replayChannel() const { return replayChannel_; }
+
+std::int32_t ReplaySessionPool::poolSize() const { return static_cast<std::int32_t>(slots_.size()); }
+
+std::int32_t ReplaySessionPool::available() {
+    std::unique_lock<std::mutex> lock(lock_);
+    return static_cast<std::int32_t>(freeSlots_.size());
+}
+
+std::int32_t ReplaySessionPool::acquireSlot() {
+    std::unique_lock<std::mutex> lock(lock_);
+
+    if (freeSlots_.empty()) {
+        return -1;
+    }
+
+    std::int32_t slotIndex = freeSlots_.back();
+    freeSlots_.pop_back();
+    return slotIndex;
+}
+
+void ReplaySessionPool::releaseSlot(std::int32_t slotIndex) {
+    std::unique_lock<std::mutex> lock(lock_);
+    freeSlots_.push_back(slotIndex);
+}
+
+ReplaySessionPool::Handle ReplaySessionPool::startReplay(std::int32_t slotIndex, std::int64_t recordingId,
+                                                         std::int64_t position, std::int64_t length) {
+    std::int64_t replaySessionId;
+    try {
+        replaySessionId = archive_->startReplay(recordingId, position, length, replayChannel_, slots_[slotIndex].streamId);
+    } catch (...) {
+        releaseSlot(slotIndex);
+        throw;
+    }
+
+    return Handle(this, slotIndex, replaySessionId, replayStopPosition(position, length));
+}
+
+void ReplaySessionPool::onUnavailableImage(std::int32_t slotIndex, Image& image) {
+    std::unique_lock<std::mutex> lock(lock_);
+    goneSessionIds_[slotIndex] = image.sessionId();
+}
+
+bool ReplaySessionPool::hasImageGoneAway(std::int32_t slotIndex, std::int32_t sessionId) {
+    std::unique_lock<std::mutex> lock(lock_);
+    return goneSessionIds_[slotIndex] == sessionId;
+}
+
+}  // namespace archive
+}  // namespace aeron
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <limits>
+#include <mutex>
+#include <vector>
+
+#include <Aeron.h>
+
+#include "AeronArchive.h"
+#include "ReplayBuffer.h"
+
+namespace aeron {
+namespace archive {
+
+class AsyncReplayInto;
+
+// the position a replay of the given length stops at, a length of -1 has no stop position and follows the recording
+std::int64_t replayStopPosition(std::int64_t position, std::int64_t length);
+
+// Tells when a bounded replay is over from what is seen of its image. A short replay may end and its image go away
+// between two polls, so an image that went away (once seen, or as reported by the unavailable image handler before
+// it was ever seen) ends the replay as well.
+class ReplayImageTracker {
+public:
+    explicit ReplayImageTracker(std::int64_t stopPosition = std::numeric_limits<std::int64_t>::max());
+
+    void onImage(bool isEnded, std::int64_t position);
+    void onNoImage(bool hasGoneAway);
+
+    bool wasImageSeen() const;
+    bool isDone() const;
+
+private:
+    std::int64_t stopPosition_;
+    bool wasImageSeen_{false};
+    bool isDone_{false};
+};
+
+// Keeps a set of replay subscriptions registered on consecutive stream ids and hands them out for
+// bounded replays. A slot is reused across replays, images of a replay are picked by the replay session id.
+class ReplaySessionPool {
+    struct Slot {
+        std::shared_ptr<aeron::Subscription> subscription;
+        std::int32_t streamId;
+    };
+
+public:
+    // RAII handle of an active replay, it stops the replay (if still running) and returns the slot on close
+    class Handle {
+    public:
+        Handle() = default;
+        Handle(ReplaySessionPool* pool, std::int32_t slotIndex, std::int64_t replaySessionId,
+               std::int64_t stopPosition);
+        ~Handle();
+
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+        Handle(Handle&& other) noexcept;
+        Handle& operator=(Handle&& other) noexcept;
+
+        std::int64_t replaySessionId() const;
+        std::int32_t replayStreamId() const;
+        const std::shared_ptr<aeron::Subscription>& subscription() const;
+        std::shared_ptr<aeron::Image> image();
+
+        std::int32_t poll(const aeron::fragment_handler_t& handler, std::int32_t fragmentLimit);
+        std::int32_t controlledPoll(const aeron::controlled_poll_fragment_handler_t& handler,
+                                    std::int32_t fragmentLimit);
+
+        bool isDone();
+        void close();
+
+    private:
+        ReplaySessionPool* pool_{nullptr};
+        std::int32_t slotIndex_{-1};
+        std::int64_t replaySessionId_{-1};
+        std::shared_ptr<aeron::Image> image_;
+        ReplayImageTracker tracker_;
+    };
+
+    ReplaySessionPool(const std::shared_ptr<AeronArchive>& archive, const std::string& replayChannel,
+                      std::int32_t firstReplayStreamId, std::int32_t poolSize);
+
+    ReplaySessionPool(const ReplaySessionPool&) = delete;
+    ReplaySessionPool& operator=(const ReplaySessionPool&) = delete;
+
+    Handle replay(std::int64_t recordingId, std::int64_t position, std::int64_t length);
+    bool tryReplay(std::int64_t recordingId, std::int64_t position, std::int64_t length, Handle& handle);
+
+    // bounded replay reassembled into the caller buffer, returns the number of bytes written
+    aeron::util::index_t replayInto(std::int64_t recordingId, std::int64_t position, std::int64_t length,
+                                    ReplayBuffer& buffer);
+    // as above, but ends with the first message ending at or after the stop position, the length has to leave
+    // room for that message
+    aeron::util::index_t replayInto(std::int64_t recordingId, std::int64_t position, std::int64_t length,
+                                    std::int64_t stopPosition, ReplayBuffer& buffer);
+    std::unique_ptr<AsyncReplayInto> asyncReplayInto(std::int64_t recordingId, std::int64_t position,
+                                                     std::int64_t length, ReplayBuffer& buffer);
+    std::unique_ptr<AsyncReplayInto> asyncReplayInto(std::int64_t recordingId, std::int64_t position,
+                                                     std::int64_t length, std::int64_t stopPosition,
+                                                     ReplayBuffer& buffer);
+
+    const std::string& replayChannel() const;
+    std::int32_t poolSize() const;
+    std::int32_t available();
+
+private:
+    std::int32_t acquireSlot();
+    void releaseSlot(std::int32_t slotIndex);
+    Handle startReplay(std::int32_t slotIndex, std::int64_t recordingId, std::int64_t position, std::int64_t length);
+    void onUnavailableImage(std::int32_t slotIndex, aeron::Image& image);
+    bool hasImageGoneAway(std::int32_t slotIndex, std::int32_t sessionId);
+
+private:
+    std::shared_ptr<AeronArchive> archive_;
+    const std::string replayChannel_;
+
+    std::mutex lock_;
+    std::vector<std::int32_t> freeSlots_;
+    // by slot, the session of the last image which went away, a slot only replays one session at a time
+    std::vector<std::int64_t> goneSessionIds_;
+
+    // declared last so the subscriptions are released first, their unavailable image handlers use the members above
+    std::vector<Slot> slots_;
+};
+
+}  // namespace archive
+}  // namespace aeron
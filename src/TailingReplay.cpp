@@ -0,0 +1,152 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <limits>
+
+#include "ArchiveException.h"
+#include "RecordingPos.h"
+#include "TailingReplay.h"
+
+namespace {
+
+const std::int64_t NULL_POSITION = -1;
+const std::int64_t OPEN_ENDED_LENGTH = std::numeric_limits<std::int64_t>::max();
+
+}  // namespace
+
+namespace aeron {
+namespace archive {
+
+TailingReplay::TailingReplay(const std::shared_ptr<AeronArchive>& archive, ReplaySessionPool& replayPool,
+                             std::int64_t recordingId, std::int64_t position, std::int32_t fragmentLimit)
+    : archive_(archive)
+    , aeron_(archive->context().aeron())
+    , recordingId_(recordingId)
+    , fragmentLimit_(fragmentLimit)
+    , messageTimeoutNs_(archive->context().messageTimeoutNs())
+    , fragmentAssembler_([this](concurrent::AtomicBuffer& buffer, util::index_t offset, util::index_t length,
+                                Header& header) {
+        (*handler_)(buffer, offset, length, header);
+        return ControlledPollAction::CONTINUE;
+    })
+    , assemblerHandler_(fragmentAssembler_.handler())
+    , fragmentHandler_([this](concurrent::AtomicBuffer& buffer, util::index_t offset, util::index_t length,
+                              Header& header) { return onFragment(buffer, offset, length, header); })
+    , position_(position)
+    , recordedPosition_(position)
+    , stopPosition_(NULL_POSITION) {
+    counterId_ = RecordingPos::findCounterIdByRecording(aeron_->countersReader(), recordingId_);
+
+    if (counterId_ < 0) {
+        stopPosition_ = archive_->getStopPosition(recordingId_);
+        if (stopPosition_ == NULL_POSITION) {
+            throw ArchiveException("no recording position counter nor stop position for recordingId=" +
+                                       std::to_string(recordingId_),
+                                   SOURCEINFO);
+        }
+
+        recordedPosition_ = stopPosition_;
+        if (stopPosition_ <= position_) {
+            isDone_ = true;
+            return;
+        }
+    }
+
+    const std::int64_t length = stopPosition_ == NULL_POSITION ? OPEN_ENDED_LENGTH : stopPosition_ - position_;
+    handle_ = replayPool.replay(recordingId_, position_, length);
+}
+
+std::int32_t TailingReplay::poll(const fragment_handler_t& handler) {
+    if (isDone_) {
+        return 0;
+    }
+
+    handler_ = &handler;
+    updateRecordedPosition();
+
+    const std::int32_t fragments = handle_.controlledPoll(fragmentHandler_, fragmentLimit_);
+
+    auto image = handle_.image();
+    if (image) {
+        position_ = image->position();
+    }
+
+    if ((stopPosition_ != NULL_POSITION && position_ >= stopPosition_) || (fragments == 0 && handle_.isDone())) {
+        // an open ended replay has to be stopped explicitly, the handle does so on close
+        isDone_ = true;
+        handle_.close();
+    }
+
+    return fragments;
+}
+
+void TailingReplay::onRecordingStopped(std::int64_t recordingId, std::int64_t stopPosition) {
+    if (recordingId == recordingId_ && stopPosition_ == NULL_POSITION) {
+        stopPosition_ = stopPosition;
+        recordedPosition_ = stopPosition;
+    }
+}
+
+bool TailingReplay::isDone() const { return isDone_; }
+
+std::int64_t TailingReplay::recordingId() const { return recordingId_; }
+
+std::int64_t TailingReplay::position() const { return position_; }
+
+std::int64_t TailingReplay::recordedPosition() const { return recordedPosition_; }
+
+std::int64_t TailingReplay::stopPosition() const { return stopPosition_; }
+
+ControlledPollAction TailingReplay::onFragment(concurrent::AtomicBuffer& buffer, util::index_t offset,
+                                               util::index_t length, Header& header) {
+    // the header position is the position after the fragment
+    if (header.position() > recordedPosition_) {
+        return ControlledPollAction::ABORT;
+    }
+
+    return assemblerHandler_(buffer, offset, length, header);
+}
+
+void TailingReplay::updateRecordedPosition() {
+    if (stopPosition_ != NULL_POSITION) {
+        return;
+    }
+
+    auto& countersReader = aeron_->countersReader();
+
+    // the value is read before the check so it belongs to this recording if the counter is still active
+    const std::int64_t recordedPosition = countersReader.getCounterValue(counterId_);
+    if (RecordingPos::isActive(countersReader, counterId_, recordingId_)) {
+        recordedPosition_ = recordedPosition;
+        return;
+    }
+
+    // the catalog may lag the counter being freed, it is asked again after a while rather than on every poll
+    const Clock::time_point now = Clock::now();
+    if (now < nextStopPositionQuery_) {
+        return;
+    }
+    nextStopPositionQuery_ = now + messageTimeoutNs_;
+
+    const std::int64_t stopPosition = archive_->getStopPosition(recordingId_);
+    if (stopPosition != NULL_POSITION) {
+        stopPosition_ = stopPosition;
+        recordedPosition_ = stopPosition;
+    }
+}
+
+}  // namespace archive
+}  // namespace aeron
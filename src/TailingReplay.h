@@ -0,0 +1,85 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+
+#include <Aeron.h>
+#include <ControlledFragmentAssembler.h>
+
+#include "AeronArchive.h"
+#include "ReplaySessionPool.h"
+
+namespace aeron {
+namespace archive {
+
+// Follows a recording which may still be active. The replay is open ended and delivery is bounded by the
+// live RecordingPos counter of the recording so only data the archive has made durable is passed on.
+// Once the recording stops (its counter goes away or onRecordingStopped is called) the replay ends at
+// the stop position. A recording which has already stopped is replayed up to its stop position.
+// Not thread safe, all calls are expected from the polling thread.
+class TailingReplay {
+    using Clock = std::chrono::high_resolution_clock;
+
+public:
+    TailingReplay(const std::shared_ptr<AeronArchive>& archive, ReplaySessionPool& replayPool,
+                  std::int64_t recordingId, std::int64_t position, std::int32_t fragmentLimit);
+
+    TailingReplay(const TailingReplay&) = delete;
+    TailingReplay& operator=(const TailingReplay&) = delete;
+
+    std::int32_t poll(const aeron::fragment_handler_t& handler);
+
+    // to be wired to the stop event of a RecordingEventsAdapter, it saves polling the counter for the stop
+    void onRecordingStopped(std::int64_t recordingId, std::int64_t stopPosition);
+
+    bool isDone() const;
+    std::int64_t recordingId() const;
+    std::int64_t position() const;
+    std::int64_t recordedPosition() const;
+    // NULL_POSITION (-1) while the recording is active
+    std::int64_t stopPosition() const;
+
+private:
+    aeron::ControlledPollAction onFragment(aeron::concurrent::AtomicBuffer& buffer, aeron::util::index_t offset,
+                                           aeron::util::index_t length, aeron::Header& header);
+    void updateRecordedPosition();
+
+private:
+    std::shared_ptr<AeronArchive> archive_;
+    std::shared_ptr<aeron::Aeron> aeron_;
+    const std::int64_t recordingId_;
+    const std::int32_t fragmentLimit_;
+    const std::chrono::nanoseconds messageTimeoutNs_;
+    std::int32_t counterId_{-1};
+    // the catalog is asked for the stop position at most once per message timeout
+    Clock::time_point nextStopPositionQuery_;
+
+    aeron::ControlledFragmentAssembler fragmentAssembler_;
+    aeron::controlled_poll_fragment_handler_t assemblerHandler_;
+    aeron::controlled_poll_fragment_handler_t fragmentHandler_;
+    const aeron::fragment_handler_t* handler_{nullptr};
+
+    ReplaySessionPool::Handle handle_;
+    std::int64_t position_;
+    std::int64_t recordedPosition_;
+    std::int64_t stopPosition_;
+    bool isDone_{false};
+};
+
+}  // namespace archive
+}  // namespace aeron
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include <ArchiveCommandQueue.h>
+
+using namespace aeron::archive;
+
+class ArchiveCommandRingTest : public ::testing::Test {
+protected:
+    ArchiveCommandRingTest() : ring(3) {}
+
+    ArchiveCommandRing ring;
+    std::vector<std::int64_t> drained;
+
+    std::int32_t drain(std::int32_t limit) {
+        return ring.drain(
+            [this](ArchiveCommand& command, ArchiveCommandCallback& callback) {
+                drained.push_back(command.recordingId);
+            },
+            limit);
+    }
+};
+
+TEST_F(ArchiveCommandRingTest, shouldRoundCapacityUpToPowerOfTwo) { EXPECT_EQ(4, ring.capacity()); }
+
+TEST_F(ArchiveCommandRingTest, shouldRejectCommandsWhenFull) {
+    for (std::int64_t i = 0; i < 4; ++i) {
+        ASSERT_TRUE(ring.offer(ArchiveCommand::getRecordingPosition(i), nullptr));
+    }
+
+    EXPECT_FALSE(ring.offer(ArchiveCommand::getRecordingPosition(4), nullptr));
+    EXPECT_EQ(4, ring.size());
+
+    EXPECT_EQ(1, drain(1));
+    EXPECT_TRUE(ring.offer(ArchiveCommand::getRecordingPosition(4), nullptr));
+    EXPECT_EQ(4, drain(10));
+
+    EXPECT_EQ((std::vector<std::int64_t>{0, 1, 2, 3, 4}), drained);
+    EXPECT_EQ(0, ring.size());
+}
+
+TEST_F(ArchiveCommandRingTest, shouldHandCommandAndCallbackToConsumer) {
+    std::int64_t completedId = -1;
+
+    ASSERT_TRUE(ring.offer(ArchiveCommand::startReplay(7, 0, 1024, "aeron:ipc", 101),
+                           [&](const ArchiveCommandResult& result) { completedId = result.correlationId; }));
+
+    ring.drain(
+        [](ArchiveCommand& command, ArchiveCommandCallback& callback) {
+            EXPECT_EQ(ArchiveOperation::START_REPLAY, command.operation);
+            EXPECT_EQ("aeron:ipc", command.channel);
+            EXPECT_EQ(101, command.streamId);
+
+            ArchiveCommandResult result;
+            result.correlationId = command.recordingId;
+            callback(result);
+        },
+        1);
+
+    EXPECT_EQ(7, completedId);
+}
+
+TEST(ArchiveCommandRingConcurrencyTest, shouldDeliverEveryCommandFromConcurrentProducers) {
+    const std::int32_t producerCount = 4;
+    const std::int64_t commandsPerProducer = 20000;
+    ArchiveCommandRing ring(64);
+    std::vector<std::thread> producers;
+
+    for (std::int32_t p = 0; p < producerCount; ++p) {
+        producers.emplace_back([&ring, p, commandsPerProducer]() {
+            for (std::int64_t i = 0; i < commandsPerProducer; ++i) {
+                while (!ring.offer(ArchiveCommand::truncateRecording(p, i), nullptr)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<std::int64_t> nextByProducer(producerCount, 0);
+    std::int64_t received = 0;
+
+    while (received < producerCount * commandsPerProducer) {
+        received += ring.drain(
+            [&](ArchiveCommand& command, ArchiveCommandCallback& callback) {
+                // each producer's commands arrive in the order it offered them
+                ASSERT_EQ(nextByProducer[command.recordingId], command.position);
+                ++nextByProducer[command.recordingId];
+            },
+            16);
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    for (std::int64_t next : nextByProducer) {
+        EXPECT_EQ(commandsPerProducer, next);
+    }
+    EXPECT_EQ(0, ring.size());
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <ArchiveCommandQueue.h>
+
+#include "ControlMessageEncoder.h"
+
+using namespace aeron::archive;
+
+namespace codecs = io::aeron::archive::codecs;
+
+class ArchiveCommandTrackerTest : public ::testing::Test {
+protected:
+    static constexpr std::int64_t CONTROL_SESSION_ID = 42;
+
+    ArchiveCommandTrackerTest()
+        : dispatcher(nullptr, 10)
+        , tracker(dispatcher, CONTROL_SESSION_ID, TIMEOUT)
+        , start(ArchiveCommandTracker::Clock::now()) {}
+
+    ArchiveCommandCallback collect() {
+        return [this](const ArchiveCommandResult& result) { results.push_back(result); };
+    }
+
+    void send(ArchiveCommand command, std::int64_t correlationId, ArchiveCommandTracker::TimePoint now) {
+        ArchiveCommandCallback callback = collect();
+        tracker.expect(command, correlationId);
+        tracker.onSent(command, correlationId, callback, now);
+    }
+
+    static const std::chrono::nanoseconds TIMEOUT;
+
+    ControlMessageEncoder messages;
+    ControlResponseDispatcher dispatcher;
+    ArchiveCommandTracker tracker;
+    const ArchiveCommandTracker::TimePoint start;
+    std::vector<ArchiveCommandResult> results;
+};
+
+constexpr std::int64_t ArchiveCommandTrackerTest::CONTROL_SESSION_ID;
+const std::chrono::nanoseconds ArchiveCommandTrackerTest::TIMEOUT = std::chrono::seconds(1);
+
+TEST_F(ArchiveCommandTrackerTest, shouldCompleteCallWhichCannotBeSentAtOnce) {
+    ArchiveCommand command = ArchiveCommand::getRecordingPosition(7);
+    ArchiveCommandCallback callback = collect();
+
+    tracker.expect(command, 1);
+    tracker.onSendFailed(command, 1, callback, "failed to send request: correlationId=1");
+    tracker.runCallbacks();
+
+    ASSERT_EQ(1u, results.size());
+    EXPECT_FALSE(results[0].isSuccess());
+    EXPECT_EQ(ArchiveOperation::GET_RECORDING_POSITION, results[0].operation);
+    EXPECT_EQ(codecs::ControlResponseCode::NULL_VALUE, results[0].code);
+    EXPECT_EQ("failed to send request: correlationId=1", results[0].errorMessage);
+    EXPECT_EQ(0, tracker.inFlightCount());
+    EXPECT_EQ(0, dispatcher.pendingCount());
+}
+
+TEST_F(ArchiveCommandTrackerTest, shouldCompleteAnsweredCallOnlyWhenCallbacksRun) {
+    send(ArchiveCommand::getRecordingPosition(7), 1, start);
+
+    messages.onResponse(dispatcher, CONTROL_SESSION_ID, 1, 1024, codecs::ControlResponseCode::OK);
+
+    EXPECT_EQ(1, tracker.completeCalls(start));
+    EXPECT_TRUE(results.empty());
+
+    tracker.runCallbacks();
+
+    ASSERT_EQ(1u, results.size());
+    EXPECT_TRUE(results[0].isSuccess());
+    EXPECT_EQ(1024, results[0].relevantId);
+    EXPECT_EQ(0, tracker.inFlightCount());
+}
+
+TEST_F(ArchiveCommandTrackerTest, shouldTimeOutCallPastItsDeadline) {
+    send(ArchiveCommand::getRecordingPosition(7), 1, start);
+
+    EXPECT_EQ(0, tracker.completeCalls(start + TIMEOUT));
+    EXPECT_EQ(1, tracker.completeCalls(start + TIMEOUT + std::chrono::nanoseconds(1)));
+    tracker.runCallbacks();
+
+    ASSERT_EQ(1u, results.size());
+    EXPECT_EQ(codecs::ControlResponseCode::NULL_VALUE, results[0].code);
+    EXPECT_EQ("awaiting response for correlationId=1", results[0].errorMessage);
+    EXPECT_EQ(0, dispatcher.pendingCount());
+
+    // a late response belongs to no call any more
+    messages.onResponse(dispatcher, CONTROL_SESSION_ID, 1, 1024, codecs::ControlResponseCode::OK);
+    EXPECT_EQ(0, tracker.completeCalls(start + 2 * TIMEOUT));
+}
+
+TEST_F(ArchiveCommandTrackerTest, shouldExtendListingDeadlineWithEveryDescriptor) {
+    std::vector<std::int64_t> recordingIds;
+    send(ArchiveCommand::listRecordings(0, 3, recordingIdCollector(recordingIds)), 1, start);
+
+    const auto descriptorTime = start + TIMEOUT / 2;
+    messages.onDescriptor(dispatcher, CONTROL_SESSION_ID, 1, 10);
+    EXPECT_EQ(0, tracker.completeCalls(descriptorTime));
+
+    EXPECT_EQ(0, tracker.completeCalls(start + TIMEOUT + std::chrono::nanoseconds(1)));
+    EXPECT_EQ(1, tracker.completeCalls(descriptorTime + TIMEOUT + std::chrono::nanoseconds(1)));
+    tracker.runCallbacks();
+
+    ASSERT_EQ(1u, results.size());
+    EXPECT_EQ(ArchiveOperation::LIST_RECORDINGS, results[0].operation);
+    EXPECT_EQ(1, results[0].recordCount);
+    EXPECT_EQ("awaiting response for correlationId=1", results[0].errorMessage);
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <Aeron.h>
+
+#include "io_aeron_archive_codecs/ControlResponse.h"
+#include "io_aeron_archive_codecs/MessageHeader.h"
+#include "io_aeron_archive_codecs/RecordingDescriptor.h"
+
+#include <ControlResponseDispatcher.h>
+
+namespace aeron {
+namespace archive {
+
+// Encodes archive messages as they arrive assembled from a subscription, so dispatchers and pollers can be fed
+// without one. Shared by the tests and the benchmarks.
+class ControlMessageEncoder {
+public:
+    static constexpr aeron::util::index_t TERM_LENGTH = 64 * 1024;
+
+    ControlMessageEncoder() : buffer_(&bytes_[0], bytes_.size()), header_(0, TERM_LENGTH) {}
+
+    ControlMessageEncoder(const ControlMessageEncoder&) = delete;
+    ControlMessageEncoder& operator=(const ControlMessageEncoder&) = delete;
+
+    // encodes the message header for T at the start of the buffer and wraps msg after it, complete() once encoded
+    template <typename T>
+    T& wrap(T& msg) {
+        io::aeron::archive::codecs::MessageHeader hdr;
+
+        hdr.wrap((char*)buffer_.buffer(), 0, 0, buffer_.capacity())
+            .blockLength(T::sbeBlockLength())
+            .templateId(T::sbeTemplateId())
+            .schemaId(T::sbeSchemaId())
+            .version(T::sbeSchemaVersion());
+
+        return msg.wrapForEncode((char*)buffer_.buffer(), hdr.encodedLength(), buffer_.capacity());
+    }
+
+    template <typename T>
+    void complete(T& msg) {
+        length_ = static_cast<aeron::util::index_t>(io::aeron::archive::codecs::MessageHeader::encodedLength() +
+                                                    msg.encodedLength());
+    }
+
+    void encodeResponse(std::int64_t controlSessionId, std::int64_t correlationId, std::int64_t relevantId,
+                        io::aeron::archive::codecs::ControlResponseCode::Value code,
+                        const std::string& errorMessage = "") {
+        io::aeron::archive::codecs::ControlResponse msg;
+        wrap(msg)
+            .controlSessionId(controlSessionId)
+            .correlationId(correlationId)
+            .relevantId(relevantId)
+            .code(code)
+            .putErrorMessage(errorMessage);
+        complete(msg);
+    }
+
+    void encodeDescriptor(std::int64_t controlSessionId, std::int64_t correlationId, std::int64_t recordingId) {
+        io::aeron::archive::codecs::RecordingDescriptor msg;
+        wrap(msg)
+            .controlSessionId(controlSessionId)
+            .correlationId(correlationId)
+            .recordingId(recordingId)
+            .putStrippedChannel("aeron:ipc")
+            .putOriginalChannel("aeron:ipc")
+            .putSourceIdentity("aeron:ipc");
+        complete(msg);
+    }
+
+    void onResponse(ControlResponseDispatcher& dispatcher, std::int64_t controlSessionId, std::int64_t correlationId,
+                    std::int64_t relevantId, io::aeron::archive::codecs::ControlResponseCode::Value code,
+                    const std::string& errorMessage = "") {
+        encodeResponse(controlSessionId, correlationId, relevantId, code, errorMessage);
+        dispatcher.onFragment(buffer_, 0, length_, header_);
+    }
+
+    void onDescriptor(ControlResponseDispatcher& dispatcher, std::int64_t controlSessionId,
+                      std::int64_t correlationId, std::int64_t recordingId) {
+        encodeDescriptor(controlSessionId, correlationId, recordingId);
+        dispatcher.onFragment(buffer_, 0, length_, header_);
+    }
+
+    aeron::concurrent::AtomicBuffer& buffer() { return buffer_; }
+    aeron::util::index_t length() const { return length_; }
+    aeron::Header& header() { return header_; }
+
+private:
+    alignas(8) std::array<std::uint8_t, 1024> bytes_{};
+    aeron::concurrent::AtomicBuffer buffer_;
+    aeron::util::index_t length_{0};
+    aeron::Header header_;
+};
+
+// a consumer appending the id of every recording listed
+inline RecordingDescriptorConsumer recordingIdCollector(std::vector<std::int64_t>& recordingIds) {
+    return [&recordingIds](std::int64_t controlSessionId, std::int64_t correlationId, std::int64_t recordingId,
+                           std::int64_t startTimestamp, std::int64_t stopTimestamp, std::int64_t startPosition,
+                           std::int64_t stopPosition, std::int32_t initialTermId, std::int32_t segmentFileLength,
+                           std::int32_t termBufferLength, std::int32_t mtuLength, std::int32_t sessionId,
+                           std::int32_t streamId, const std::string& strippedChannel,
+                           const std::string& originalChannel,
+                           const std::string& sourceIdentity) { recordingIds.push_back(recordingId); };
+}
+
+}  // namespace archive
+}  // namespace aeron
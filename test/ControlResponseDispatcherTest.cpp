@@ -0,0 +1,148 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include <ControlResponseDispatcher.h>
+
+#include "ControlMessageEncoder.h"
+
+using namespace aeron::archive;
+
+namespace codecs = io::aeron::archive::codecs;
+
+class ControlResponseDispatcherTest : public ::testing::Test {
+protected:
+    static constexpr std::int64_t CONTROL_SESSION_ID = 42;
+
+    ControlResponseDispatcherTest() : dispatcher(nullptr, 10) {}
+
+    void onResponse(std::int64_t controlSessionId, std::int64_t correlationId, std::int64_t relevantId,
+                    codecs::ControlResponseCode::Value code, const std::string& errorMessage = "") {
+        messages.onResponse(dispatcher, controlSessionId, correlationId, relevantId, code, errorMessage);
+    }
+
+    void onDescriptor(std::int64_t controlSessionId, std::int64_t correlationId, std::int64_t recordingId) {
+        messages.onDescriptor(dispatcher, controlSessionId, correlationId, recordingId);
+    }
+
+    ControlMessageEncoder messages;
+    ControlResponseDispatcher dispatcher;
+};
+
+constexpr std::int64_t ControlResponseDispatcherTest::CONTROL_SESSION_ID;
+
+TEST_F(ControlResponseDispatcherTest, shouldRouteInterleavedResponsesAndDescriptorsToTheirCalls) {
+    std::vector<std::int64_t> recordingIds;
+    dispatcher.expectDescriptors(CONTROL_SESSION_ID, 1, 2, recordingIdCollector(recordingIds));
+    dispatcher.expectResponse(CONTROL_SESSION_ID, 2);
+
+    onDescriptor(CONTROL_SESSION_ID, 1, 10);
+    onResponse(CONTROL_SESSION_ID, 2, 7, codecs::ControlResponseCode::OK);
+
+    EXPECT_FALSE(dispatcher.isComplete(1));
+    EXPECT_EQ(1, dispatcher.remainingRecordCount(1));
+    ASSERT_TRUE(dispatcher.isComplete(2));
+    EXPECT_EQ(7, dispatcher.take(2).relevantId);
+
+    onDescriptor(CONTROL_SESSION_ID, 1, 11);
+
+    ASSERT_TRUE(dispatcher.isComplete(1));
+    EXPECT_EQ(0, dispatcher.take(1).remainingRecordCount);
+    EXPECT_EQ((std::vector<std::int64_t>{10, 11}), recordingIds);
+    EXPECT_EQ(0, dispatcher.pendingCount());
+}
+
+TEST_F(ControlResponseDispatcherTest, shouldEndListingEarlyOnRecordingUnknown) {
+    std::vector<std::int64_t> recordingIds;
+    dispatcher.expectDescriptors(CONTROL_SESSION_ID, 1, 5, recordingIdCollector(recordingIds));
+
+    onDescriptor(CONTROL_SESSION_ID, 1, 10);
+    onResponse(CONTROL_SESSION_ID, 1, 11, codecs::ControlResponseCode::RECORDING_UNKNOWN);
+
+    ASSERT_TRUE(dispatcher.isComplete(1));
+    auto response = dispatcher.take(1);
+    EXPECT_EQ(codecs::ControlResponseCode::RECORDING_UNKNOWN, response.code);
+    EXPECT_EQ(4, response.remainingRecordCount);
+}
+
+TEST_F(ControlResponseDispatcherTest, shouldCompleteOnlyTheListingWhoseConsumerThrows) {
+    std::vector<std::int64_t> recordingIds;
+    dispatcher.expectDescriptors(CONTROL_SESSION_ID, 1, 2,
+                                 [](std::int64_t controlSessionId, std::int64_t correlationId, std::int64_t recordingId,
+                                    std::int64_t startTimestamp, std::int64_t stopTimestamp,
+                                    std::int64_t startPosition, std::int64_t stopPosition, std::int32_t initialTermId,
+                                    std::int32_t segmentFileLength, std::int32_t termBufferLength,
+                                    std::int32_t mtuLength, std::int32_t sessionId, std::int32_t streamId,
+                                    const std::string& strippedChannel, const std::string& originalChannel,
+                                    const std::string& sourceIdentity) { throw std::runtime_error("full"); });
+    dispatcher.expectDescriptors(CONTROL_SESSION_ID, 2, 1, recordingIdCollector(recordingIds));
+
+    EXPECT_NO_THROW(onDescriptor(CONTROL_SESSION_ID, 1, 10));
+    onDescriptor(CONTROL_SESSION_ID, 1, 11);
+    onDescriptor(CONTROL_SESSION_ID, 2, 12);
+
+    ASSERT_TRUE(dispatcher.isComplete(1));
+    auto response = dispatcher.take(1);
+    EXPECT_EQ(codecs::ControlResponseCode::ERROR, response.code);
+    EXPECT_EQ(10, response.relevantId);
+    EXPECT_EQ("recording descriptor consumer failed: full", response.errorMessage);
+
+    ASSERT_TRUE(dispatcher.isComplete(2));
+    EXPECT_EQ(codecs::ControlResponseCode::OK, dispatcher.take(2).code);
+    EXPECT_EQ((std::vector<std::int64_t>{12}), recordingIds);
+}
+
+TEST_F(ControlResponseDispatcherTest, shouldIgnoreMessagesOfOtherSessions) {
+    std::vector<std::int64_t> recordingIds;
+    dispatcher.expectDescriptors(CONTROL_SESSION_ID, 1, 1, recordingIdCollector(recordingIds));
+    dispatcher.expectResponse(CONTROL_SESSION_ID, 2);
+
+    onDescriptor(CONTROL_SESSION_ID + 1, 1, 10);
+    onResponse(CONTROL_SESSION_ID + 1, 2, 7, codecs::ControlResponseCode::OK);
+
+    EXPECT_FALSE(dispatcher.isComplete(1));
+    EXPECT_FALSE(dispatcher.isComplete(2));
+    EXPECT_TRUE(recordingIds.empty());
+}
+
+TEST_F(ControlResponseDispatcherTest, shouldCompleteConnectOfAnySession) {
+    dispatcher.expectResponse(ControlResponseDispatcher::ANY_SESSION, 1);
+
+    onResponse(CONTROL_SESSION_ID, 1, 0, codecs::ControlResponseCode::OK);
+
+    ASSERT_TRUE(dispatcher.isComplete(1));
+    EXPECT_EQ(CONTROL_SESSION_ID, dispatcher.take(1).controlSessionId);
+}
+
+TEST_F(ControlResponseDispatcherTest, shouldKeepOnlyUnclaimedErrors) {
+    dispatcher.expectResponse(CONTROL_SESSION_ID, 1);
+    dispatcher.cancel(1);
+
+    onResponse(CONTROL_SESSION_ID, 1, 3, codecs::ControlResponseCode::ERROR, "unknown recording");
+    onResponse(CONTROL_SESSION_ID, 2, 3, codecs::ControlResponseCode::OK);
+
+    EXPECT_FALSE(dispatcher.takeError(CONTROL_SESSION_ID + 1));
+
+    auto error = dispatcher.takeError(CONTROL_SESSION_ID);
+    ASSERT_TRUE(error);
+    EXPECT_EQ("unknown recording", error->errorMessage);
+    EXPECT_EQ(1, error->correlationId);
+    EXPECT_FALSE(dispatcher.takeError(CONTROL_SESSION_ID));
+}
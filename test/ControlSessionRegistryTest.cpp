@@ -0,0 +1,110 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <ArchiveException.h>
+#include <ArchiveSessionMultiplexer.h>
+
+#include "ControlMessageEncoder.h"
+
+using namespace aeron::archive;
+
+namespace codecs = io::aeron::archive::codecs;
+
+class ControlSessionRegistryTest : public ::testing::Test {
+protected:
+    ControlSessionRegistryTest() : dispatcher(nullptr, 10), sessions(dispatcher) {}
+
+    // connects a session the way the multiplexer does, the archive assigns its id in the response
+    std::int64_t open(std::int64_t correlationId, std::int64_t controlSessionId) {
+        sessions.expectConnect(correlationId);
+        messages.onResponse(dispatcher, controlSessionId, correlationId, 0, codecs::ControlResponseCode::OK);
+
+        EXPECT_TRUE(dispatcher.isComplete(correlationId));
+        return sessions.onConnected(dispatcher.take(correlationId));
+    }
+
+    ControlMessageEncoder messages;
+    ControlResponseDispatcher dispatcher;
+    ControlSessionRegistry sessions;
+};
+
+TEST_F(ControlSessionRegistryTest, shouldOpenSessionFromConnectResponse) {
+    EXPECT_EQ(5, open(1, 5));
+    EXPECT_EQ(6, open(2, 6));
+
+    EXPECT_EQ(2, sessions.sessionCount());
+    EXPECT_EQ(0, dispatcher.pendingCount());
+}
+
+TEST_F(ControlSessionRegistryTest, shouldNotOpenSessionOnRejectedConnect) {
+    sessions.expectConnect(1);
+    messages.onResponse(dispatcher, 5, 1, 0, codecs::ControlResponseCode::ERROR, "too many sessions");
+
+    ASSERT_TRUE(dispatcher.isComplete(1));
+    EXPECT_THROW(sessions.onConnected(dispatcher.take(1)), ArchiveException);
+    EXPECT_EQ(0, sessions.sessionCount());
+}
+
+TEST_F(ControlSessionRegistryTest, shouldRouteResponsesToTheSessionOfEachCall) {
+    open(1, 5);
+    open(2, 6);
+
+    std::vector<std::int64_t> recordingIds;
+    sessions.expectCall(5, 10, 0, RecordingDescriptorConsumer());
+    sessions.expectCall(6, 11, 2, recordingIdCollector(recordingIds));
+
+    // the correlation id of one session does not complete the call of another
+    messages.onResponse(dispatcher, 6, 10, 7, codecs::ControlResponseCode::OK);
+    messages.onDescriptor(dispatcher, 5, 11, 100);
+    EXPECT_FALSE(dispatcher.isComplete(10));
+    EXPECT_TRUE(recordingIds.empty());
+
+    messages.onDescriptor(dispatcher, 6, 11, 100);
+    messages.onResponse(dispatcher, 5, 10, 8, codecs::ControlResponseCode::OK);
+    messages.onDescriptor(dispatcher, 6, 11, 101);
+
+    ASSERT_TRUE(dispatcher.isComplete(10));
+    EXPECT_EQ(8, dispatcher.take(10).relevantId);
+    ASSERT_TRUE(dispatcher.isComplete(11));
+    EXPECT_EQ(0, dispatcher.take(11).remainingRecordCount);
+    EXPECT_EQ((std::vector<std::int64_t>{100, 101}), recordingIds);
+}
+
+TEST_F(ControlSessionRegistryTest, shouldRejectCallsOfClosedSession) {
+    open(1, 5);
+    open(2, 6);
+
+    EXPECT_TRUE(sessions.close(5));
+    EXPECT_THROW(sessions.expectCall(5, 10, 0, RecordingDescriptorConsumer()), ArchiveException);
+    EXPECT_EQ(0, dispatcher.pendingCount());
+
+    sessions.expectCall(6, 11, 0, RecordingDescriptorConsumer());
+    EXPECT_EQ(1, dispatcher.pendingCount());
+    EXPECT_EQ(1, sessions.sessionCount());
+}
+
+TEST_F(ControlSessionRegistryTest, shouldCloseSessionOnce) {
+    open(1, 5);
+
+    EXPECT_TRUE(sessions.close(5));
+    EXPECT_FALSE(sessions.close(5));
+    EXPECT_FALSE(sessions.close(6));
+    EXPECT_EQ(0, sessions.sessionCount());
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <LatencyHistogram.h>
+
+using namespace aeron::archive;
+
+TEST(LatencyHistogramTest, shouldKeepSmallValuesExact) {
+    for (std::int64_t value = 0; value < 128; ++value) {
+        const std::int32_t index = LatencyHistogram::bucketIndex(value);
+        EXPECT_EQ(value, LatencyHistogram::lowestEquivalentValue(index));
+        EXPECT_EQ(value, LatencyHistogram::highestEquivalentValue(index));
+    }
+}
+
+TEST(LatencyHistogramTest, shouldMapLargeValuesWithinBucketBounds) {
+    std::int32_t lastIndex = LatencyHistogram::bucketIndex(127);
+
+    for (std::int64_t value = 128; value < (std::int64_t{1} << 20); value += 37) {
+        const std::int32_t index = LatencyHistogram::bucketIndex(value);
+        ASSERT_LE(LatencyHistogram::lowestEquivalentValue(index), value);
+        ASSERT_GE(LatencyHistogram::highestEquivalentValue(index), value);
+        ASSERT_GE(index, lastIndex);
+        ASSERT_LT(LatencyHistogram::highestEquivalentValue(index) - LatencyHistogram::lowestEquivalentValue(index),
+                  value / 64 + 1);
+        lastIndex = index;
+    }
+}
+
+TEST(LatencyHistogramTest, shouldClampToLastBucket) {
+    EXPECT_EQ(LatencyHistogram::BUCKET_COUNT - 1, LatencyHistogram::bucketIndex(std::int64_t{1} << 50));
+
+    LatencyHistogram histogram;
+    histogram.record(std::int64_t{1} << 50);
+    EXPECT_EQ(1, histogram.snapshot().counts[LatencyHistogram::BUCKET_COUNT - 1]);
+}
+
+TEST(LatencyHistogramTest, shouldReportPercentiles) {
+    LatencyHistogram histogram;
+    for (std::int64_t value = 1; value <= 1000; ++value) {
+        histogram.record(value * 1000);
+    }
+
+    LatencySnapshot snapshot = histogram.snapshot();
+
+    EXPECT_EQ(1000, snapshot.totalCount);
+    EXPECT_EQ(1000, snapshot.minValue);
+    EXPECT_EQ(1000000, snapshot.maxValue);
+    EXPECT_DOUBLE_EQ(500500.0, snapshot.mean());
+    EXPECT_NEAR(500000, snapshot.valueAtPercentile(50.0), 500000 / 64);
+    EXPECT_NEAR(999000, snapshot.valueAtPercentile(99.9), 999000 / 64);
+    EXPECT_EQ(1000000, snapshot.valueAtPercentile(100.0));
+}
+
+TEST(LatencyHistogramTest, shouldResetOnSnapshotAndReset) {
+    LatencyHistogram histogram;
+    histogram.record(10);
+    histogram.record(20);
+
+    LatencySnapshot first = histogram.snapshotAndReset();
+    EXPECT_EQ(2, first.totalCount);
+    EXPECT_EQ(10, first.minValue);
+    EXPECT_EQ(20, first.maxValue);
+
+    LatencySnapshot second = histogram.snapshot();
+    EXPECT_EQ(0, second.totalCount);
+    EXPECT_EQ(0, second.valueAtPercentile(99.0));
+
+    histogram.record(5);
+    EXPECT_EQ(5, histogram.snapshot().minValue);
+}
+
+TEST(LatencyHistogramTest, shouldBackfillSamplesMissedDuringStall) {
+    LatencyHistogram histogram;
+    histogram.recordCorrected(100, 1000);
+    histogram.recordCorrected(4500, 1000);
+
+    LatencySnapshot snapshot = histogram.snapshot();
+    EXPECT_EQ(5, snapshot.totalCount);
+    EXPECT_EQ(100, snapshot.minValue);
+    EXPECT_EQ(4500, snapshot.maxValue);
+    EXPECT_EQ(100 + 4500 + 3500 + 2500 + 1500, snapshot.sum);
+
+    histogram.recordCorrected(4500, 0);
+    EXPECT_EQ(6, histogram.snapshot().totalCount);
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <array>
+
+#include <MessageWindow.h>
+
+using namespace aeron::archive;
+
+class MessageWindowTest : public ::testing::Test {
+protected:
+    MessageWindowTest()
+        : src(&srcBytes[0], srcBytes.size())
+        , window(16, 4) {
+        for (std::size_t i = 0; i < srcBytes.size(); ++i) {
+            srcBytes[i] = static_cast<std::uint8_t>(i);
+        }
+    }
+
+    std::array<std::uint8_t, 32> srcBytes;
+    aeron::concurrent::AtomicBuffer src;
+    MessageWindow window;
+};
+
+TEST_F(MessageWindowTest, shouldKeepMessagesInArrivalOrder) {
+    ASSERT_TRUE(window.offer(10, src, 0, 4));
+    ASSERT_TRUE(window.offer(20, src, 4, 4));
+
+    EXPECT_EQ(2, window.size());
+    EXPECT_EQ(10, window.headTimestamp());
+    EXPECT_EQ(4, window.headLength());
+    EXPECT_EQ(0, window.buffer().getUInt8(window.headOffset()));
+
+    window.pop();
+
+    EXPECT_EQ(20, window.headTimestamp());
+    EXPECT_EQ(4, window.buffer().getUInt8(window.headOffset()));
+}
+
+TEST_F(MessageWindowTest, shouldRejectMessagesWhenFull) {
+    ASSERT_TRUE(window.offer(1, src, 0, 12));
+    EXPECT_FALSE(window.offer(2, src, 0, 8));
+    ASSERT_TRUE(window.offer(2, src, 0, 4));
+    EXPECT_FALSE(window.offer(3, src, 0, 1));
+}
+
+TEST_F(MessageWindowTest, shouldRejectMessagesBeyondMaxCount) {
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(window.offer(i, src, 0, 1));
+    }
+
+    EXPECT_FALSE(window.offer(4, src, 0, 1));
+}
+
+TEST_F(MessageWindowTest, shouldWrapAroundOnceHeadIsReleased) {
+    ASSERT_TRUE(window.offer(1, src, 0, 8));
+    ASSERT_TRUE(window.offer(2, src, 8, 6));
+    window.pop();
+
+    ASSERT_TRUE(window.offer(3, src, 16, 8));
+    EXPECT_FALSE(window.offer(4, src, 0, 1));
+
+    window.pop();
+    EXPECT_EQ(3, window.headTimestamp());
+    EXPECT_EQ(0, window.headOffset());
+    EXPECT_EQ(16, window.buffer().getUInt8(window.headOffset()));
+}
+
+TEST_F(MessageWindowTest, shouldRejectMessageLargerThanCapacity) { EXPECT_FALSE(window.offer(1, src, 0, 17)); }
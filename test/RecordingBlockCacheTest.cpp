@@ -0,0 +1,307 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <concurrent/logbuffer/FrameDescriptor.h>
+
+#include <RecordingBlockCache.h>
+
+using namespace aeron::archive;
+
+namespace {
+
+const std::uint8_t BEGIN_FRAG = aeron::concurrent::logbuffer::FrameDescriptor::BEGIN_FRAG;
+const std::uint8_t END_FRAG = aeron::concurrent::logbuffer::FrameDescriptor::END_FRAG;
+
+const std::int32_t HEADER_LENGTH = 32;
+const std::int32_t BLOCK_LENGTH = 512;
+const std::int32_t TERM_LENGTH = 512;
+const std::int64_t RECORDING_ID = 7;
+
+// a stopped recording replayed from memory, every payload byte of a message is the message index
+class FakeRecording {
+public:
+    void addMessage(std::int32_t payloadLength) { addMessage(payloadLength, payloadLength); }
+
+    void addMessage(std::int32_t payloadLength, std::int32_t fragmentLength) {
+        const std::uint8_t index = messageCount_++;
+
+        for (std::int32_t offset = 0; offset < payloadLength; offset += fragmentLength) {
+            std::uint8_t flags = 0;
+            flags |= offset == 0 ? BEGIN_FRAG : 0;
+            flags |= offset + fragmentLength >= payloadLength ? END_FRAG : 0;
+
+            fragments_.push_back(Fragment{stopPosition_, fragmentLength, flags, index});
+            stopPosition_ += HEADER_LENGTH + fragmentLength;
+        }
+    }
+
+    RecordingBlockCache::Source source() {
+        RecordingBlockCache::Source source;
+
+        source.recordingBounds = [this](std::int64_t recordingId) {
+            return RecordingBlockCache::RecordingBounds{0, stopPosition_, TERM_LENGTH};
+        };
+        source.recordingPosition = [this](std::int64_t recordingId) { return stopPosition_; };
+        source.replayInto = [this](std::int64_t recordingId, std::int64_t position, std::int64_t length,
+                                   std::int64_t stopPosition, ReplayBuffer& buffer) {
+            replayInto(position, length, stopPosition, buffer);
+        };
+
+        return source;
+    }
+
+    std::int64_t stopPosition() const { return stopPosition_; }
+    std::int32_t replays() const { return replays_; }
+
+private:
+    struct Fragment {
+        std::int64_t position;
+        std::int32_t length;
+        std::uint8_t flags;
+        std::uint8_t messageIndex;
+    };
+
+    void replayInto(std::int64_t position, std::int64_t length, std::int64_t stopPosition, ReplayBuffer& buffer) {
+        ++replays_;
+        buffer.reset();
+
+        std::vector<std::uint8_t> payload;
+        for (const Fragment& fragment : fragments_) {
+            const std::int64_t endPosition = fragment.position + HEADER_LENGTH + fragment.length;
+            if (fragment.position < position) {
+                continue;
+            }
+
+            if (endPosition > position + length) {
+                break;
+            }
+
+            payload.assign(fragment.length, fragment.messageIndex);
+            aeron::concurrent::AtomicBuffer src(&payload[0], payload.size());
+
+            if (!buffer.appendFragment(src, 0, fragment.length, fragment.flags, endPosition)) {
+                break;
+            }
+
+            if (endPosition >= stopPosition && !buffer.isInMessage()) {
+                break;
+            }
+        }
+
+        buffer.abort();
+    }
+
+    std::vector<Fragment> fragments_;
+    std::int64_t stopPosition_{0};
+    std::uint8_t messageCount_{0};
+    std::int32_t replays_{0};
+};
+
+}  // namespace
+
+class RecordingBlockCacheTest : public ::testing::Test {
+protected:
+    RecordingBlockCacheTest()
+        : bytes(4096)
+        , buffer(&bytes[0], static_cast<aeron::util::index_t>(bytes.size()), 64) {}
+
+    // messages of 32 bytes in 64 byte frames, eight to a block
+    void addMessages(std::int32_t count) {
+        for (std::int32_t i = 0; i < count; ++i) {
+            recording.addMessage(32);
+        }
+    }
+
+    std::unique_ptr<RecordingBlockCache> newCache(std::int32_t blockCount) {
+        return std::make_unique<RecordingBlockCache>(recording.source(), BLOCK_LENGTH, blockCount);
+    }
+
+    void expectMessage(std::size_t index, std::int64_t position, std::int32_t length, std::uint8_t messageIndex) {
+        ASSERT_LT(index, buffer.messages().size());
+        const MessageBoundary& message = buffer.messages()[index];
+
+        EXPECT_EQ(position, message.position);
+        ASSERT_EQ(length, message.length);
+        for (std::int32_t i = 0; i < length; ++i) {
+            ASSERT_EQ(messageIndex, buffer.buffer().getUInt8(message.offset + i));
+        }
+    }
+
+    FakeRecording recording;
+    std::vector<std::uint8_t> bytes;
+    ReplayBuffer buffer;
+};
+
+TEST_F(RecordingBlockCacheTest, shouldServeRepeatedReadFromCache) {
+    addMessages(16);
+    auto cache = newCache(8);
+
+    ASSERT_TRUE(cache->read(RECORDING_ID, 0, BLOCK_LENGTH, buffer));
+    EXPECT_EQ(1, recording.replays());
+    EXPECT_EQ(8u, buffer.messages().size());
+
+    buffer.reset();
+    ASSERT_TRUE(cache->read(RECORDING_ID, 0, BLOCK_LENGTH, buffer));
+
+    EXPECT_EQ(1, recording.replays());
+    EXPECT_EQ(1, cache->hits());
+    EXPECT_EQ(1, cache->misses());
+    ASSERT_EQ(8u, buffer.messages().size());
+    expectMessage(0, 64, 32, 0);
+    expectMessage(7, 512, 32, 7);
+}
+
+TEST_F(RecordingBlockCacheTest, shouldGiveReferencedBlockSecondChanceOnEviction) {
+    addMessages(11 * 8);
+    // eight blocks make a single set
+    auto cache = newCache(8);
+
+    auto readBlock = [&](std::int64_t block) {
+        buffer.reset();
+        ASSERT_TRUE(cache->read(RECORDING_ID, block * BLOCK_LENGTH, BLOCK_LENGTH, buffer));
+    };
+
+    for (std::int64_t block = 0; block < 10; ++block) {
+        readBlock(block);
+    }
+    // blocks 0 and 1 made room, every block left has been read since the clock hand last passed it
+    EXPECT_EQ(10, recording.replays());
+    EXPECT_EQ(2, cache->evictions());
+
+    // the hand is at block 2, which is referenced again and skipped in favour of block 3
+    readBlock(2);
+    readBlock(10);
+    EXPECT_EQ(11, recording.replays());
+    EXPECT_EQ(3, cache->evictions());
+
+    readBlock(2);
+    EXPECT_EQ(11, recording.replays());
+
+    readBlock(3);
+    EXPECT_EQ(12, recording.replays());
+    ASSERT_EQ(8u, buffer.messages().size());
+    expectMessage(0, 3 * BLOCK_LENGTH + 64, 32, 24);
+}
+
+TEST_F(RecordingBlockCacheTest, shouldReadMessageCrossingBlockEnd) {
+    addMessages(7);
+    // begins at 448 and ends at 576, past the end of block 0
+    recording.addMessage(64, 32);
+    addMessages(8);
+    auto cache = newCache(8);
+
+    ASSERT_TRUE(cache->read(RECORDING_ID, 384, 256, buffer));
+
+    ASSERT_EQ(3u, buffer.messages().size());
+    expectMessage(0, 448, 32, 6);
+    expectMessage(1, 576, 64, 7);
+    expectMessage(2, 640, 32, 8);
+}
+
+TEST_F(RecordingBlockCacheTest, shouldReadMessageBegunInBlockBeforeTheRange) {
+    addMessages(7);
+    recording.addMessage(64, 32);
+    addMessages(8);
+    auto cache = newCache(8);
+
+    ASSERT_TRUE(cache->read(RECORDING_ID, BLOCK_LENGTH, 128, buffer));
+
+    // the tail of the crossing message is dropped from block 1 and served whole from block 0
+    ASSERT_EQ(2u, buffer.messages().size());
+    expectMessage(0, 576, 64, 7);
+    expectMessage(1, 640, 32, 8);
+    EXPECT_EQ(2, recording.replays());
+}
+
+TEST_F(RecordingBlockCacheTest, shouldNotServeTornBlockWhileSlotsAreOverwritten) {
+    addMessages(16 * 8);
+    // a single set of eight slots shared by sixteen blocks keeps evicting under the readers
+    auto cache = newCache(8);
+
+    std::atomic<bool> isTorn{false};
+    std::vector<std::thread> readers;
+
+    for (std::int32_t r = 0; r < 4; ++r) {
+        readers.emplace_back([&, r]() {
+            std::vector<std::uint8_t> readerBytes(4096);
+            ReplayBuffer readerBuffer(&readerBytes[0], static_cast<aeron::util::index_t>(readerBytes.size()), 64);
+
+            for (std::int32_t i = 0; i < 2000 && !isTorn; ++i) {
+                const std::int64_t block = (i * 7 + r * 3) % 16;
+
+                readerBuffer.reset();
+                if (!cache->read(RECORDING_ID, block * BLOCK_LENGTH, BLOCK_LENGTH, readerBuffer) ||
+                    readerBuffer.messages().size() != 8u) {
+                    isTorn = true;
+                    break;
+                }
+
+                for (std::size_t m = 0; m < readerBuffer.messages().size(); ++m) {
+                    const MessageBoundary& message = readerBuffer.messages()[m];
+                    const std::int64_t messageIndex = block * 8 + static_cast<std::int64_t>(m);
+
+                    if (message.position != (messageIndex + 1) * 64 || message.length != 32 ||
+                        readerBuffer.buffer().getUInt8(message.offset) != static_cast<std::uint8_t>(messageIndex) ||
+                        readerBuffer.buffer().getUInt8(message.offset + 31) !=
+                            static_cast<std::uint8_t>(messageIndex)) {
+                        isTorn = true;
+                    }
+                }
+            }
+        });
+    }
+
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_FALSE(isTorn);
+    EXPECT_GT(cache->evictions(), 0);
+}
+
+TEST_F(RecordingBlockCacheTest, shouldRefillInvalidatedBlock) {
+    addMessages(8);
+    auto cache = newCache(8);
+
+    ASSERT_TRUE(cache->read(RECORDING_ID, 0, BLOCK_LENGTH, buffer));
+    cache->invalidate(RECORDING_ID);
+
+    buffer.reset();
+    ASSERT_TRUE(cache->read(RECORDING_ID, 0, BLOCK_LENGTH, buffer));
+
+    EXPECT_EQ(2, recording.replays());
+    EXPECT_EQ(8u, buffer.messages().size());
+}
+
+TEST_F(RecordingBlockCacheTest, shouldStopAtRecordingEnd) {
+    addMessages(12);
+    auto cache = newCache(8);
+
+    ASSERT_TRUE(cache->read(RECORDING_ID, BLOCK_LENGTH, 4 * BLOCK_LENGTH, buffer));
+
+    ASSERT_EQ(4u, buffer.messages().size());
+    expectMessage(3, recording.stopPosition(), 32, 11);
+
+    buffer.reset();
+    ASSERT_TRUE(cache->read(RECORDING_ID, 4 * BLOCK_LENGTH, BLOCK_LENGTH, buffer));
+    EXPECT_TRUE(buffer.messages().empty());
+}
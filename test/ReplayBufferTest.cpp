@@ -0,0 +1,172 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <array>
+
+#include <concurrent/logbuffer/FrameDescriptor.h>
+
+#include <ReplayBuffer.h>
+
+using namespace aeron::archive;
+
+namespace {
+
+const std::uint8_t BEGIN_FRAG = aeron::concurrent::logbuffer::FrameDescriptor::BEGIN_FRAG;
+const std::uint8_t END_FRAG = aeron::concurrent::logbuffer::FrameDescriptor::END_FRAG;
+const std::uint8_t UNFRAGMENTED = BEGIN_FRAG | END_FRAG;
+
+}  // namespace
+
+class ReplayBufferTest : public ::testing::Test {
+protected:
+    ReplayBufferTest()
+        : src(&srcBytes[0], srcBytes.size())
+        , buffer(&dstBytes[0], dstBytes.size(), 2) {
+        for (std::size_t i = 0; i < srcBytes.size(); ++i) {
+            srcBytes[i] = static_cast<std::uint8_t>(i);
+        }
+    }
+
+    std::array<std::uint8_t, 64> srcBytes;
+    std::array<std::uint8_t, 32> dstBytes;
+    aeron::concurrent::AtomicBuffer src;
+    ReplayBuffer buffer;
+};
+
+TEST_F(ReplayBufferTest, shouldRecordMessageBoundaries) {
+    ASSERT_TRUE(buffer.append(src, 0, 8));
+    ASSERT_TRUE(buffer.commit(64));
+    ASSERT_TRUE(buffer.append(src, 8, 4));
+    ASSERT_TRUE(buffer.append(src, 12, 4));
+    ASSERT_TRUE(buffer.commit(192));
+
+    EXPECT_EQ(16, buffer.limit());
+    ASSERT_EQ(2u, buffer.messages().size());
+    EXPECT_EQ(0, buffer.messages()[0].offset);
+    EXPECT_EQ(8, buffer.messages()[0].length);
+    EXPECT_EQ(64, buffer.messages()[0].position);
+    EXPECT_EQ(8, buffer.messages()[1].offset);
+    EXPECT_EQ(8, buffer.messages()[1].length);
+    EXPECT_EQ(192, buffer.messages()[1].position);
+    EXPECT_EQ(12, buffer.buffer().getUInt8(12));
+}
+
+TEST_F(ReplayBufferTest, shouldDropIncompleteMessageOnAbort) {
+    ASSERT_TRUE(buffer.append(src, 0, 8));
+    ASSERT_TRUE(buffer.commit(64));
+    ASSERT_TRUE(buffer.append(src, 0, 8));
+    buffer.abort();
+
+    EXPECT_EQ(8, buffer.limit());
+    EXPECT_EQ(1u, buffer.messages().size());
+}
+
+TEST_F(ReplayBufferTest, shouldRejectDataBeyondCapacity) {
+    ASSERT_TRUE(buffer.append(src, 0, 24));
+    EXPECT_FALSE(buffer.append(src, 0, 16));
+    EXPECT_EQ(24, buffer.limit());
+}
+
+TEST_F(ReplayBufferTest, shouldRejectMessagesBeyondMaxCount) {
+    for (int i = 0; i < 2; ++i) {
+        ASSERT_TRUE(buffer.append(src, 0, 4));
+        ASSERT_TRUE(buffer.commit(32 * (i + 1)));
+    }
+
+    ASSERT_TRUE(buffer.append(src, 0, 4));
+    EXPECT_FALSE(buffer.commit(96));
+    EXPECT_EQ(8, buffer.limit());
+    EXPECT_EQ(2u, buffer.messages().size());
+}
+
+TEST_F(ReplayBufferTest, shouldReset) {
+    ASSERT_TRUE(buffer.append(src, 0, 4));
+    ASSERT_TRUE(buffer.commit(32));
+    buffer.reset();
+
+    EXPECT_EQ(0, buffer.limit());
+    EXPECT_TRUE(buffer.messages().empty());
+}
+
+TEST_F(ReplayBufferTest, shouldReassembleFragmentedMessage) {
+    ASSERT_TRUE(buffer.appendFragment(src, 0, 4, UNFRAGMENTED, 32));
+    ASSERT_TRUE(buffer.appendFragment(src, 4, 4, BEGIN_FRAG, 64));
+    EXPECT_TRUE(buffer.isInMessage());
+    ASSERT_TRUE(buffer.appendFragment(src, 8, 4, 0, 96));
+    ASSERT_TRUE(buffer.appendFragment(src, 12, 4, END_FRAG, 128));
+
+    EXPECT_FALSE(buffer.isInMessage());
+    ASSERT_EQ(2u, buffer.messages().size());
+    EXPECT_EQ(4, buffer.messages()[1].offset);
+    EXPECT_EQ(12, buffer.messages()[1].length);
+    EXPECT_EQ(128, buffer.messages()[1].position);
+}
+
+TEST_F(ReplayBufferTest, shouldDropTailOfMessageStartedBeforeReplay) {
+    ASSERT_TRUE(buffer.appendFragment(src, 0, 4, 0, 32));
+    ASSERT_TRUE(buffer.appendFragment(src, 4, 4, END_FRAG, 64));
+
+    EXPECT_EQ(0, buffer.limit());
+    EXPECT_TRUE(buffer.messages().empty());
+
+    ASSERT_TRUE(buffer.appendFragment(src, 8, 4, UNFRAGMENTED, 96));
+
+    ASSERT_EQ(1u, buffer.messages().size());
+    EXPECT_EQ(0, buffer.messages()[0].offset);
+    EXPECT_EQ(8, buffer.buffer().getUInt8(0));
+    EXPECT_EQ(96, buffer.messages()[0].position);
+}
+
+TEST_F(ReplayBufferTest, shouldDropIncompleteMessageOnNextBegin) {
+    ASSERT_TRUE(buffer.appendFragment(src, 0, 4, BEGIN_FRAG, 32));
+    ASSERT_TRUE(buffer.appendFragment(src, 4, 4, UNFRAGMENTED, 64));
+
+    ASSERT_EQ(1u, buffer.messages().size());
+    EXPECT_EQ(4, buffer.messages()[0].length);
+    EXPECT_EQ(4, buffer.buffer().getUInt8(0));
+}
+
+TEST_F(ReplayBufferTest, shouldAbortFragmentedMessageBeyondCapacity) {
+    ASSERT_TRUE(buffer.appendFragment(src, 0, 24, BEGIN_FRAG, 32));
+    EXPECT_FALSE(buffer.appendFragment(src, 0, 16, END_FRAG, 64));
+
+    EXPECT_FALSE(buffer.isInMessage());
+    EXPECT_EQ(0, buffer.limit());
+}
+
+TEST_F(ReplayBufferTest, shouldKeepMessageCrossingBlockEndWholeInTheBlockItBeganIn) {
+    // the first block [0, 64) ends with a message crossing into the next one
+    ASSERT_TRUE(buffer.appendFragment(src, 0, 4, UNFRAGMENTED, 32));
+    ASSERT_TRUE(buffer.appendFragment(src, 4, 4, BEGIN_FRAG, 64));
+    ASSERT_TRUE(buffer.appendFragment(src, 8, 4, END_FRAG, 96));
+
+    EXPECT_EQ(-1, buffer.skippedPosition());
+    ASSERT_EQ(2u, buffer.messages().size());
+    EXPECT_EQ(8, buffer.messages()[1].length);
+    EXPECT_EQ(96, buffer.messages()[1].position);
+
+    // the next block [64, 128) starts with the tail of that message
+    buffer.reset();
+    ASSERT_TRUE(buffer.appendFragment(src, 8, 4, END_FRAG, 96));
+    ASSERT_TRUE(buffer.appendFragment(src, 12, 4, UNFRAGMENTED, 128));
+
+    EXPECT_EQ(96, buffer.skippedPosition());
+    ASSERT_EQ(1u, buffer.messages().size());
+    EXPECT_EQ(12, buffer.buffer().getUInt8(0));
+    EXPECT_EQ(128, buffer.messages()[0].position);
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2018-2019 Fairtide Pte. Ltd.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <limits>
+
+#include <ReplaySessionPool.h>
+
+using namespace aeron::archive;
+
+TEST(ReplayImageTrackerTest, shouldNotBeDoneBeforeImageIsSeen) {
+    ReplayImageTracker tracker(1024);
+
+    tracker.onNoImage(false);
+
+    EXPECT_FALSE(tracker.wasImageSeen());
+    EXPECT_FALSE(tracker.isDone());
+}
+
+TEST(ReplayImageTrackerTest, shouldBeDoneAtStopPosition) {
+    ReplayImageTracker tracker(1024);
+
+    tracker.onImage(false, 512);
+    EXPECT_TRUE(tracker.wasImageSeen());
+    EXPECT_FALSE(tracker.isDone());
+
+    tracker.onImage(false, 1024);
+    EXPECT_TRUE(tracker.isDone());
+}
+
+TEST(ReplayImageTrackerTest, shouldBeDoneWhenImageEnds) {
+    ReplayImageTracker tracker;
+
+    tracker.onImage(true, 0);
+
+    EXPECT_TRUE(tracker.isDone());
+}
+
+TEST(ReplayImageTrackerTest, shouldBeDoneWhenImageGoesAwayAfterItWasSeen) {
+    ReplayImageTracker tracker(1024);
+
+    tracker.onImage(false, 128);
+    tracker.onNoImage(false);
+
+    EXPECT_TRUE(tracker.isDone());
+}
+
+TEST(ReplayImageTrackerTest, shouldBeDoneWhenImageGoesAwayBeforeItWasSeen) {
+    ReplayImageTracker tracker(1024);
+
+    tracker.onNoImage(true);
+
+    EXPECT_FALSE(tracker.wasImageSeen());
+    EXPECT_TRUE(tracker.isDone());
+}
+
+TEST(ReplayImageTrackerTest, shouldStayDone) {
+    ReplayImageTracker tracker(1024);
+
+    tracker.onImage(false, 1024);
+    tracker.onImage(false, 0);
+
+    EXPECT_TRUE(tracker.isDone());
+}
+
+TEST(ReplayImageTrackerTest, shouldNotStopOpenEndedReplay) {
+    ReplayImageTracker tracker(replayStopPosition(1024, -1));
+
+    tracker.onImage(false, 1024);
+    tracker.onImage(false, 1 << 30);
+
+    EXPECT_TRUE(tracker.wasImageSeen());
+    EXPECT_FALSE(tracker.isDone());
+}
+
+TEST(ReplayStopPositionTest, shouldStopAtEndOfBoundedReplay) {
+    EXPECT_EQ(1536, replayStopPosition(1024, 512));
+    EXPECT_EQ(1024, replayStopPosition(1024, 0));
+}
+
+TEST(ReplayStopPositionTest, shouldHaveNoStopPositionForOpenEndedReplay) {
+    EXPECT_EQ(std::numeric_limits<std::int64_t>::max(), replayStopPosition(1024, -1));
+    EXPECT_EQ(std::numeric_limits<std::int64_t>::max(), replayStopPosition(0, -1));
+}
+
+TEST(ReplayStopPositionTest, shouldNotOverflow) {
+    EXPECT_EQ(std::numeric_limits<std::int64_t>::max(),
+              replayStopPosition(1024, std::numeric_limits<std::int64_t>::max()));
+}
+
+TEST(ReplaySessionPoolHandleTest, shouldCloseEmptyHandle) {
+    ReplaySessionPool::Handle handle;
+
+    EXPECT_EQ(-1, handle.replaySessionId());
+    EXPECT_EQ(nullptr, handle.image());
+    EXPECT_FALSE(handle.isDone());
+
+    handle.close();
+    handle.close();
+}
+
+TEST(ReplaySessionPoolHandleTest, shouldMoveEmptyHandle) {
+    ReplaySessionPool::Handle handle;
+    ReplaySessionPool::Handle moved(std::move(handle));
+
+    handle = std::move(moved);
+
+    EXPECT_EQ(-1, handle.replaySessionId());
+    EXPECT_EQ(0, handle.poll([](aeron::concurrent::AtomicBuffer&, aeron::util::index_t, aeron::util::index_t,
+                                aeron::Header&) {},
+                             10));
+}